@@ -0,0 +1,27 @@
+#include "batchedrenderer.h"
+
+
+// setObjectList() relies on the members of GMlib::MultiObjectRenderer as of 0.7
+#if !defined(QMLDEMO_GMLIB_VERSION_MAJOR) || QMLDEMO_GMLIB_VERSION_MAJOR != 0 || QMLDEMO_GMLIB_VERSION_MINOR != 7
+#  error "BatchedRenderer: written against GMlib 0.7; check setObjectList() against this GMlib's MultiObjectRenderer"
+#endif
+
+
+
+// All of GMlib's prepare runs; only the objects it collected are swapped for the batch's
+void BatchedRenderer::prepare() {
+
+  GMlib::DefaultRenderer::prepare();
+  if( !_draw_list )
+    return;
+
+  // Culled for this camera by the ViewBatch
+  setObjectList( *_draw_list );
+  _draw_list = nullptr;
+}
+
+// What DefaultRenderer::prepare() leaves for render(): MultiObjectRenderer::_objs
+void BatchedRenderer::setObjectList( const ViewBatch::DrawList& list ) {
+
+  _objs = list;
+}
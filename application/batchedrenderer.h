@@ -0,0 +1,35 @@
+#ifndef BATCHEDRENDERER_H
+#define BATCHEDRENDERER_H
+
+#include "viewbatch.h"
+
+// gmlib
+#include <scene/render/gmdefaultrenderer.h>
+
+
+/*!
+ *  BatchedRenderer
+ *
+ *  - DefaultRenderer that draws the list of a ViewBatch instead of the one it culled
+ *    itself. DefaultRenderer::prepare() still runs in full; the list then replaces the
+ *    objects it collected. It is consumed by the next prepare(), i.e. the next render();
+ *    without one the renderer draws its own list as before.
+ *  - The list is written into MultiObjectRenderer's protected object list, the one
+ *    DefaultRenderer::prepare() culls into. That layout is GMlib 0.7's; the build checks
+ *    the version and setObjectList() is the only place that touches it.
+ */
+class BatchedRenderer : public GMlib::DefaultRenderer {
+public:
+  void                          setDrawList( const ViewBatch::DrawList* list ) { _draw_list = list; }
+
+protected:
+  void                          prepare() override;
+
+private:
+  void                          setObjectList( const ViewBatch::DrawList& list );
+
+  const ViewBatch::DrawList*    _draw_list {nullptr};
+};
+
+
+#endif // BATCHEDRENDERER_H
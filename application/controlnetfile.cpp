@@ -0,0 +1,502 @@
+#include "controlnetfile.h"
+
+#include "../work/mybsplinesurface.h"
+
+// qt
+#include <QSaveFile>
+
+// stl
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+
+// Every field is naturally aligned; the file is the struct written as is
+struct ControlNetFile::Header {
+  char                  magic[4];          // "GMCN"
+  std::uint16_t         version;
+  std::uint16_t         byte_order;        // 0x0102 as written; anything else is a foreign-endian file
+  std::uint8_t          scalar_size;       // 4: float, 8: double
+  std::uint8_t          dimension;         // 1: curve, 2: surface
+  std::uint8_t          knot_vectors;
+  std::uint8_t          has_material;
+  std::uint32_t         dims[2];
+  std::uint32_t         knot_count[2];
+  std::uint32_t         reserved;
+  std::uint64_t         knots_offset[2];
+  std::uint64_t         points_offset;
+  std::uint64_t         material_offset;
+};
+
+
+namespace {
+
+  // Followed by texture_size bytes of UTF-8
+  struct MaterialBlock {
+    float               ambient[4];
+    float               diffuse[4];
+    float               specular[4];
+    float               shininess;
+    std::int32_t        samples[2];
+    std::uint32_t       texture_size;
+  };
+
+  constexpr char            Magic[4]   = { 'G', 'M', 'C', 'N' };
+  constexpr std::uint16_t   ByteOrder  = 0x0102;
+  constexpr std::uint64_t   Alignment  = 64;
+  constexpr std::uint32_t   MaxCount   = std::uint32_t( std::numeric_limits<int>::max() );   // Dimensions and knot counts are read as int
+
+  std::uint64_t align( std::uint64_t offset ) { return (offset + Alignment - 1) / Alignment * Alignment; }
+
+  [[noreturn]] void fail( const QString& path, const std::string& what ) {
+
+    throw std::invalid_argument( "[][]Control net '" + path.toStdString() + "': " + what + "!" );
+  }
+
+
+
+
+  // Whitespace separated tokens, remembering the (non-empty) line each one is on
+  class TextTokens {
+  public:
+    struct Token {
+      const char*       p;
+      int               n;
+      int               line;
+    };
+
+    explicit TextTokens( const QByteArray& text ) {
+
+      const char* c   = text.constData();
+      const char* end = c + text.size();
+      int  line  = 0;
+      bool used  = false;
+      while( c < end ) {
+
+        if( *c == '\n' ) {
+          if( used ) { _line_size.push_back(_count); ++line; }
+          used = false; _count = 0; ++c;
+        }
+        else if( *c == ' ' || *c == '\t' || *c == '\r' || *c == '\f' || *c == '\v' )
+          ++c;
+        else {
+          const char* b = c;
+          while( c < end && !std::strchr( " \t\r\f\v\n", *c ) ) ++c;
+          _tokens.push_back( Token { b, int(c - b), line } );
+          used = true; ++_count;
+        }
+      }
+      if( used ) _line_size.push_back(_count);
+    }
+
+    size_t              size() const { return _tokens.size(); }
+    const Token&        operator [] ( size_t i ) const { return _tokens[i]; }
+
+    // Number of tokens on the line of token i
+    int                 lineSize( size_t i ) const { return _line_size[ size_t(_tokens[i].line) ]; }
+
+    // Index of the first token after the line of token i
+    size_t              nextLine( size_t i ) const {
+      const int line = _tokens[i].line;
+      while( i < _tokens.size() && _tokens[i].line == line ) ++i;
+      return i;
+    }
+
+    bool                isNumber( size_t i ) const {
+      bool ok;
+      QByteArray::fromRawData( _tokens[i].p, _tokens[i].n ).toDouble(&ok);
+      return ok;
+    }
+
+    double              number( const QString& path, size_t i ) const {
+      if( i >= _tokens.size() ) fail( path, "unexpected end of file" );
+      bool ok;
+      const double v = QByteArray::fromRawData( _tokens[i].p, _tokens[i].n ).toDouble(&ok);
+      if( !ok ) fail( path, "'" + std::string( _tokens[i].p, size_t(_tokens[i].n) ) + "' on line " + std::to_string(_tokens[i].line + 1) + " is not a number" );
+      return v;
+    }
+
+    std::uint32_t       count( const QString& path, size_t i ) const {
+      const double v = number( path, i );
+      if( v < 0.0 || v != std::floor(v) || v > 4294967295.0 )
+        fail( path, "expected a count on line " + std::to_string(_tokens[i].line + 1) );
+      return std::uint32_t(v);
+    }
+
+  private:
+    std::vector<Token>  _tokens;
+    std::vector<int>    _line_size;
+    int                 _count {0};
+  };
+
+  template <typename T>
+  void writeScalars( QSaveFile& file, const std::vector<double>& values ) {
+
+    std::vector<T> out( values.begin(), values.end() );
+    file.write( reinterpret_cast<const char*>(out.data()), qint64(out.size() * sizeof(T)) );
+  }
+
+  void pad( QSaveFile& file, std::uint64_t offset ) {
+
+    static const char zeros[Alignment] = {};
+    const auto n = qint64( offset - std::uint64_t(file.pos()) );
+    if( n > 0 ) file.write( zeros, n );
+  }
+
+  // Surface from knot and xyz scalars of either precision
+  template <typename S>
+  MyB_splineSurface<float>* makeSurface( const QString& path, const S* const knots[2], const int knot_count[2],
+                                         const S* xyz, int rows, int cols ) {
+
+    GMlib::DVector<float> k[2];
+    for( int d = 0; d < 2; ++d ) {
+      k[d].setDim( knot_count[d] );
+      for( int i = 0; i < knot_count[d]; ++i )
+        k[d][i] = float( knots[d][i] );
+    }
+
+    GMlib::DMatrix<GMlib::Vector<float,3>> grid( rows, cols );
+    for( int i = 0; i < rows; ++i )
+      for( int j = 0; j < cols; ++j, xyz += 3 )
+        grid[i][j] = GMlib::Vector<float,3>( float(xyz[0]), float(xyz[1]), float(xyz[2]) );
+
+    try {
+      return new MyB_splineSurface<float>( k[0], k[1], grid );
+    }
+    catch( const std::invalid_argument& e ) {
+      fail( path, e.what() );
+    }
+  }
+
+} // END anonymous namespace
+
+
+
+
+ControlNetFile::~ControlNetFile() { close(); }
+
+void ControlNetFile::open( const QString& path ) {
+
+  close();
+
+  _file.setFileName( path );
+  if( !_file.open( QIODevice::ReadOnly ) )
+    fail( path, "can not be opened" );
+
+  _size = _file.size();
+  if( _size >= qint64(sizeof(Header)) ) {
+
+    _data   = _file.map( 0, _size );
+    _mapped = _data != nullptr;
+    if( !_mapped ) {
+
+      // Not every file system maps; reading is still parse free
+      _buffer = _file.readAll();
+      _data   = reinterpret_cast<const uchar*>( _buffer.constData() );
+      _size   = _buffer.size();
+    }
+  }
+
+  const auto invalid = [this,&path]( const std::string& what ) { close(); fail( path, what ); };
+
+  if( !_data || _size < qint64(sizeof(Header)) )                      invalid( "file too small for a control net header" );
+
+  const Header& h = header();
+  if( std::memcmp( h.magic, Magic, sizeof(Magic) ) != 0 )                invalid( "not a binary control net" );
+  if( h.version < 1 || h.version > Version )                          invalid( "unsupported version " + std::to_string(h.version) );
+  if( h.byte_order != ByteOrder )                                     invalid( "written with a different byte order" );
+  if( h.scalar_size != sizeof(float) && h.scalar_size != sizeof(double) ) invalid( "invalid scalar size" );
+  if( h.dimension < 1 || h.dimension > 2 )                            invalid( "invalid dimension" );
+  if( h.knot_vectors > h.dimension )                                  invalid( "too many knot vectors" );
+  if( h.dims[0] == 0 || h.dims[1] == 0 || (h.dimension == 1 && h.dims[1] != 1) ) invalid( "invalid grid dimensions" );
+  if( h.dims[0] > MaxCount || h.dims[1] > MaxCount )                  invalid( "grid dimensions too large" );
+
+  const auto fits = [this]( std::uint64_t offset, std::uint64_t bytes, std::uint64_t alignment ) {
+    return offset % alignment == 0 && offset >= sizeof(Header) && offset <= std::uint64_t(_size) && bytes <= std::uint64_t(_size) - offset;
+  };
+
+  for( int d = 0; d < h.knot_vectors; ++d ) {
+    if( h.knot_count[d] > MaxCount )                                  invalid( "knot vector too large" );
+    if( !fits( h.knots_offset[d], std::uint64_t(h.knot_count[d]) * h.scalar_size, h.scalar_size ) ) invalid( "knot vector outside of the file" );
+  }
+
+  // Both dimensions are below 2^31, so their product does not wrap; the byte count is
+  // only formed once the point count is known to fit the file
+  const std::uint64_t point_count = std::uint64_t(h.dims[0]) * h.dims[1];
+  if( point_count > std::uint64_t(_size) / (3u * h.scalar_size)
+      || !fits( h.points_offset, point_count * 3 * h.scalar_size, h.scalar_size ) ) invalid( "control points outside of the file" );
+
+  if( h.has_material ) {
+
+    if( !fits( h.material_offset, sizeof(MaterialBlock), alignof(MaterialBlock) ) ) invalid( "material outside of the file" );
+    const auto& m = *static_cast<const MaterialBlock*>( section( h.material_offset ) );
+    if( !fits( h.material_offset + sizeof(MaterialBlock), m.texture_size, 1 ) ) invalid( "material outside of the file" );
+  }
+}
+
+void ControlNetFile::close() {
+
+  if( _mapped ) _file.unmap( const_cast<uchar*>(_data) );
+  if( _file.isOpen() ) _file.close();
+  _buffer.clear();
+
+  _data   = nullptr;
+  _size   = 0;
+  _mapped = false;
+}
+
+const ControlNetFile::Header&
+ControlNetFile::header() const {
+
+  if( !_data ) throw std::invalid_argument("[][]No control net open!");
+  return *reinterpret_cast<const Header*>( _data );
+}
+
+int ControlNetFile::getScalarSize() const { return header().scalar_size; }
+
+int ControlNetFile::getDimension() const { return header().dimension; }
+
+int ControlNetFile::getRows() const { return int( header().dims[0] ); }
+
+int ControlNetFile::getCols() const { return int( header().dims[1] ); }
+
+int ControlNetFile::getKnotVectorCount() const { return header().knot_vectors; }
+
+int ControlNetFile::getKnotCount( int dir ) const {
+
+  if( dir < 0 || dir >= getKnotVectorCount() ) return 0;
+  return int( header().knot_count[dir] );
+}
+
+std::uint64_t ControlNetFile::knotOffset( int dir ) const { return header().knots_offset[dir]; }
+
+std::uint64_t ControlNetFile::pointsOffset() const { return header().points_offset; }
+
+bool ControlNetFile::hasMaterial() const { return header().has_material != 0; }
+
+ControlNetFile::Material
+ControlNetFile::getMaterial() const {
+
+  Material material;
+  if( !hasMaterial() ) return material;
+
+  const auto& m = *static_cast<const MaterialBlock*>( section( header().material_offset ) );
+  std::copy( m.ambient,  m.ambient  + 4, material.ambient );
+  std::copy( m.diffuse,  m.diffuse  + 4, material.diffuse );
+  std::copy( m.specular, m.specular + 4, material.specular );
+  material.shininess  = m.shininess;
+  material.samples[0] = m.samples[0];
+  material.samples[1] = m.samples[1];
+  material.texture    = QString::fromUtf8( reinterpret_cast<const char*>(&m + 1), int(m.texture_size) );
+
+  return material;
+}
+
+
+
+
+/*!
+ *  Text layout, blank lines are ignored:
+ *    [ 1 <texture path>
+ *      <samples u> <samples v>
+ *      <ambient rgba> <diffuse rgba> <specular rgba>, one per line
+ *      <shininess> ]
+ *    [ <n> <n knots> ]         zero to two knot vectors
+ *    <rows> <cols> <rows x cols xyz>   surface, or
+ *    <n> <n xyz>                       curve
+ *  A knot vector is a count followed by a line of exactly that many values; anything
+ *  after the control points (e.g. a trailing order) is not part of the net.
+ */
+ControlNetFile::ControlNet
+ControlNetFile::parseText( const QString& path ) {
+
+  QFile file( path );
+  if( !file.open( QIODevice::ReadOnly ) )
+    fail( path, "can not be opened" );
+
+  const QByteArray text = file.readAll();
+  const TextTokens tokens( text );
+
+  ControlNet net;
+  size_t t = 0;
+
+  // Material block: a flag followed by the texture path, which may contain spaces
+  if( tokens.size() >= 2 && tokens.lineSize(0) >= 2 && !tokens.isNumber(1) ) {
+
+    net.has_material = true;
+    const size_t path_end = tokens.nextLine(0) - 1;
+    net.material.texture = QString::fromUtf8( tokens[1].p, int( tokens[path_end].p + tokens[path_end].n - tokens[1].p ) );
+    t = path_end + 1;
+
+    auto& m = net.material;
+    m.samples[0] = int( tokens.count( path, t++ ) );
+    m.samples[1] = int( tokens.count( path, t++ ) );
+    for( auto color : { m.ambient, m.diffuse, m.specular } )
+      for( int i = 0; i < 4; ++i )
+        color[i] = float( tokens.number( path, t++ ) );
+    m.shininess = float( tokens.number( path, t++ ) );
+  }
+
+  // n is a product of two counts, at most (2^32-1)^2, so compare before multiplying
+  const auto readPoints = [&]( std::uint64_t n ) {
+    if( n > (tokens.size() - t) / 3 ) fail( path, "unexpected end of file" );
+    net.points.resize( size_t(n * 3) );
+    for( auto& v : net.points ) v = tokens.number( path, t++ );
+  };
+
+  while( t < tokens.size() ) {
+
+    if( tokens.lineSize(t) == 2 ) {
+
+      net.dimension = 2;
+      net.dims[0]   = tokens.count( path, t++ );
+      net.dims[1]   = tokens.count( path, t++ );
+      if( net.dims[0] > MaxCount || net.dims[1] > MaxCount )
+        fail( path, "grid dimensions too large on line " + std::to_string(tokens[t - 1].line + 1) );
+      readPoints( std::uint64_t(net.dims[0]) * net.dims[1] );
+      break;
+    }
+
+    if( tokens.lineSize(t) != 1 )
+      fail( path, "expected a count or grid dimensions on line " + std::to_string(tokens[t].line + 1) );
+
+    const std::uint32_t n = tokens.count( path, t++ );
+    if( n > 0 && net.knot_vectors < 2 && t < tokens.size() && tokens.lineSize(t) == int(n) ) {
+
+      auto& knots = net.knots[ net.knot_vectors++ ];
+      knots.resize( n );
+      for( auto& k : knots ) k = tokens.number( path, t++ );
+      continue;
+    }
+
+    if( n > MaxCount )
+      fail( path, "too many control points on line " + std::to_string(tokens[t - 1].line + 1) );
+
+    net.dimension = 1;
+    net.dims[0]   = n;
+    net.dims[1]   = 1;
+    readPoints( n );
+    break;
+  }
+
+  if( net.dimension == 0 || net.points.empty() )
+    fail( path, "no control points" );
+
+  if( net.knot_vectors > net.dimension )
+    fail( path, "more knot vectors than parameter directions" );
+
+  return net;
+}
+
+void ControlNetFile::write( const QString& path, const ControlNet& net, bool single_precision ) {
+
+  if( net.dimension < 1 || net.dimension > 2 || net.knot_vectors > net.dimension
+      || net.points.size() != size_t(net.dims[0]) * net.dims[1] * 3 || net.points.empty() )
+    fail( path, "inconsistent control net" );
+
+  const std::uint8_t scalar_size = single_precision ? sizeof(float) : sizeof(double);
+  const QByteArray   texture     = net.material.texture.toUtf8();
+
+  Header h {};
+  std::memcpy( h.magic, Magic, sizeof(Magic) );
+  h.version      = Version;
+  h.byte_order   = ByteOrder;
+  h.scalar_size  = scalar_size;
+  h.dimension    = std::uint8_t(net.dimension);
+  h.knot_vectors = std::uint8_t(net.knot_vectors);
+  h.has_material = net.has_material ? 1 : 0;
+  h.dims[0]      = net.dims[0];
+  h.dims[1]      = net.dims[1];
+
+  // Layout: header, material, knot vectors, points; each section starts on a 64 byte boundary
+  std::uint64_t offset = sizeof(Header);
+  if( net.has_material ) {
+    h.material_offset = align(offset);
+    offset = h.material_offset + sizeof(MaterialBlock) + std::uint64_t(texture.size());
+  }
+  for( int d = 0; d < net.knot_vectors; ++d ) {
+    h.knot_count[d]   = std::uint32_t( net.knots[d].size() );
+    h.knots_offset[d] = align(offset);
+    offset = h.knots_offset[d] + std::uint64_t(h.knot_count[d]) * scalar_size;
+  }
+  h.points_offset = align(offset);
+
+  QSaveFile file( path );
+  if( !file.open( QIODevice::WriteOnly ) )
+    fail( path, "can not be written" );
+
+  file.write( reinterpret_cast<const char*>(&h), sizeof(Header) );
+
+  if( net.has_material ) {
+
+    const auto& m = net.material;
+    MaterialBlock block {};
+    std::copy( m.ambient,  m.ambient  + 4, block.ambient );
+    std::copy( m.diffuse,  m.diffuse  + 4, block.diffuse );
+    std::copy( m.specular, m.specular + 4, block.specular );
+    block.shininess    = m.shininess;
+    block.samples[0]   = m.samples[0];
+    block.samples[1]   = m.samples[1];
+    block.texture_size = std::uint32_t( texture.size() );
+
+    pad( file, h.material_offset );
+    file.write( reinterpret_cast<const char*>(&block), sizeof(MaterialBlock) );
+    file.write( texture );
+  }
+
+  for( int d = 0; d < net.knot_vectors; ++d ) {
+    pad( file, h.knots_offset[d] );
+    if( single_precision ) writeScalars<float>( file, net.knots[d] );
+    else                   writeScalars<double>( file, net.knots[d] );
+  }
+
+  pad( file, h.points_offset );
+  if( single_precision ) writeScalars<float>( file, net.points );
+  else                   writeScalars<double>( file, net.points );
+
+  if( !file.commit() )
+    fail( path, "can not be written" );
+}
+
+void ControlNetFile::convertText( const QString& text_path, const QString& binary_path, bool single_precision ) {
+
+  write( binary_path, parseText( text_path ), single_precision );
+}
+
+MyB_splineSurface<float>* ControlNetFile::loadSurface( const QString& path ) {
+
+  bool binary = false;
+  {
+    QFile file( path );
+    if( !file.open( QIODevice::ReadOnly ) )
+      fail( path, "can not be opened" );
+    binary = file.peek( sizeof(Magic) ) == QByteArray( Magic, sizeof(Magic) );
+  }
+
+  if( !binary ) {
+
+    const ControlNet net = parseText( path );
+    if( net.dimension != 2 )
+      fail( path, "not a surface net" );
+
+    const double* knots[2]      { net.knots[0].data(), net.knots[1].data() };
+    const int     knot_count[2] { int(net.knots[0].size()), int(net.knots[1].size()) };
+    return makeSurface( path, knots, knot_count, net.points.data(), int(net.dims[0]), int(net.dims[1]) );
+  }
+
+  ControlNetFile file;
+  file.open( path );
+  if( file.getDimension() != 2 )
+    fail( path, "not a surface net" );
+
+  const int knot_count[2] { file.getKnotCount(0), file.getKnotCount(1) };
+  if( file.isDouble() ) {
+    const double* knots[2] { file.knots<double>(0), file.knots<double>(1) };
+    return makeSurface( path, knots, knot_count, file.points<double>()[0].getPtr(), file.getRows(), file.getCols() );
+  }
+
+  const float* knots[2] { file.knots<float>(0), file.knots<float>(1) };
+  return makeSurface( path, knots, knot_count, file.points<float>()[0].getPtr(), file.getRows(), file.getCols() );
+}
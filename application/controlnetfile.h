@@ -0,0 +1,183 @@
+#ifndef CONTROLNETFILE_H
+#define CONTROLNETFILE_H
+
+// gmlib
+#include <core/types/gmpoint.h>
+#include <core/containers/gmdvector.h>
+#include <core/containers/gmdmatrix.h>
+
+// qt
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+// stl
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+
+template <typename T>
+class MyB_splineSurface;
+
+
+/*!
+ *  ControlNetFile
+ *
+ *  - Binary container for the control nets of data/ *.txt: optional material block,
+ *    up to two knot vectors and a curve (n) or surface (rows x cols) grid of xyz points,
+ *    stored as contiguous float or double.
+ *  - open() maps the file read-only (QFile::map, read as a fallback) and validates the
+ *    header; knots() and points() then point straight into the mapping. Every section
+ *    is 64 byte aligned, a grid row is a GMlib::Vector<T,3> array in place.
+ *  - toDVector()/toDMatrix() fill GMlib containers from the mapping with one pass of
+ *    row copies; GMlib's containers own their storage, so this is the only copy made.
+ *  - parseText()/write()/convertText() make the container from the text layout.
+ *  - loadSurface() makes the MyB_splineSurface of a surface net, from either layout.
+ *  - Malformed input throws std::invalid_argument.
+ */
+class ControlNetFile {
+public:
+  static constexpr std::uint16_t  Version = 1;
+
+  struct Material {
+    QString                     texture;
+    int                         samples[2]   {0,0};
+    float                       ambient[4]   {0,0,0,1};
+    float                       diffuse[4]   {0,0,0,1};
+    float                       specular[4]  {0,0,0,1};
+    float                       shininess    {0};
+  };
+
+  // The parsed content of a text file, in double precision
+  struct ControlNet {
+    bool                        has_material {false};
+    Material                    material;
+    int                         knot_vectors {0};
+    std::vector<double>         knots[2];
+    int                         dimension    {0};      // 1: curve, 2: surface
+    std::uint32_t               dims[2]      {0,0};    // curve: {n,1}
+    std::vector<double>         points;                // xyz, row major
+  };
+
+  ControlNetFile() = default;
+  ControlNetFile( const ControlNetFile& ) = delete;
+  ControlNetFile& operator = ( const ControlNetFile& ) = delete;
+  ~ControlNetFile();
+
+  void                          open( const QString& path );
+  void                          close();
+  bool                          isOpen() const { return _data != nullptr; }
+  bool                          isMapped() const { return _mapped; }
+
+  int                           getScalarSize() const;
+  bool                          isDouble() const { return getScalarSize() == int(sizeof(double)); }
+  int                           getDimension() const;
+  int                           getRows() const;
+  int                           getCols() const;
+  int                           getKnotVectorCount() const;
+  int                           getKnotCount( int dir ) const;
+
+  bool                          hasMaterial() const;
+  Material                      getMaterial() const;
+
+  // nullptr when T is not the stored precision
+  template <typename T>
+  const T*                      knots( int dir ) const;
+  template <typename T>
+  const GMlib::Vector<T,3>*     points() const;
+  template <typename T>
+  const GMlib::Vector<T,3>*     row( int i ) const { auto p = points<T>(); return p ? p + std::size_t(i) * getCols() : nullptr; }
+
+  template <typename T>
+  GMlib::DVector<T>             toKnotDVector( int dir ) const;
+  template <typename T>
+  GMlib::DVector<GMlib::Vector<T,3>>  toDVector() const;
+  template <typename T>
+  GMlib::DMatrix<GMlib::Vector<T,3>>  toDMatrix() const;
+
+  static ControlNet             parseText( const QString& path );
+  static void                   write( const QString& path, const ControlNet& net, bool single_precision = false );
+  static void                   convertText( const QString& text_path, const QString& binary_path, bool single_precision = false );
+
+  // Binary when the file starts with the container magic, text otherwise. A knot vector
+  // the net leaves out is clamped uniform; a single one is taken for the rows (u).
+  static MyB_splineSurface<float>*  loadSurface( const QString& path );
+
+private:
+  struct Header;
+
+  const Header&                 header() const;
+  std::uint64_t                 knotOffset( int dir ) const;
+  std::uint64_t                 pointsOffset() const;
+  const void*                   section( std::uint64_t offset ) const { return _data + offset; }
+
+  QFile                         _file;
+  QByteArray                    _buffer;     // fallback when the file can not be mapped
+  const uchar*                  _data   {nullptr};
+  qint64                        _size   {0};
+  bool                          _mapped {false};
+};
+
+
+
+
+template <typename T>
+inline
+const T* ControlNetFile::knots( int dir ) const {
+
+  static_assert( std::is_floating_point<T>::value, "Control net scalars are float or double" );
+  if( getScalarSize() != int(sizeof(T)) || getKnotCount(dir) == 0 )
+    return nullptr;
+
+  return static_cast<const T*>( section( knotOffset(dir) ) );
+}
+
+template <typename T>
+inline
+const GMlib::Vector<T,3>* ControlNetFile::points() const {
+
+  static_assert( std::is_floating_point<T>::value, "Control net scalars are float or double" );
+  static_assert( sizeof(GMlib::Vector<T,3>) == 3 * sizeof(T), "GMlib::Vector<T,3> must be three packed scalars" );
+  if( getScalarSize() != int(sizeof(T)) )
+    return nullptr;
+
+  return static_cast<const GMlib::Vector<T,3>*>( section( pointsOffset() ) );
+}
+
+template <typename T>
+inline
+GMlib::DVector<T> ControlNetFile::toKnotDVector( int dir ) const {
+
+  const T* k = knots<T>(dir);
+  if( !k ) return GMlib::DVector<T>();
+
+  return GMlib::DVector<T>( getKnotCount(dir), k );
+}
+
+template <typename T>
+inline
+GMlib::DVector<GMlib::Vector<T,3>> ControlNetFile::toDVector() const {
+
+  const auto p = points<T>();
+  if( !p ) return GMlib::DVector<GMlib::Vector<T,3>>();
+
+  return GMlib::DVector<GMlib::Vector<T,3>>( getRows() * getCols(), p );
+}
+
+template <typename T>
+inline
+GMlib::DMatrix<GMlib::Vector<T,3>> ControlNetFile::toDMatrix() const {
+
+  GMlib::DMatrix<GMlib::Vector<T,3>> m;
+  if( !points<T>() ) return m;
+
+  m.setDim( getRows(), getCols() );
+  for( int i = 0; i < getRows(); ++i )
+    m[i] = GMlib::DVector<GMlib::Vector<T,3>>( getCols(), row<T>(i) );
+
+  return m;
+}
+
+
+#endif // CONTROLNETFILE_H
@@ -0,0 +1,814 @@
+#include "curvequeryindex.h"
+
+// gmlib
+#include <parametrics/gmpcurve.h>
+#include <scene/gmscene.h>
+#include <scene/gmsceneobject.h>
+
+// stl
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+
+
+namespace {
+
+  using Vec3 = std::array<float,3>;
+
+  constexpr int     LeafItems      = 4;
+  constexpr int     NewtonSteps    = 8;
+
+  inline Vec3  sub( const float* a, const float* b ) { return { a[0] - b[0], a[1] - b[1], a[2] - b[2] }; }
+  inline float dot( const float* a, const float* b ) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+  inline Vec3  axpy( float s, const float* x, const float* y ) { return { s * x[0] + y[0], s * x[1] + y[1], s * x[2] + y[2] }; }
+
+  // Position and derivatives in scene coordinates
+  struct CurvePoint {
+    Vec3  p;
+    Vec3  d1;
+    Vec3  d2;
+  };
+
+  CurvePoint evaluate( const GMlib::PCurve<float,3>* curve, float t, int d ) {
+
+    const auto& v = curve->evaluate( t, d );
+    const auto& m = curve->getMatrixToScene();
+
+    CurvePoint c {};
+    const GMlib::Point<float,3> p = m * GMlib::Point<float,3>( v[0] );
+    c.p = { p[0], p[1], p[2] };
+    if( d > 0 ) {
+      const GMlib::Vector<float,3> d1 = m * v[1];
+      c.d1 = { d1[0], d1[1], d1[2] };
+    }
+    if( d > 1 ) {
+      const GMlib::Vector<float,3> d2 = m * v[2];
+      c.d2 = { d2[0], d2[1], d2[2] };
+    }
+    return c;
+  }
+
+  // Parameter u in [0,1] of the point on a -> b closest to p, and the squared distance
+  float closestOnSegment( const float* a, const float* b, const float* p, float& u ) {
+
+    const Vec3  ab = sub( b, a );
+    const Vec3  ap = sub( p, a );
+    const float l2 = dot( ab.data(), ab.data() );
+    u = l2 > 0.0f ? std::max( 0.0f, std::min( 1.0f, dot( ap.data(), ab.data() ) / l2 ) ) : 0.0f;
+
+    const Vec3 q = axpy( -u, ab.data(), ap.data() );
+    return dot( q.data(), q.data() );
+  }
+
+  // Closest points of the segments p0 -> p1 and q0 -> q1 at u and v (Ericson, 5.1.9); squared distance
+  float closestSegments( const float* p0, const float* p1, const float* q0, const float* q1, float& u, float& v ) {
+
+    const Vec3  d1 = sub( p1, p0 ), d2 = sub( q1, q0 ), r = sub( p0, q0 );
+    const float a = dot( d1.data(), d1.data() ), e = dot( d2.data(), d2.data() ), f = dot( d2.data(), r.data() );
+    const float eps = 1e-12f;
+
+    if( a <= eps && e <= eps ) { u = v = 0.0f; }
+    else if( a <= eps )        { u = 0.0f; v = std::max( 0.0f, std::min( 1.0f, f / e ) ); }
+    else {
+      const float c = dot( d1.data(), r.data() );
+      if( e <= eps )           { v = 0.0f; u = std::max( 0.0f, std::min( 1.0f, -c / a ) ); }
+      else {
+        const float b = dot( d1.data(), d2.data() ), denom = a * e - b * b;
+        u = denom > eps ? std::max( 0.0f, std::min( 1.0f, (b * f - c * e) / denom ) ) : 0.0f;
+        v = (b * u + f) / e;
+        if( v < 0.0f )         { v = 0.0f; u = std::max( 0.0f, std::min( 1.0f, -c / a ) ); }
+        else if( v > 1.0f )    { v = 1.0f; u = std::max( 0.0f, std::min( 1.0f, (b - c) / a ) ); }
+      }
+    }
+
+    const Vec3 cp = axpy( u, d1.data(), p0 ), cq = axpy( v, d2.data(), q0 );
+    const Vec3 w  = sub( cp.data(), cq.data() );
+    return dot( w.data(), w.data() );
+  }
+
+  // Closest points of the segment p0 -> p1 at u and the ray o + s d, |d| = 1, at s >= 0; squared distance
+  float closestSegmentRay( const float* p0, const float* p1, const float* o, const float* d, float& u, float& s ) {
+
+    const Vec3  d1 = sub( p1, p0 ), r = sub( p0, o );
+    const float a = dot( d1.data(), d1.data() ), b = dot( d1.data(), d ), c = dot( d1.data(), r.data() ), f = dot( d, r.data() );
+    const float denom = a - b * b;
+
+    u = denom > 1e-12f ? std::max( 0.0f, std::min( 1.0f, (b * f - c) / denom ) ) : 0.0f;
+    s = b * u + f;
+    if( s < 0.0f ) {
+      s = 0.0f;
+      u = a > 0.0f ? std::max( 0.0f, std::min( 1.0f, -c / a ) ) : 0.0f;
+    }
+
+    const Vec3 w = sub( axpy( u, d1.data(), p0 ).data(), axpy( s, d, o ).data() );
+    return dot( w.data(), w.data() );
+  }
+
+  // Parameter along the ray of its entry into the box, or +inf when it misses
+  float rayBox( const float* lo, const float* hi, const float* o, const float* inv, float pad ) {
+
+    float t0 = 0.0f, t1 = std::numeric_limits<float>::max();
+    for( int k = 0; k < 3; ++k ) {
+      float a = (lo[k] - pad - o[k]) * inv[k];
+      float b = (hi[k] + pad - o[k]) * inv[k];
+      if( a > b ) std::swap( a, b );
+      t0 = std::max( t0, a );
+      t1 = std::min( t1, b );
+      if( t0 > t1 ) return std::numeric_limits<float>::max();
+    }
+    return t0;
+  }
+
+} // END anonymous namespace
+
+
+
+/*!
+ *  CurveTree
+ *
+ *  - Segments chords of one curve in scene coordinates and their AABB tree. Boxes are
+ *    padded by a quarter of their chord as an allowance for the curve bulging out.
+ */
+struct CurveQueryIndex::CurveTree {
+  Curve*                                  curve   {nullptr};
+  bool                                    dirty   {true};
+  float                                   key[4]  {0, 0, 0, -1};   // Surrounding sphere it was built for
+
+  float                                   start   {0};
+  float                                   end     {1};
+  bool                                    closed  {false};
+
+  std::vector<float>                      t;        // Segments + 1 parameters
+  std::vector<float>                      p;        // Segments + 1 points, xyz
+  std::vector<Box>                        boxes;
+  std::vector<Node>                       nodes;
+  std::vector<int>                        items;
+
+  const float* point( int i ) const { return &p[3 * size_t(i)]; }
+  float        width() const { return (end - start) / float(Segments); }
+
+  // Parameter distance, the short way round for closed curves
+  float gap( float u, float v ) const {
+
+    const float g = std::abs( u - v );
+    return closed ? std::min( g, (end - start) - g ) : g;
+  }
+
+  // Moves t to within the domain: around for closed curves, clamped otherwise
+  float wrap( float u ) const {
+
+    if( closed ) {
+      const float period = end - start;
+      u = start + std::fmod( u - start, period );
+      if( u < start ) u += period;
+      return u;
+    }
+    return std::max( start, std::min( end, u ) );
+  }
+};
+
+
+
+CurveQueryIndex::CurveQueryIndex() = default;
+
+CurveQueryIndex::~CurveQueryIndex() = default;
+
+void CurveQueryIndex::invalidate( GMlib::SceneObject* obj ) {
+
+  auto curve = dynamic_cast<Curve*>(obj);
+  auto itr = _curves.find(curve);
+  if( itr != _curves.end() )
+    itr->second->dirty = true;
+  _scene_stale = true;
+}
+
+void CurveQueryIndex::clear() {
+
+  _curves.clear();
+  _scene_curves.clear();
+  _scene_nodes.clear();
+  _scene_items.clear();
+  _scene_stale = _scene_tree_stale = true;
+}
+
+// The tree of curve, (re)built when it was invalidated or its surrounding sphere changed
+CurveQueryIndex::CurveTree& CurveQueryIndex::tree( Curve* curve ) {
+
+  auto& entry = _curves[curve];
+  if( !entry ) {
+    entry.reset( new CurveTree );
+    entry->curve = curve;
+  }
+  auto& ct = *entry;
+
+  const auto& sphere = curve->getSurroundingSphereClean();
+  const float key[4] = { sphere.getPos()[0], sphere.getPos()[1], sphere.getPos()[2], float( sphere.getRadius() ) };
+  if( !std::equal( key, key + 4, ct.key ) ) {
+    std::copy( key, key + 4, ct.key );
+    ct.dirty = true;
+  }
+
+  if( !ct.dirty )
+    return ct;
+
+  ct.start  = curve->getParStart();
+  ct.end    = curve->getParEnd();
+  ct.closed = curve->isClosed();
+
+  ct.t.resize( Segments + 1 );
+  ct.p.resize( 3 * size_t(Segments + 1) );
+  for( int i = 0; i <= Segments; ++i ) {
+    ct.t[i] = i == Segments ? ct.end : ct.start + (ct.end - ct.start) * float(i) / float(Segments);
+    const auto c = evaluate( curve, ct.t[i], 0 );
+    std::copy( c.p.begin(), c.p.end(), &ct.p[3 * size_t(i)] );
+  }
+
+  ct.boxes.resize( Segments );
+  for( int i = 0; i < Segments; ++i ) {
+    const float* a = ct.point(i);
+    const float* b = ct.point(i + 1);
+    const Vec3   ab = sub( b, a );
+    const float  pad = 0.25f * std::sqrt( dot( ab.data(), ab.data() ) );
+    for( int k = 0; k < 3; ++k ) {
+      ct.boxes[i].lo[k] = std::min( a[k], b[k] ) - pad;
+      ct.boxes[i].hi[k] = std::max( a[k], b[k] ) + pad;
+    }
+  }
+
+  ct.items.resize( Segments );
+  for( int i = 0; i < Segments; ++i )
+    ct.items[i] = i;
+  ct.nodes.clear();
+  buildNodes( ct.nodes, ct.items, ct.boxes, 0, Segments );
+
+  ct.dirty = false;
+  _scene_stale = _scene_tree_stale = true;
+  ++_builds;
+  return ct;
+}
+
+// Median split on the longest axis of the item centres; preorder, the left child follows its parent
+int CurveQueryIndex::buildNodes( std::vector<Node>& nodes, std::vector<int>& items,
+                                 const std::vector<Box>& boxes, int first, int count ) {
+
+  const int index = int( nodes.size() );
+  nodes.push_back( Node {} );
+
+  Box box = boxes[ items[first] ];
+  for( int i = first + 1; i < first + count; ++i )
+    for( int k = 0; k < 3; ++k ) {
+      box.lo[k] = std::min( box.lo[k], boxes[ items[i] ].lo[k] );
+      box.hi[k] = std::max( box.hi[k], boxes[ items[i] ].hi[k] );
+    }
+  nodes[index].box = box;
+
+  if( count <= LeafItems ) {
+    nodes[index].first = first;
+    nodes[index].count = count;
+    return index;
+  }
+
+  int axis = 0;
+  for( int k = 1; k < 3; ++k )
+    if( box.hi[k] - box.lo[k] > box.hi[axis] - box.lo[axis] )
+      axis = k;
+
+  const int half = count / 2;
+  std::nth_element( items.begin() + first, items.begin() + first + half, items.begin() + first + count,
+                    [&boxes, axis]( int a, int b ) {
+                      return boxes[a].lo[axis] + boxes[a].hi[axis] < boxes[b].lo[axis] + boxes[b].hi[axis]; } );
+
+  buildNodes( nodes, items, boxes, first, half );
+  const int right = buildNodes( nodes, items, boxes, first + half, count - half );
+  nodes[index].first = right;
+  nodes[index].count = 0;
+  return index;
+}
+
+// Walks the scene for its curves once per frame; rebuilt trees only refit the scene tree
+void CurveQueryIndex::refresh( GMlib::Scene& scene ) {
+
+  if( !_scene_stale )
+    return;
+
+  std::vector<Curve*> curves;
+  for( int i = 0; i < scene.getSize(); ++i )
+    collect( scene[i], curves );
+
+  const bool changed = curves != _scene_curves;
+  if( changed ) {
+
+    std::vector<Curve*> sorted( curves );
+    std::sort( sorted.begin(), sorted.end() );
+    for( auto itr = _curves.begin(); itr != _curves.end(); )
+      if( !std::binary_search( sorted.begin(), sorted.end(), itr->first ) )
+        itr = _curves.erase(itr);
+      else
+        ++itr;
+    _scene_curves.swap( curves );
+  }
+
+  for( auto curve : _scene_curves )
+    tree( curve );
+
+  if( changed )
+    buildSceneTree();
+  else if( _scene_tree_stale ) {
+
+    // Children follow their parents, so a reverse sweep sees them first
+    for( int i = int( _scene_nodes.size() ) - 1; i >= 0; --i ) {
+
+      auto& node = _scene_nodes[i];
+      auto  grow = [&node]( const Box& b ) {
+        for( int k = 0; k < 3; ++k ) {
+          node.box.lo[k] = std::min( node.box.lo[k], b.lo[k] );
+          node.box.hi[k] = std::max( node.box.hi[k], b.hi[k] );
+        }
+      };
+
+      if( node.count > 0 ) {
+        node.box = _curves[ _scene_curves[ _scene_items[node.first] ] ]->nodes[0].box;
+        for( int j = 1; j < node.count; ++j )
+          grow( _curves[ _scene_curves[ _scene_items[node.first + j] ] ]->nodes[0].box );
+      }
+      else {
+        node.box = _scene_nodes[i + 1].box;
+        grow( _scene_nodes[node.first].box );
+      }
+    }
+  }
+
+  _scene_stale = _scene_tree_stale = false;
+}
+
+void CurveQueryIndex::collect( GMlib::SceneObject* obj, std::vector<Curve*>& curves ) {
+
+  if( auto curve = dynamic_cast<Curve*>(obj) )
+    curves.push_back(curve);
+
+  auto& children = obj->getChildren();
+  for( int i = 0; i < children.getSize(); ++i )
+    collect( children[i], curves );
+}
+
+void CurveQueryIndex::buildSceneTree() {
+
+  _scene_nodes.clear();
+  _scene_items.resize( _scene_curves.size() );
+  if( _scene_curves.empty() )
+    return;
+
+  std::vector<Box> boxes( _scene_curves.size() );
+  for( size_t i = 0; i < _scene_curves.size(); ++i ) {
+    boxes[i] = _curves[ _scene_curves[i] ]->nodes[0].box;
+    _scene_items[i] = int(i);
+  }
+
+  buildNodes( _scene_nodes, _scene_items, boxes, 0, int( _scene_curves.size() ) );
+}
+
+namespace {
+
+  inline float boxDistance2( const float* lo, const float* hi, const float* p ) {
+
+    float d2 = 0.0f;
+    for( int k = 0; k < 3; ++k ) {
+      const float d = std::max( std::max( lo[k] - p[k], p[k] - hi[k] ), 0.0f );
+      d2 += d * d;
+    }
+    return d2;
+  }
+
+  inline bool overlaps( const float* alo, const float* ahi, const float* blo, const float* bhi, float pad ) {
+
+    for( int k = 0; k < 3; ++k )
+      if( alo[k] - pad > bhi[k] || blo[k] - pad > ahi[k] )
+        return false;
+    return true;
+  }
+
+} // END anonymous namespace
+
+// Nearest chord point through the tree of ct, below best2; true if one was found
+bool CurveQueryIndex::nearestChord( const CurveTree& ct, const float* q, float& best2, float& best_t ) {
+
+  bool found = false;
+  int  stack[64], top = 0;
+  stack[top++] = 0;
+  while( top > 0 ) {
+
+    const int   index = stack[--top];
+    const auto& node  = ct.nodes[index];
+    if( boxDistance2( node.box.lo, node.box.hi, q ) >= best2 )
+      continue;
+
+    if( node.count == 0 ) {
+
+      // The nearer child goes on top
+      const int  left = index + 1, right = node.first;
+      const bool near_left = boxDistance2( ct.nodes[left].box.lo, ct.nodes[left].box.hi, q )
+                          <= boxDistance2( ct.nodes[right].box.lo, ct.nodes[right].box.hi, q );
+      stack[top++] = near_left ? right : left;
+      stack[top++] = near_left ? left : right;
+      continue;
+    }
+
+    for( int j = 0; j < node.count; ++j ) {
+      const int seg = ct.items[node.first + j];
+      float u;
+      const float d2 = closestOnSegment( ct.point(seg), ct.point(seg + 1), q, u );
+      if( d2 < best2 ) {
+        best2  = d2;
+        best_t = ct.t[seg] + u * (ct.t[seg + 1] - ct.t[seg]);
+        found  = true;
+      }
+    }
+  }
+
+  return found;
+}
+
+/*!
+ *  refineClosest(ct, q, t)
+ *
+ *  - Newton steps on (c(t) - q) . c'(t) = 0 from t, each at most a chord wide. A step
+ *    that does not bring the curve closer is not taken.
+ */
+CurveQueryIndex::Hit CurveQueryIndex::refineClosest( const CurveTree& ct, const float* q, float t ) {
+
+  auto  c  = evaluate( ct.curve, t, 2 );
+  Vec3  r  = sub( c.p.data(), q );
+  float d2 = dot( r.data(), r.data() );
+
+  for( int step = 0; step < NewtonSteps; ++step ) {
+
+    const float f  = dot( r.data(), c.d1.data() );
+    float       fp = dot( c.d1.data(), c.d1.data() ) + dot( r.data(), c.d2.data() );
+    if( fp <= 0.0f )
+      fp = dot( c.d1.data(), c.d1.data() );
+    if( fp <= 0.0f )
+      break;
+
+    const float tn = ct.wrap( t + std::max( -ct.width(), std::min( ct.width(), -f / fp ) ) );
+    const auto  cn = evaluate( ct.curve, tn, 2 );
+    const Vec3  rn = sub( cn.p.data(), q );
+    const float dn = dot( rn.data(), rn.data() );
+    if( dn > d2 )
+      break;
+
+    const bool converged = std::abs( tn - t ) <= 1e-6f * (ct.end - ct.start);
+    t = tn;  c = cn;  r = rn;  d2 = dn;
+    if( converged )
+      break;
+  }
+
+  Hit hit;
+  hit.curve    = ct.curve;
+  hit.t        = t;
+  hit.point    = Point( c.p[0], c.p[1], c.p[2] );
+  hit.distance = std::sqrt( d2 );
+  return hit;
+}
+
+CurveQueryIndex::Hit CurveQueryIndex::closestPoint( Curve* curve, const Point& p ) {
+
+  if( !curve )
+    return Hit {};
+
+  const auto& ct = tree( curve );
+  const float q[3] = { p[0], p[1], p[2] };
+
+  float best2 = std::numeric_limits<float>::max(), best_t = ct.start;
+  nearestChord( ct, q, best2, best_t );
+  return refineClosest( ct, q, best_t );
+}
+
+/*!
+ *  closestPoint(scene, p, max_distance)
+ *
+ *  - Nearest chord point over the scene tree, the bound shared between curves, then
+ *    refined on the curve it lies on. An empty Hit when no curve is within max_distance.
+ */
+CurveQueryIndex::Hit CurveQueryIndex::closestPoint( GMlib::Scene& scene, const Point& p, float max_distance ) {
+
+  refresh( scene );
+  if( _scene_nodes.empty() )
+    return Hit {};
+
+  const float q[3] = { p[0], p[1], p[2] };
+  float  best2 = max_distance < std::sqrt( std::numeric_limits<float>::max() )
+               ? max_distance * max_distance : std::numeric_limits<float>::max();
+  float  best_t = 0.0f;
+  const CurveTree* best = nullptr;
+
+  std::vector<int> stack( 1, 0 );
+  while( !stack.empty() ) {
+
+    const int   index = stack.back();
+    stack.pop_back();
+    const auto& node = _scene_nodes[index];
+    if( boxDistance2( node.box.lo, node.box.hi, q ) >= best2 )
+      continue;
+
+    if( node.count == 0 ) {
+      stack.push_back( node.first );
+      stack.push_back( index + 1 );
+      continue;
+    }
+
+    // Chords only; the winner is refined once
+    for( int j = 0; j < node.count; ++j ) {
+      const auto& ct = *_curves[ _scene_curves[ _scene_items[node.first + j] ] ];
+      if( nearestChord( ct, q, best2, best_t ) )
+        best = &ct;
+    }
+  }
+
+  if( !best )
+    return Hit {};
+
+  const Hit hit = refineClosest( *best, q, best_t );
+  return hit.distance <= max_distance ? hit : Hit {};
+}
+
+/*!
+ *  raycast(scene, origin, dir, radius)
+ *
+ *  - Of the chords passing within radius of the ray, the one reached first along it.
+ *    The hit is refined towards the point of the curve nearest the ray; distance is the
+ *    ray parameter of that point.
+ */
+CurveQueryIndex::Hit CurveQueryIndex::raycast( GMlib::Scene& scene, const Point& origin, const GMlib::Vector<float,3>& dir,
+                                               float radius ) {
+
+  refresh( scene );
+
+  const float len = std::sqrt( dir * dir );
+  if( _scene_nodes.empty() || len <= 0.0f )
+    return Hit {};
+
+  const float o[3]   = { origin[0], origin[1], origin[2] };
+  const float d[3]   = { dir[0] / len, dir[1] / len, dir[2] / len };
+  const float inv[3] = { 1.0f / d[0], 1.0f / d[1], 1.0f / d[2] };
+
+  float  best_s = std::numeric_limits<float>::max(), best_t = 0.0f;
+  Curve* best = nullptr;
+
+  auto test = [&]( Curve* curve, const CurveTree& ct ) {
+
+    int stack[64], top = 0;
+    stack[top++] = 0;
+    while( top > 0 ) {
+
+      const int   index = stack[--top];
+      const auto& node  = ct.nodes[index];
+      if( rayBox( node.box.lo, node.box.hi, o, inv, radius ) >= best_s )
+        continue;
+
+      if( node.count == 0 ) {
+        stack[top++] = node.first;
+        stack[top++] = index + 1;
+        continue;
+      }
+
+      for( int j = 0; j < node.count; ++j ) {
+        const int seg = ct.items[node.first + j];
+        float u, s;
+        if( closestSegmentRay( ct.point(seg), ct.point(seg + 1), o, d, u, s ) > radius * radius )
+          continue;
+        if( s < best_s ) {
+          best_s = s;
+          best_t = ct.t[seg] + u * (ct.t[seg + 1] - ct.t[seg]);
+          best   = curve;
+        }
+      }
+    }
+  };
+
+  std::vector<int> stack( 1, 0 );
+  while( !stack.empty() ) {
+
+    const int   index = stack.back();
+    stack.pop_back();
+    const auto& node = _scene_nodes[index];
+    if( rayBox( node.box.lo, node.box.hi, o, inv, radius ) >= best_s )
+      continue;
+
+    if( node.count == 0 ) {
+      stack.push_back( node.first );
+      stack.push_back( index + 1 );
+    }
+    else
+      for( int j = 0; j < node.count; ++j ) {
+        auto curve = _scene_curves[ _scene_items[node.first + j] ];
+        test( curve, *_curves[curve] );
+      }
+  }
+
+  if( !best )
+    return Hit {};
+
+  // Newton on the part of c(t) - o normal to the ray
+  const auto& ct = *_curves[best];
+  auto normal = [&d]( const Vec3& v ) { return axpy( -dot( v.data(), d ), d, v.data() ); };
+
+  float t = best_t;
+  auto  c = evaluate( best, t, 2 );
+  Vec3  q = normal( sub( c.p.data(), o ) );
+  float q2 = dot( q.data(), q.data() );
+
+  for( int step = 0; step < NewtonSteps; ++step ) {
+
+    const Vec3  n1 = normal( c.d1 ), n2 = normal( c.d2 );
+    const float f  = dot( q.data(), n1.data() );
+    float       fp = dot( n1.data(), n1.data() ) + dot( q.data(), n2.data() );
+    if( fp <= 0.0f )
+      fp = dot( n1.data(), n1.data() );
+    if( fp <= 0.0f )
+      break;
+
+    const float tn = ct.wrap( t + std::max( -ct.width(), std::min( ct.width(), -f / fp ) ) );
+    const auto  cn = evaluate( best, tn, 2 );
+    const Vec3  qn = normal( sub( cn.p.data(), o ) );
+    const float qn2 = dot( qn.data(), qn.data() );
+    if( qn2 > q2 )
+      break;
+
+    const bool converged = std::abs( tn - t ) <= 1e-6f * (ct.end - ct.start);
+    t = tn;  c = cn;  q = qn;  q2 = qn2;
+    if( converged )
+      break;
+  }
+
+  Hit hit;
+  hit.curve    = best;
+  hit.t        = t;
+  hit.point    = Point( c.p[0], c.p[1], c.p[2] );
+  hit.distance = dot( sub( c.p.data(), o ).data(), d );
+  return hit;
+}
+
+/*!
+ *  intersect(a, b, tolerance)
+ *
+ *  - Both trees are descended together over pairs of overlapping boxes. Chord pairs
+ *    closer than the tolerance plus their padding are refined by Gauss-Newton on
+ *    |a(t) - b(s)|^2 and kept if the curves meet within tolerance. Refinements that land
+ *    on an intersection already found are dropped. With a == b, neighbouring chords
+ *    are not tested against each other and each crossing is reported once, t < s.
+ */
+std::vector<CurveQueryIndex::Intersection> CurveQueryIndex::intersect( Curve* a, Curve* b, float tolerance ) {
+
+  std::vector<Intersection> result;
+  if( !a || !b )
+    return result;
+
+  const auto& ta = tree( a );
+  const auto& tb = tree( b );
+  const bool  self = a == b;
+
+  auto chordPad = []( const CurveTree& ct, int seg ) {
+    return 0.25f * std::sqrt( dot( sub( ct.point(seg + 1), ct.point(seg) ).data(), sub( ct.point(seg + 1), ct.point(seg) ).data() ) );
+  };
+
+  auto refine = [&]( float t, float s ) {
+
+    auto  ca = evaluate( a, t, 1 );
+    auto  cb = evaluate( b, s, 1 );
+    Vec3  r  = sub( ca.p.data(), cb.p.data() );
+    float r2 = dot( r.data(), r.data() );
+
+    for( int step = 0; step < 2 * NewtonSteps && r2 > 0.0f; ++step ) {
+
+      // (J^T J) [dt ds] = -J^T r with J = [a'(t), -b'(s)]
+      const float aa = dot( ca.d1.data(), ca.d1.data() ), bb = dot( cb.d1.data(), cb.d1.data() );
+      const float ab = dot( ca.d1.data(), cb.d1.data() );
+      const float ra = dot( r.data(), ca.d1.data() ), rb = dot( r.data(), cb.d1.data() );
+      const float det = aa * bb - ab * ab;
+      if( det <= 1e-12f * aa * bb || det <= 0.0f )
+        break;
+
+      const float dt = (ab * rb - ra * bb) / det;
+      const float ds = (aa * rb - ab * ra) / det;
+      const float tn = ta.wrap( t + std::max( -ta.width(), std::min( ta.width(), dt ) ) );
+      const float sn = tb.wrap( s + std::max( -tb.width(), std::min( tb.width(), ds ) ) );
+
+      const auto  na = evaluate( a, tn, 1 );
+      const auto  nb = evaluate( b, sn, 1 );
+      const Vec3  rn = sub( na.p.data(), nb.p.data() );
+      const float rn2 = dot( rn.data(), rn.data() );
+      if( rn2 > r2 )
+        break;
+
+      const bool converged = std::abs( tn - t ) <= 1e-6f * (ta.end - ta.start) && std::abs( sn - s ) <= 1e-6f * (tb.end - tb.start);
+      t = tn;  s = sn;  ca = na;  cb = nb;  r = rn;  r2 = rn2;
+      if( converged )
+        break;
+    }
+
+    if( r2 > tolerance * tolerance )
+      return;
+    if( self ) {
+      if( ta.gap( t, s ) <= ta.width() )
+        return;
+      if( t > s )
+        std::swap( t, s );
+    }
+
+    for( const auto& found : result )
+      if( ta.gap( found.t, t ) <= ta.width() && tb.gap( found.s, s ) <= tb.width() )
+        return;
+
+    Intersection hit;
+    hit.curve    = b;
+    hit.t        = t;
+    hit.s        = s;
+    hit.point    = Point( 0.5f * (ca.p[0] + cb.p[0]), 0.5f * (ca.p[1] + cb.p[1]), 0.5f * (ca.p[2] + cb.p[2]) );
+    hit.distance = std::sqrt( r2 );
+    result.push_back( hit );
+  };
+
+  std::vector<std::pair<int,int>> stack( 1, { 0, 0 } );
+  while( !stack.empty() ) {
+
+    const auto pair = stack.back();
+    stack.pop_back();
+    const auto& na = ta.nodes[pair.first];
+    const auto& nb = tb.nodes[pair.second];
+    if( !overlaps( na.box.lo, na.box.hi, nb.box.lo, nb.box.hi, tolerance ) )
+      continue;
+
+    if( na.count == 0 ) {
+      stack.push_back( { pair.first + 1, pair.second } );
+      stack.push_back( { na.first,       pair.second } );
+      continue;
+    }
+    if( nb.count == 0 ) {
+      stack.push_back( { pair.first, pair.second + 1 } );
+      stack.push_back( { pair.first, nb.first } );
+      continue;
+    }
+
+    for( int i = 0; i < na.count; ++i )
+      for( int j = 0; j < nb.count; ++j ) {
+
+        const int sa = ta.items[na.first + i];
+        const int sb = tb.items[nb.first + j];
+        if( self && (sb <= sa + 1 || (ta.closed && sa == 0 && sb == Segments - 1)) )
+          continue;
+
+        float u, v;
+        const float limit = tolerance + chordPad( ta, sa ) + chordPad( tb, sb );
+        if( closestSegments( ta.point(sa), ta.point(sa + 1), tb.point(sb), tb.point(sb + 1), u, v ) > limit * limit )
+          continue;
+
+        refine( ta.t[sa] + u * (ta.t[sa + 1] - ta.t[sa]), tb.t[sb] + v * (tb.t[sb + 1] - tb.t[sb]) );
+      }
+  }
+
+  std::sort( result.begin(), result.end(), []( const Intersection& x, const Intersection& y ) { return x.t < y.t; } );
+  return result;
+}
+
+// Intersections of curve with every other curve of the scene whose bounds come within tolerance
+std::vector<CurveQueryIndex::Intersection> CurveQueryIndex::intersect( GMlib::Scene& scene, Curve* curve, float tolerance ) {
+
+  std::vector<Intersection> result;
+  refresh( scene );
+  if( !curve || _scene_nodes.empty() )
+    return result;
+
+  const Box box = tree( curve ).nodes[0].box;
+
+  std::vector<int> stack( 1, 0 );
+  while( !stack.empty() ) {
+
+    const int   index = stack.back();
+    stack.pop_back();
+    const auto& node = _scene_nodes[index];
+    if( !overlaps( node.box.lo, node.box.hi, box.lo, box.hi, tolerance ) )
+      continue;
+
+    if( node.count == 0 ) {
+      stack.push_back( node.first );
+      stack.push_back( index + 1 );
+      continue;
+    }
+
+    for( int j = 0; j < node.count; ++j ) {
+
+      auto other = _scene_curves[ _scene_items[node.first + j] ];
+      if( other == curve )
+        continue;
+      const auto& ob = _curves[other]->nodes[0].box;
+      if( !overlaps( ob.lo, ob.hi, box.lo, box.hi, tolerance ) )
+        continue;
+
+      const auto hits = intersect( curve, other, tolerance );
+      result.insert( result.end(), hits.begin(), hits.end() );
+    }
+  }
+
+  return result;
+}
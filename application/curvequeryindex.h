@@ -0,0 +1,120 @@
+#ifndef CURVEQUERYINDEX_H
+#define CURVEQUERYINDEX_H
+
+// gmlib
+#include <core/types/gmpoint.h>
+
+namespace GMlib {
+
+  class Scene;
+  class SceneObject;
+
+  template<typename T, int n>
+  class PCurve;
+}
+
+// stl
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+
+/*!
+ *  CurveQueryIndex
+ *
+ *  - Spatial queries against the PCurve<float,3> objects of a scene: closest point,
+ *    ray picks and curve–curve intersections, in scene coordinates.
+ *  - Each curve is sampled into Segments chords whose AABB tree narrows a query down to
+ *    a few chords. The result is then refined on the curve itself with Newton steps on
+ *    eval() derivatives, so the chords only have to isolate the right neighbourhood.
+ *  - A second tree over the bounds of the curves narrows scene queries to the curves
+ *    near the query.
+ *  - A curve tree is rebuilt on first use after invalidate(obj), which the
+ *    ReplotScheduler calls on every replot, or after its surrounding sphere moved.
+ *    The scene is walked for added, removed or moved curves at most once per
+ *    invalidateFrame().
+ *  - GL thread, with the scene locked.
+ */
+class CurveQueryIndex {
+public:
+  using Curve   = GMlib::PCurve<float,3>;
+  using Point   = GMlib::Point<float,3>;
+
+  static constexpr int                    Segments = 64;
+
+  struct Hit {
+    Curve*                                curve    {nullptr};
+    float                                 t        {0};
+    Point                                 point;
+    float                                 distance {std::numeric_limits<float>::max()};  // To the query; along the ray for raycast()
+  };
+
+  struct Intersection {
+    Curve*                                curve    {nullptr};   // The other curve
+    float                                 t        {0};         // On the curve asked about
+    float                                 s        {0};         // On the other curve
+    Point                                 point;
+    float                                 distance {0};
+  };
+
+  CurveQueryIndex();
+  ~CurveQueryIndex();
+
+  Hit                                     closestPoint( GMlib::Scene& scene, const Point& p,
+                                                        float max_distance = std::numeric_limits<float>::max() );
+  Hit                                     closestPoint( Curve* curve, const Point& p );
+
+  // Nearest point along a ray, of the curves that pass within radius of it
+  Hit                                     raycast( GMlib::Scene& scene, const Point& origin, const GMlib::Vector<float,3>& dir,
+                                                   float radius );
+
+  // Points where the curves come within tolerance of each other
+  std::vector<Intersection>               intersect( Curve* a, Curve* b, float tolerance );
+  std::vector<Intersection>               intersect( GMlib::Scene& scene, Curve* curve, float tolerance );
+
+  void                                    invalidate( GMlib::SceneObject* obj );
+  void                                    invalidateFrame() { _scene_stale = true; }
+  void                                    clear();
+
+  size_t                                  getCurveCount() const { return _curves.size(); }
+  size_t                                  getBuildCount() const { return _builds; }
+
+private:
+  struct Box {
+    float                                 lo[3];
+    float                                 hi[3];
+  };
+
+  struct Node {
+    Box                                   box;
+    int                                   first;   // Leaf: first item; inner: right child (left is next)
+    int                                   count;   // Leaf: items; inner: 0
+  };
+
+  struct CurveTree;
+
+  CurveTree&                              tree( Curve* curve );
+  void                                    refresh( GMlib::Scene& scene );
+  void                                    collect( GMlib::SceneObject* obj, std::vector<Curve*>& curves );
+  void                                    buildSceneTree();
+
+  static bool                             nearestChord( const CurveTree& ct, const float* q, float& best2, float& best_t );
+  static Hit                              refineClosest( const CurveTree& ct, const float* q, float t );
+  static int                              buildNodes( std::vector<Node>& nodes, std::vector<int>& items,
+                                                      const std::vector<Box>& boxes, int first, int count );
+
+  std::unordered_map<Curve*, std::unique_ptr<CurveTree>>  _curves;
+
+  // Tree over the curve bounds; items index _scene_curves
+  std::vector<Curve*>                     _scene_curves;
+  std::vector<Node>                       _scene_nodes;
+  std::vector<int>                        _scene_items;
+  bool                                    _scene_stale      {true};
+  bool                                    _scene_tree_stale {true};
+
+  size_t                                  _builds           {0};
+};
+
+
+#endif // CURVEQUERYINDEX_H
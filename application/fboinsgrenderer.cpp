@@ -8,6 +8,13 @@
 #include "window.h"
 
 #include <scene/render/gmrendertarget.h>
+#include <scene/camera/gmcamera.h>
+
+// stl
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
 
 
 class QQuickFboInlineRenderTarget : public GMlib::RenderTarget {
@@ -33,31 +40,66 @@ public:
 
     if(!_rcpair_name.length()) return;
 
-    // Pick up the FBO set by the QQuickFrameBufferObject upon the render() call
-    _gl.glGetIntegerv(GL_FRAMEBUFFER_BINDING,&_rt._fbo);
+    auto &gmlib = GMlibWrapper::instance();
+
+    // Adaptive quality; reduced while the camera moves
+    const bool  moving = _adaptive_quality && cameraMoving(gmlib);
+    const qreal scale  = moving ? std::min(_render_scale,_moving_scale) : _render_scale;
+    const QSize res    = QSize( std::max(1,int(_size.width()*scale)), std::max(1,int(_size.height()*scale)) );
+
+    // Render straight into QML's FBO, or offscreen and blit
+    const bool  offscreen = _samples > 0 || res != _size;
+    if(offscreen) {
+
+      updateOffscreenFbos(res);
+      _rt._fbo = GLint(_render_fbo->handle());
+    }
+    else {
+
+      // Pick up the FBO set by the QQuickFrameBufferObject upon the render() call
+      _gl.glGetIntegerv(GL_FRAMEBUFFER_BINDING,&_rt._fbo);
+    }
 
     // Prepare render and camera
-    auto &gmlib = GMlibWrapper::instance();
-    gmlib.render(_rcpair_name,QRect(QPoint(0,0),QSize(_size)),_rt);
+    gmlib.render(_rcpair_name,QRect(QPoint(0,0),QSize(_size)),_rt,res);
 
     // Restore to QML's GLState;
     // we do not know what GMlib has done
     _item->window()->resetOpenGLState();
 
+    // Resolve and upscale into QML's FBO
+    if(offscreen) {
+
+      auto source = _render_fbo.get();
+      if(_resolve_fbo) {
+
+        QOpenGLFramebufferObject::blitFramebuffer( _resolve_fbo.get(), source );
+        source = _resolve_fbo.get();
+      }
+
+      QOpenGLFramebufferObject::blitFramebuffer( framebufferObject(), QRect(QPoint(0,0),_size),
+                                                 source, QRect(QPoint(0,0),res),
+                                                 GL_COLOR_BUFFER_BIT, res != _size ? GL_LINEAR : GL_NEAREST );
+    }
+
     // Not necessary, but for clarity let's restore the full GL state as we entered the render() method
-    _gl.glBindFramebuffer(GL_FRAMEBUFFER,_rt._fbo);
+    framebufferObject()->bind();
+
+    // Throttle; on demand the next frame comes from GMlibWrapper::requestFrame(),
+    // while reduced an extra frame is needed to refine once the camera settles
+    if(!gmlib.isRenderOnDemand() || moving || _reduced)
+      update();
 
-    // Throttle
-    update();
+    _reduced = moving;
   }
 
   QOpenGLFramebufferObject *createFramebufferObject(const QSize &size) override {
 
     _size = size;
 
+    // Single sampled; multisampling is done in the offscreen FBO and resolved on blit
     QOpenGLFramebufferObjectFormat format;
     format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
-    format.setSamples(4);
     return new QOpenGLFramebufferObject(size, format);
   }
 
@@ -65,6 +107,11 @@ public:
 
     _item = static_cast<FboInSGRenderer*>(item);
     _rcpair_name = _item->rcPairName();
+
+    _samples          = std::max(0,_item->samples());
+    _render_scale     = qBound(0.1,_item->renderScale(),1.0);
+    _adaptive_quality = _item->adaptiveQuality();
+    _moving_scale     = qBound(0.1,_item->movingScale(),1.0);
   }
 
   QOpenGLFunctions            _gl;
@@ -73,6 +120,68 @@ public:
   QSize                       _size;
   QQuickFboInlineRenderTarget _rt;
   QString                     _rcpair_name;
+
+  int                         _samples {4};
+  qreal                       _render_scale {1.0};
+  bool                        _adaptive_quality {false};
+  qreal                       _moving_scale {0.5};
+
+private:
+  // (Re)create the offscreen render (and MSAA resolve) FBO on size or sample changes
+  void updateOffscreenFbos( const QSize& res ) {
+
+    if(_render_fbo && _render_fbo->size() == res && _fbo_samples == _samples)
+      return;
+
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    format.setSamples(_samples);
+    _render_fbo.reset(new QOpenGLFramebufferObject(res, format));
+    _fbo_samples = _samples;
+
+    // Multisampled blits can not scale; with both, resolve at render size first
+    _resolve_fbo.reset();
+    if(_render_fbo->format().samples() > 0 && res != _size)
+      _resolve_fbo.reset(new QOpenGLFramebufferObject(res));
+  }
+
+  // True until the camera has been still for the settle time
+  bool cameraMoving( GMlibWrapper& gmlib ) {
+
+    const auto  now = std::chrono::steady_clock::now();
+    const auto& cam = gmlib.camera(_rcpair_name);
+
+    // The simulation and the HID handlers move the camera under the scene lock
+    GMlib::Point<float,3>  pos;
+    GMlib::Vector<float,3> dir, up;
+    {
+      std::lock_guard<std::mutex> lock(gmlib.sceneMutex());
+      pos = cam->getPos();
+      dir = cam->getDir();
+      up  = cam->getUp();
+    }
+    if(pos != _cam_pos || dir != _cam_dir || up != _cam_up || _size != _cam_size) {
+
+      _cam_pos  = pos;
+      _cam_dir  = dir;
+      _cam_up   = up;
+      _cam_size = _size;
+      _last_motion = now;
+    }
+
+    return now - _last_motion < std::chrono::milliseconds(150);
+  }
+
+  std::unique_ptr<QOpenGLFramebufferObject> _render_fbo;
+  std::unique_ptr<QOpenGLFramebufferObject> _resolve_fbo;
+  int                                       _fbo_samples {-1};
+
+  GMlib::Point<float,3>                     _cam_pos;
+  GMlib::Vector<float,3>                    _cam_dir;
+  GMlib::Vector<float,3>                    _cam_up;
+  QSize                                     _cam_size;
+  std::chrono::steady_clock::time_point     _last_motion;
+  bool                                      _reduced {false};
 };
 
 
@@ -87,6 +196,10 @@ FboInSGRenderer::FboInSGRenderer() {
 
   connect( this, &QQuickItem::windowChanged,
            this, &FboInSGRenderer::onWindowChanged );
+
+  // Re-render the FBO whenever a frame is requested (render on demand)
+  connect( &GMlibWrapper::instance(), &GMlibWrapper::signFrameReady,
+           this,                      &QQuickItem::update );
 }
 
 const QString&
@@ -98,6 +211,42 @@ FboInSGRenderer::setRcPairName(const QString& name) {
   update();
 }
 
+int
+FboInSGRenderer::samples() const { return _samples; }
+
+void
+FboInSGRenderer::setSamples(int samples) {
+  _samples = samples;
+  update();
+}
+
+qreal
+FboInSGRenderer::renderScale() const { return _render_scale; }
+
+void
+FboInSGRenderer::setRenderScale(qreal scale) {
+  _render_scale = scale;
+  update();
+}
+
+bool
+FboInSGRenderer::adaptiveQuality() const { return _adaptive_quality; }
+
+void
+FboInSGRenderer::setAdaptiveQuality(bool enabled) {
+  _adaptive_quality = enabled;
+  update();
+}
+
+qreal
+FboInSGRenderer::movingScale() const { return _moving_scale; }
+
+void
+FboInSGRenderer::setMovingScale(qreal scale) {
+  _moving_scale = scale;
+  update();
+}
+
 QQuickFramebufferObject::Renderer* FboInSGRenderer::createRenderer() const { return new GMlibInFboRenderer(); }
 
 void FboInSGRenderer::onWindowChanged(QQuickWindow* w) {
@@ -6,12 +6,30 @@
 class FboInSGRenderer : public QQuickFramebufferObject {
   Q_OBJECT
   Q_PROPERTY(QString rcpair_name READ rcPairName WRITE setRcPairName)
+  Q_PROPERTY(int samples READ samples WRITE setSamples)
+  Q_PROPERTY(qreal render_scale READ renderScale WRITE setRenderScale)
+  Q_PROPERTY(bool adaptive_quality READ adaptiveQuality WRITE setAdaptiveQuality)
+  Q_PROPERTY(qreal moving_scale READ movingScale WRITE setMovingScale)
 public:
   FboInSGRenderer();
 
   const QString&    rcPairName() const;
   void              setRcPairName( const QString& name );
 
+  // MSAA sample count of the viewport; 0 disables multisampling
+  int               samples() const;
+  void              setSamples( int samples );
+
+  // Fraction of the item's pixel size that is rendered; the image is upscaled on blit
+  qreal             renderScale() const;
+  void              setRenderScale( qreal scale );
+
+  // Render at movingScale() while the camera moves, at full quality once it has settled
+  bool              adaptiveQuality() const;
+  void              setAdaptiveQuality( bool enabled );
+  qreal             movingScale() const;
+  void              setMovingScale( qreal scale );
+
   Renderer*         createRenderer() const override;
 
 private slots:
@@ -37,6 +55,10 @@ private:
   void              wheelEvent(QWheelEvent *event) override;
 
   QString           _name {};
+  int               _samples {4};
+  qreal             _render_scale {1.0};
+  bool              _adaptive_quality {false};
+  qreal             _moving_scale {0.5};
 };
 
 #endif
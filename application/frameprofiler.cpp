@@ -0,0 +1,361 @@
+#include "frameprofiler.h"
+
+// qt
+#include <QOpenGLTimerQuery>
+#include <QString>
+
+// stl
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+
+namespace {
+
+  // Open begin() timers of the calling thread
+  thread_local std::vector<std::pair<const char*, int64_t>> open_timers;
+
+  void writeString( std::ostream& out, const char* s ) {
+
+    out << '"';
+    for( ; *s; ++s ) {
+
+      const unsigned char c = static_cast<unsigned char>(*s);
+      if( c == '"' || c == '\\' ) out << '\\' << *s;
+      else if( c < 0x20 )         out << ' ';
+      else                        out << *s;
+    }
+    out << '"';
+  }
+
+  // Chrome trace events are in microseconds
+  double us( int64_t ns ) { return double(ns) * 1e-3; }
+
+  const int FrameTrack = 0;
+  const int GpuTrack   = 1000;
+}
+
+
+struct FrameProfiler::Query {
+  QOpenGLTimerQuery                       query;
+  const char*                             name   {nullptr};
+  uint64_t                                frame  {0};
+  int64_t                                 start  {0};
+  int                                     thread {0};
+};
+
+
+FrameProfiler::Scope::Scope( FrameProfiler& profiler, const char* name )
+  : _profiler(profiler), _name(name), _start( profiler.isEnabled() ? profiler.now() : -1 ) {}
+
+FrameProfiler::Scope::~Scope() {
+
+  if( _start >= 0 )
+    _profiler.record( _name, _start, _profiler.now() - _start );
+}
+
+
+FrameProfiler::FrameProfiler() : _epoch(Clock::now()), _frames(HistoryFrames) {}
+
+FrameProfiler::~FrameProfiler() = default;
+
+int64_t FrameProfiler::now() const {
+
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _epoch).count();
+}
+
+int FrameProfiler::threadId() {
+
+  static std::atomic<int> next {1};
+  thread_local const int id = next++;
+  return id;
+}
+
+void FrameProfiler::setThreadName( const std::string& name ) {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _thread_names.emplace( threadId(), name );
+}
+
+void FrameProfiler::begin( const char* name ) {
+
+  open_timers.emplace_back( name, _enabled ? now() : -1 );
+}
+
+void FrameProfiler::end() {
+
+  if( open_timers.empty() )
+    return;
+
+  const auto timer = open_timers.back();
+  open_timers.pop_back();
+  if( timer.second >= 0 )
+    record( timer.first, timer.second, now() - timer.second );
+}
+
+void FrameProfiler::record( const char* name, int64_t start, int64_t duration ) {
+
+  if( !_enabled )
+    return;
+
+  Sample sample;
+  sample.name     = name;
+  sample.start    = start;
+  sample.duration = duration;
+  sample.thread   = threadId();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _frames[_head].cpu.push_back(sample);
+}
+
+void FrameProfiler::beginGpu( const QString& name ) {
+
+  if( !_enabled || !_gpu_supported || _active || int(_pending.size()) >= MaxQueriesInFlight )
+    return;
+
+  std::unique_ptr<Query> q;
+  if( !_free.empty() ) {
+
+    q = std::move(_free.back());
+    _free.pop_back();
+  }
+  else {
+
+    q.reset(new Query);
+
+    // Without timer queries (no GL 3.3 or ARB_timer_query) GPU samples are not taken
+    if( !q->query.create() ) {
+
+      _gpu_supported = false;
+      return;
+    }
+  }
+
+  q->name   = _gpu_names.insert( name.toStdString() ).first->c_str();
+  q->start  = now();
+  q->thread = threadId();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    q->frame = _count;
+  }
+
+  q->query.begin();
+  _active = std::move(q);
+}
+
+void FrameProfiler::endGpu() {
+
+  if( !_active )
+    return;
+
+  _active->query.end();
+  _pending.push_back( std::move(_active) );
+}
+
+// Files the results that arrived; the rest are asked again next frame
+void FrameProfiler::collectGpu() {
+
+  auto ready = _pending.begin();
+  for( auto& q : _pending ) {
+
+    if( !q->query.isResultAvailable() ) {
+
+      *ready++ = std::move(q);
+      continue;
+    }
+
+    Sample sample;
+    sample.name     = q->name;
+    sample.start    = q->start;
+    sample.duration = int64_t( q->query.waitForResult() );
+    sample.thread   = q->thread;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto& frame = _frames[ q->frame % HistoryFrames ];
+      if( frame.index == q->frame )
+        frame.gpu.push_back(sample);
+    }
+    _free.push_back( std::move(q) );
+  }
+  _pending.erase( ready, _pending.end() );
+}
+
+void FrameProfiler::endFrame() {
+
+  collectGpu();
+
+  const int64_t t = now();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  _frames[_head].duration = t - _frames[_head].start;
+
+  // The storage of the frame dropped from the ring is reused
+  _head = (_head + 1) % HistoryFrames;
+  ++_count;
+
+  auto& frame = _frames[_head];
+  frame.index    = _count;
+  frame.start    = t;
+  frame.duration = 0;
+  frame.cpu.clear();
+  frame.gpu.clear();
+}
+
+void FrameProfiler::releaseGpu() {
+
+  _active.reset();
+  _pending.clear();
+  _free.clear();
+  _gpu_supported = true;
+}
+
+void FrameProfiler::clear() {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  for( auto& frame : _frames ) {
+
+    frame.index    = ~uint64_t(0);
+    frame.duration = 0;
+    frame.cpu.clear();
+    frame.gpu.clear();
+  }
+
+  // Frame indices go on counting, so pending GPU results of earlier frames are dropped
+  _first = _count;
+  _frames[_head].index = _count;
+  _frames[_head].start = now();
+}
+
+uint64_t FrameProfiler::getFrameCount() const {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _count;
+}
+
+int FrameProfiler::completedCount() const {
+
+  return int( std::min<uint64_t>( _count - _first, HistoryFrames - 1 ) );
+}
+
+const FrameProfiler::Frame& FrameProfiler::completed( int age ) const {
+
+  return _frames[ (_head + HistoryFrames - age) % HistoryFrames ];
+}
+
+std::vector<FrameProfiler::Stats> FrameProfiler::stats( int frames ) const {
+
+  struct Total {
+    double                                sum   {0};
+    double                                max   {0};
+    double                                frame {0};
+    int                                   calls {0};
+  };
+
+  std::vector<Stats> stats;
+  std::vector<Total> totals;
+  std::unordered_map<const char*, size_t> index[2];
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  const int n = std::min( frames, completedCount() );
+  if( n <= 0 )
+    return stats;
+
+  for( int age = n; age >= 1; --age ) {
+
+    const auto& frame = completed(age);
+    for( int gpu = 0; gpu < 2; ++gpu ) {
+
+      for( const auto& sample : gpu ? frame.gpu : frame.cpu ) {
+
+        auto it = index[gpu].find(sample.name);
+        if( it == index[gpu].end() ) {
+
+          it = index[gpu].emplace( sample.name, stats.size() ).first;
+          Stats s;
+          s.name = sample.name;
+          s.gpu  = gpu;
+          stats.push_back(s);
+          totals.emplace_back();
+        }
+        totals[it->second].frame += double(sample.duration) * 1e-6;
+        totals[it->second].calls += 1;
+      }
+    }
+
+    for( auto& total : totals ) {
+
+      total.sum  += total.frame;
+      total.max   = std::max( total.max, total.frame );
+      total.frame = 0;
+    }
+  }
+
+  for( size_t i = 0; i < stats.size(); ++i ) {
+
+    stats[i].mean_ms = totals[i].sum / n;
+    stats[i].max_ms  = totals[i].max;
+    stats[i].calls   = double(totals[i].calls) / n;
+  }
+
+  std::stable_partition( stats.begin(), stats.end(), []( const Stats& s ) { return !s.gpu; } );
+  return stats;
+}
+
+std::vector<float> FrameProfiler::frameTimes( int frames ) const {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  const int n = std::min( frames, completedCount() );
+
+  std::vector<float> times;
+  times.reserve(n);
+  for( int age = n; age >= 1; --age )
+    times.push_back( float( double(completed(age).duration) * 1e-6 ) );
+
+  return times;
+}
+
+void FrameProfiler::writeChromeTrace( std::ostream& out ) const {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  out << std::fixed << std::setprecision(3);
+  out << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+
+  bool first = true;
+  auto event = [&]( const char* name, const char* cat, int tid, int64_t start, int64_t duration ) {
+
+    out << (first ? "\n" : ",\n") << "    {\"name\": ";
+    writeString( out, name );
+    out << ", \"cat\": \"" << cat << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << tid
+        << ", \"ts\": " << us(start) << ", \"dur\": " << us(duration) << "}";
+    first = false;
+  };
+
+  auto thread = [&]( int tid, const std::string& name ) {
+
+    out << (first ? "\n" : ",\n") << "    {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << tid
+        << ", \"args\": {\"name\": ";
+    writeString( out, name.c_str() );
+    out << "}}";
+    first = false;
+  };
+
+  thread( FrameTrack, "Frames" );
+  thread( GpuTrack,   "GPU" );
+  for( const auto& name : _thread_names )
+    thread( name.first, name.second );
+
+  for( int age = completedCount(); age >= 1; --age ) {
+
+    const auto& frame = completed(age);
+    event( "Frame", "frame", FrameTrack, frame.start, frame.duration );
+    for( const auto& sample : frame.cpu )
+      event( sample.name, "cpu", sample.thread, sample.start, sample.duration );
+
+    // Placed where the commands were issued; the GPU runs them some time later
+    for( const auto& sample : frame.gpu )
+      event( sample.name, "gpu", GpuTrack, sample.start, sample.duration );
+  }
+
+  out << "\n  ]\n}\n";
+}
@@ -0,0 +1,141 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+// qt
+class QString;
+
+// stl
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+/*!
+ *  FrameProfiler
+ *
+ *  - Scoped CPU timers and GL timer queries, kept per frame in a ring buffer of the
+ *    last HistoryFrames frames.
+ *  - CPU samples may be recorded from any thread; they land in the frame that is open
+ *    when they end. Scope names must outlive the profiler, e.g. string literals.
+ *  - GPU samples time the commands issued between beginGpu() and endGpu(), one pair per
+ *    RenderCamPair and frame. Results are read back at a later endFrame(), without
+ *    stalling, and filed under the frame that issued them.
+ *  - A frame lasts from one endFrame() to the next, so under render on demand the idle
+ *    time between frames is part of it.
+ *  - beginGpu(), endGpu(), endFrame() and releaseGpu() are made from the GL thread with
+ *    the context current.
+ */
+class FrameProfiler {
+public:
+  static constexpr int                    HistoryFrames      = 240;
+  static constexpr int                    MaxQueriesInFlight = 32;
+
+  struct Sample {
+    const char*                           name     {nullptr};
+    int64_t                               start    {0};   // ns since the profiler was created
+    int64_t                               duration {0};   // ns
+    int                                   thread   {0};   // Per-thread id; GPU samples: the issuing thread
+  };
+
+  struct Frame {
+    uint64_t                              index    {0};
+    int64_t                               start    {0};
+    int64_t                               duration {0};
+    std::vector<Sample>                   cpu;
+    std::vector<Sample>                   gpu;              // start: when the commands were issued
+  };
+
+  // Per-frame totals of one scope over a number of frames
+  struct Stats {
+    const char*                           name     {nullptr};
+    bool                                  gpu      {false};
+    double                                mean_ms  {0};
+    double                                max_ms   {0};
+    double                                calls    {0};     // Per frame
+  };
+
+  class Scope {
+  public:
+    Scope( FrameProfiler& profiler, const char* name );
+    ~Scope();
+
+    Scope( const Scope& ) = delete;
+    Scope& operator = ( const Scope& ) = delete;
+
+  private:
+    FrameProfiler&                        _profiler;
+    const char*                           _name;
+    int64_t                               _start;
+  };
+
+  FrameProfiler();
+  ~FrameProfiler();
+
+  void                                    setEnabled( bool enabled ) { _enabled = enabled; }
+  bool                                    isEnabled() const { return _enabled; }
+
+  // Names the calling thread in exported traces; the first name given sticks
+  void                                    setThreadName( const std::string& name );
+
+  // Unscoped timers for begin/end signal pairs; nest per thread
+  void                                    begin( const char* name );
+  void                                    end();
+
+  void                                    record( const char* name, int64_t start, int64_t duration );
+
+  void                                    beginGpu( const QString& name );
+  void                                    endGpu();
+  bool                                    isGpuSupported() const { return _gpu_supported; }
+
+  void                                    endFrame();
+  void                                    releaseGpu();
+  void                                    clear();
+
+  int64_t                                 now() const;
+
+  uint64_t                                getFrameCount() const;
+
+  // Over the last frames completed frames; scopes in order of first appearance, CPU before GPU
+  std::vector<Stats>                      stats( int frames ) const;
+  std::vector<float>                      frameTimes( int frames ) const;   // ms, oldest first
+
+  // Chrome trace event JSON of the completed frames in the ring, for chrome://tracing or Perfetto
+  void                                    writeChromeTrace( std::ostream& out ) const;
+
+private:
+  struct Query;
+
+  static int                              threadId();
+  const Frame&                            completed( int age ) const;       // 1: the last completed frame
+  int                                     completedCount() const;
+  void                                    collectGpu();
+
+  using Clock = std::chrono::steady_clock;
+
+  const Clock::time_point                 _epoch;
+  std::atomic<bool>                       _enabled          {true};
+
+  mutable std::mutex                      _mutex;
+  std::vector<Frame>                      _frames;          // Ring; _frames[_head] is open
+  int                                     _head             {0};
+  uint64_t                                _count            {0};
+  uint64_t                                _first            {0};      // First frame since clear()
+  std::unordered_map<int, std::string>    _thread_names;
+
+  // GL thread only
+  std::unordered_set<std::string>         _gpu_names;       // Interned; elements keep their address
+  std::unique_ptr<Query>                  _active;
+  std::vector<std::unique_ptr<Query>>     _pending;
+  std::vector<std::unique_ptr<Query>>     _free;
+  bool                                    _gpu_supported    {true};
+};
+
+
+#endif // FRAMEPROFILER_H
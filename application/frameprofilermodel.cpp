@@ -0,0 +1,86 @@
+#include "frameprofilermodel.h"
+
+#include "frameprofiler.h"
+
+// qt
+#include <QVariantMap>
+
+// stl
+#include <algorithm>
+#include <fstream>
+
+
+FrameProfilerModel::FrameProfilerModel( FrameProfiler& profiler, QObject* parent )
+  : QObject(parent), _profiler(profiler) {
+
+  _timer.setInterval(RefreshInterval);
+  connect( &_timer, &QTimer::timeout, this, &FrameProfilerModel::refresh );
+}
+
+void FrameProfilerModel::setActive( bool active ) {
+
+  if( active == isActive() )
+    return;
+
+  if( active ) {
+
+    refresh();
+    _timer.start();
+  }
+  else
+    _timer.stop();
+
+  emit signActiveChanged();
+}
+
+bool FrameProfilerModel::isEnabled() const { return _profiler.isEnabled(); }
+
+void FrameProfilerModel::setEnabled( bool enabled ) {
+
+  if( enabled == isEnabled() )
+    return;
+
+  _profiler.setEnabled(enabled);
+  emit signEnabledChanged();
+}
+
+void FrameProfilerModel::refresh() {
+
+  const auto times = _profiler.frameTimes(StatsFrames);
+
+  _frame_ms     = 0;
+  _frame_max_ms = 0;
+  _frame_times.clear();
+  for( auto t : times ) {
+
+    _frame_ms     += t;
+    _frame_max_ms  = std::max( _frame_max_ms, double(t) );
+    _frame_times.append( double(t) );
+  }
+  if( !times.empty() )
+    _frame_ms /= times.size();
+
+  _scopes.clear();
+  for( const auto& s : _profiler.stats(StatsFrames) ) {
+
+    QVariantMap scope;
+    scope["name"]  = QString(s.name);
+    scope["gpu"]   = s.gpu;
+    scope["mean"]  = s.mean_ms;
+    scope["max"]   = s.max_ms;
+    scope["calls"] = s.calls;
+    _scopes.append(scope);
+  }
+
+  emit signStatsChanged();
+}
+
+bool FrameProfilerModel::writeChromeTrace( const QString& path ) const {
+
+  std::ofstream out( path.toStdString() );
+  if( !out )
+    return false;
+
+  _profiler.writeChromeTrace(out);
+  return bool(out);
+}
@@ -0,0 +1,66 @@
+#ifndef FRAMEPROFILERMODEL_H
+#define FRAMEPROFILERMODEL_H
+
+class FrameProfiler;
+
+// qt
+#include <QObject>
+#include <QTimer>
+#include <QVariantList>
+
+
+/*!
+ *  FrameProfilerModel
+ *
+ *  - The FrameProfiler statistics of the last StatsFrames frames, for the QML overlay.
+ *  - Refreshed a few times a second while active, i.e. while the overlay is shown;
+ *    each scope is a {name, gpu, mean, max, calls} map, times in ms.
+ *  - GUI thread.
+ */
+class FrameProfilerModel : public QObject {
+  Q_OBJECT
+  Q_PROPERTY(bool         active      READ isActive   WRITE setActive  NOTIFY signActiveChanged)
+  Q_PROPERTY(bool         enabled     READ isEnabled  WRITE setEnabled NOTIFY signEnabledChanged)
+  Q_PROPERTY(double       frameMs     READ frameMs    NOTIFY signStatsChanged)
+  Q_PROPERTY(double       frameMaxMs  READ frameMaxMs NOTIFY signStatsChanged)
+  Q_PROPERTY(QVariantList scopes      READ scopes     NOTIFY signStatsChanged)
+  Q_PROPERTY(QVariantList frameTimes  READ frameTimes NOTIFY signStatsChanged)
+public:
+  static constexpr int      StatsFrames     = 60;
+  static constexpr int      RefreshInterval = 250;    // ms
+
+  explicit FrameProfilerModel( FrameProfiler& profiler, QObject* parent = nullptr );
+
+  bool                      isActive() const { return _timer.isActive(); }
+  void                      setActive( bool active );
+
+  bool                      isEnabled() const;
+  void                      setEnabled( bool enabled );
+
+  double                    frameMs() const { return _frame_ms; }
+  double                    frameMaxMs() const { return _frame_max_ms; }
+  const QVariantList&       scopes() const { return _scopes; }
+  const QVariantList&       frameTimes() const { return _frame_times; }
+
+  // Every frame still in the profiler's ring; false if the file can not be written
+  Q_INVOKABLE bool          writeChromeTrace( const QString& path ) const;
+
+public slots:
+  void                      refresh();
+
+private:
+  FrameProfiler&            _profiler;
+  QTimer                    _timer;
+
+  double                    _frame_ms     {0};
+  double                    _frame_max_ms {0};
+  QVariantList              _scopes;
+  QVariantList              _frame_times;
+
+signals:
+  void                      signActiveChanged();
+  void                      signEnabledChanged();
+  void                      signStatsChanged();
+};
+
+#endif // FRAMEPROFILERMODEL_H
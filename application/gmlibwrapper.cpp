@@ -1,12 +1,10 @@
 #include "gmlibwrapper.h"
 
+#include "batchedrenderer.h"
 #include "../testtorus.h"
 #include "utils.h"
 
 
-// GMlib
-#include <scene/render/gmdefaultselectrenderer.h>
-
 
 // Qt
 #include <QTimerEvent>
@@ -23,13 +21,27 @@
 
 
 
+namespace {
+
+  // createRCPair() makes every renderer a BatchedRenderer
+  BatchedRenderer& batchedRenderer( RenderCamPair& rc_pair ) {
+
+    return static_cast<BatchedRenderer&>( *rc_pair.renderer );
+  }
+
+} // END anonymous namespace
+
+
+
 std::unique_ptr<GMlibWrapper> GMlibWrapper::_instance {nullptr};
 
 GMlibWrapper&
 GMlibWrapper::instance() { return *_instance; }
 
 
-GMlibWrapper::GMlibWrapper() : QObject(), _timer_id{0}/*, _select_renderer{nullptr}*/ {
+GMlibWrapper::GMlibWrapper()
+  : QObject(), _timer_id{0}/*, _select_renderer{nullptr}*/,
+    _replot_scheduler(_worker_pool), _scene_loader(_worker_pool), _parallel_simulator(_worker_pool) {
 
   if(_instance != nullptr) {
 
@@ -51,25 +63,59 @@ GMlibWrapper::~GMlibWrapper() {
 void GMlibWrapper::toggleSimulation() {  _scene->toggleRun(); }
 
 
-void GMlibWrapper::render( const QString& name, const QRect& viewport_in, GMlib::RenderTarget& target ) {
+void GMlibWrapper::render( const QString& name, const QRect& viewport_in, GMlib::RenderTarget& target, const QSize& resolution_in ) {
+
+  FrameProfiler::Scope scope( _profiler, "GMlibWrapper::render" );
 
   auto&        rc_pair = rcPair(name);
   auto&         camera = rc_pair.camera;
   auto&       renderer = rc_pair.renderer;
   auto&       viewport = rc_pair.viewport;
+  auto&     resolution = rc_pair.resolution;
+
+  const auto& size     = viewport_in.size();
+  const auto  res      = resolution_in.isEmpty() ? size : resolution_in;
+  const bool  scaled   = res != size;
+
+  // The camera is reshaped below; its readers on the GUI thread hold the lock as well
+  std::lock_guard<std::mutex> lock(sceneMutex());
 
   // Update viewport
   if(viewport != viewport_in) {
 
     viewport = viewport_in;
-
-    const auto& size = viewport.size();
-    renderer->reshape( GMlib::Vector<int,2>(size.width(),size.height()));
     camera->reshape( 0, 0, size.width(), size.height() );
   }
 
-  // Render and swap buffers
+  // Update render resolution
+  if(resolution != res) {
+
+    resolution = res;
+    renderer->reshape( GMlib::Vector<int,2>(res.width(),res.height()));
+  }
+
+  // This frame answers every request made so far
+  _frame_requested = false;
+
+  // Render and swap buffers; the camera keeps the logical viewport outside of the draw
+  if(scaled) camera->reshape( 0, 0, res.width(), res.height() );
+  _profiler.beginGpu(name);
   renderer->render(target);
+  _profiler.endGpu();
+  if(scaled) camera->reshape( 0, 0, size.width(), size.height() );
+}
+
+void GMlibWrapper::setRenderOnDemand( bool enabled ) {
+
+  _render_on_demand = enabled;
+  requestFrame();
+}
+
+// Thread safe; requests made before the next frame has started are merged into one
+void GMlibWrapper::requestFrame() {
+
+  if( !_frame_requested.exchange(true) )
+    emit signFrameReady();
 }
 
 
@@ -77,30 +123,101 @@ void GMlibWrapper::timerEvent(QTimerEvent* e) {
 
   e->accept();
 
-  _scene->simulate();
-  prepare();
+  FrameProfiler::Scope scope( _profiler, "GMlibWrapper::timerEvent" );
+
+  const auto now = std::chrono::steady_clock::now();
+  const double dt = std::chrono::duration<double>(now - _last_timer_step).count();
+  _last_timer_step = now;
+
+  std::lock_guard<std::mutex> lock(sceneMutex());
+  simulateStep(dt);
+
+  if( _scene->isRunning() )
+    requestFrame();
+}
+
+// One simulation step; the caller holds sceneMutex()
+void GMlibWrapper::simulateStep( double dt ) {
+
+  // Scene::simulate() steps by dt too, not by its own timer, so the parallel pass and
+  // the serial one agree; both scale it by the scene's time scale
+  _scene->setFixedDt(dt);
+  _scene->enabelFixedDt();
+
+  // Parallel pass over independent objects; returns after all of them are done
+  if( _parallel_simulation && _scene->isRunning() ) {
+
+    FrameProfiler::Scope scope( _profiler, "ParallelSimulator::simulate" );
+    _parallel_simulator.simulate( *_scene, dt );
+  }
+
+  {
+    FrameProfiler::Scope scope( _profiler, "Scene::simulate" );
+    _scene->simulate();
+  }
+
+  FrameProfiler::Scope scope( _profiler, "Scene::prepare" );
+  _scene->prepare();
+
+  // Simulated objects moved; the next curve query looks the scene over again
+  _curve_query.invalidateFrame();
 }
 
 
 void GMlibWrapper::start() {
 
-  if( _timer_id || _scene->isRunning() )
+  if( _timer_id || _simulation_thread.isRunning() || _scene->isRunning() )
     return;
 
-  _timer_id = startTimer(16, Qt::PreciseTimer);
   _scene->start();
+  if( _threaded_simulation ) {
+    _simulation_thread.setStepCallback( [this]() { requestFrame(); } );
+    _simulation_thread.setStepFunction( [this]( double dt ) { simulateStep(dt); } );
+    _simulation_thread.start( _scene, _simulation_timestep );
+  }
+  else {
+    _last_timer_step = std::chrono::steady_clock::now();
+    _timer_id = startTimer(16, Qt::PreciseTimer);
+  }
 }
 
 void GMlibWrapper::stop() {
 
-  if( !_timer_id || !_scene->isRunning() )
+  if( (!_timer_id && !_simulation_thread.isRunning()) || !_scene->isRunning() )
     return;
 
+  if( _simulation_thread.isRunning() )
+    _simulation_thread.stop();
+  else {
+    killTimer(_timer_id);
+    _timer_id = 0;
+    _scene->disabelFixedDt();
+  }
   _scene->stop();
-  killTimer(_timer_id);
-  _timer_id = 0;
 }
 
+void GMlibWrapper::setThreadedSimulation( bool enabled, double timestep ) {
+
+  if( timestep <= 0.0 )
+    throw std::invalid_argument("[][]Simulation timestep must be positive!");
+
+  const bool running = _timer_id || _simulation_thread.isRunning();
+  if( running )
+    stop();
+
+  _threaded_simulation = enabled;
+  _simulation_timestep = timestep;
+
+  if( running )
+    start();
+}
+
+bool GMlibWrapper::isThreadedSimulation() const { return _threaded_simulation; }
+
+SimulationThread::State GMlibWrapper::simulationState() const { return _simulation_thread.state(); }
+
+std::mutex& GMlibWrapper::sceneMutex() { return _simulation_thread.sceneMutex(); }
+
 void GMlibWrapper::initialize() {
 
   // Setup and initialized GMlib GL backend
@@ -109,18 +226,27 @@ void GMlibWrapper::initialize() {
   // Setup and init the GMlib GMWindow
   _scene = std::make_shared<GMlib::Scene>();
 
-  // Setup Select Renderer
-  _select_renderer = std::make_shared<GMlib::DefaultSelectRenderer>();
-//  _select_renderer->setSelectRboName("select_render_color_rbo");
+  // Setup Select Renderers
+  _picking_cache.initialize();
+
+  // Replotted curves get their query trees rebuilt on next use
+  _replot_scheduler.setReplotListener( [this]( GMlib::SceneObject* obj ) { _curve_query.invalidate(obj); } );
 }
 
 void GMlibWrapper::cleanUp() {
 
   stop();
 
+  // No replot or load worker may touch a scene object after this point
+  _scene_loader.clear();
+  _replot_scheduler.clear();
+  _view_batch.clear();
+  _curve_query.clear();
+  _profiler.releaseGpu();
+
   cleanupScenario();
 
-  _select_renderer.reset();
+  _picking_cache.cleanUp();
 
   for( auto& rc_pair : _rc_pairs ) {
 
@@ -139,38 +265,22 @@ void GMlibWrapper::cleanUp() {
 GMlib::SceneObject*
 GMlibWrapper::findSceneObject(const QString& rc_name, const GMlib::Point<int,2>& pos) {
 
+  FrameProfiler::Scope scope( _profiler, "GMlibWrapper::findSceneObject" );
 
   if(!_rc_pairs.count(rc_name.toStdString()))
     throw std::invalid_argument("[][]Render/Camera pair '" + rc_name.toStdString() + "'  does not exist in [" + __FILE__ + " on line " + std::to_string(__LINE__) + "]!");
 
-  auto rc_pair = _rc_pairs.at(rc_name.toStdString());
-  auto cam = rc_pair.camera;
-  auto viewport = rc_pair.viewport;
+  const auto& rc_pair  = _rc_pairs.at(rc_name.toStdString());
+  const auto& viewport = rc_pair.viewport;
   GMlib::Vector<int,2> size( viewport.width(), viewport.height() );
 
-  GMlib::SceneObject* sel_obj = nullptr;
-
-  // Setup select renderer to match current view and prepare
-  _select_renderer->setCamera(cam.get());
-  {
-    _select_renderer->reshape( size );
-    _select_renderer->prepare();
-
-    // Render selectors and find object ad pos
-    _select_renderer->select( GMlib::GM_SO_TYPE_SELECTOR );
-    sel_obj = _select_renderer->findObject(pos(0),pos(1));
-
-
-    // Render other objects and find object ad pos
-    if(!sel_obj) {
+  // Select-ID buffers are only re-rendered when the view or the scene changed
+  return _picking_cache.find( *_scene, rc_pair.camera.get(), size, pos );
+}
 
-      _select_renderer->select( -GMlib::GM_SO_TYPE_SELECTOR );
-      sel_obj = _select_renderer->findObject(pos(0),pos(1));
-    }
-  }
-  _select_renderer->releaseCamera();
+void GMlibWrapper::invalidatePickingCache() {
 
-  return sel_obj;
+  _picking_cache.invalidate();
 }
 
 RenderCamPair&
@@ -187,11 +297,29 @@ GMlibWrapper::rcPair(const QString& name) const {
   return _rc_pairs.at(name.toStdString());
 }
 
+std::vector<GMlib::Camera*> GMlibWrapper::rcPairCameras() const {
+
+  std::vector<GMlib::Camera*> cameras;
+  cameras.reserve(_rc_pairs.size());
+  for( const auto& rc_pair : _rc_pairs )
+    cameras.push_back(rc_pair.second.camera.get());
+
+  return cameras;
+}
+
+ReplotScheduler& GMlibWrapper::replotScheduler() { return _replot_scheduler; }
+
+SceneLoader& GMlibWrapper::sceneLoader() { return _scene_loader; }
+
+CurveQueryIndex& GMlibWrapper::curveQuery() { return _curve_query; }
+
+FrameProfiler& GMlibWrapper::profiler() { return _profiler; }
+
 RenderCamPair& GMlibWrapper::createRCPair(const QString& name) {
 
   auto rc_pair = RenderCamPair {};
 
-  rc_pair.renderer = std::make_shared<GMlib::DefaultRenderer>();
+  rc_pair.renderer = std::make_shared<BatchedRenderer>();
   rc_pair.camera   = std::make_shared<GMlib::Camera>();
   rc_pair.renderer->setCamera(rc_pair.camera.get());
 
@@ -228,4 +356,38 @@ GMlibWrapper::camera(const QString& name) const {
   return rcPair(name).camera;
 }
 
-void  GMlibWrapper::prepare() {  _scene->prepare(); }
+void  GMlibWrapper::prepare() {
+
+  FrameProfiler::Scope scope( _profiler, "GMlibWrapper::prepare" );
+
+  std::lock_guard<std::mutex> lock(sceneMutex());
+  _scene->prepare();
+
+  // Objects may have moved; the next curve query looks the scene over again
+  _curve_query.invalidateFrame();
+}
+
+void GMlibWrapper::prepareViews() {
+
+  if(!_batched_rendering || !_scene) return;
+
+  FrameProfiler::Scope scope( _profiler, "GMlibWrapper::prepareViews" );
+
+  std::lock_guard<std::mutex> lock(sceneMutex());
+  _view_batch.build( *_scene, rcPairCameras() );
+
+  // Record every viewport's draw list before any of them issues GL
+  for( auto& rc_pair : _rc_pairs )
+    batchedRenderer(rc_pair.second).setDrawList( _view_batch.drawList(rc_pair.second.camera.get()) );
+}
+
+void GMlibWrapper::setBatchedRendering( bool enabled ) {
+
+  _batched_rendering = enabled;
+  if(enabled) return;
+
+  // Back to per-renderer culling
+  _view_batch.clear();
+  for( auto& rc_pair : _rc_pairs )
+    batchedRenderer(rc_pair.second).setDrawList(nullptr);
+}
@@ -4,6 +4,16 @@
 class TestTorus;
 class GLContextSurfaceWrapper;
 
+#include "curvequeryindex.h"
+#include "frameprofiler.h"
+#include "parallelsimulator.h"
+#include "pickingcache.h"
+#include "replotscheduler.h"
+#include "sceneloader.h"
+#include "simulationthread.h"
+#include "viewbatch.h"
+#include "workerpool.h"
+
 // gmlib
 #include <core/types/gmpoint.h>
 
@@ -12,9 +22,8 @@ namespace GMlib {
   class Scene;
   class SceneObject;
   class Camera;
-  class PointLight;
   class DefaultRenderer;
-  class DefaultSelectRenderer;
+  class PointLight;
   class RenderTarget;
 
   template<typename T, int n>
@@ -34,15 +43,19 @@ class QWheelEvent;
 
 
 // stl
+#include <atomic>
+#include <chrono>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 
 struct RenderCamPair {
   RenderCamPair() {}
-  std::shared_ptr<GMlib::DefaultRenderer>     renderer { nullptr };
+  std::shared_ptr<GMlib::DefaultRenderer>     renderer { nullptr };      // A BatchedRenderer, see createRCPair()
   std::shared_ptr<GMlib::Camera>              camera   { nullptr };
   QRect                                       viewport { QRect(0,0,200,200) };
+  QSize                                       resolution { QSize(200,200) };     // Size rendered at; viewport size unless scaled
 };
 
 
@@ -58,6 +71,23 @@ public:
   void                                              start();
   void                                              stop();
 
+  // Step Scene::simulate on a dedicated thread with a fixed timestep instead of the GUI timer
+  void                                              setThreadedSimulation( bool enabled, double timestep = 1.0 / 120.0 );
+  bool                                              isThreadedSimulation() const;
+  SimulationThread::State                           simulationState() const;
+
+  // Held around every scene access of the render thread while threaded simulation runs
+  std::mutex&                                       sceneMutex();
+
+  // Render on demand: frames are only scheduled through requestFrame() instead of every vsync
+  void                                              setRenderOnDemand( bool enabled );
+  bool                                              isRenderOnDemand() const { return _render_on_demand; }
+  void                                              requestFrame();
+
+  // Step IndependentSimulation objects in parallel ahead of the serial Scene::simulate
+  void                                              setParallelSimulation( bool enabled ) { _parallel_simulation = enabled; }
+  bool                                              isParallelSimulation() const { return _parallel_simulation; }
+
   const std::shared_ptr<GMlib::Scene>&              scene() const;
   const std::shared_ptr<GMlib::Camera>&             camera(const QString& name ) const;
 
@@ -65,23 +95,41 @@ public:
   void                                              cleanUp();
 
   GMlib::SceneObject*                               findSceneObject( const QString& rc_name, const GMlib::Point<int,2>& pos );
+  void                                              invalidatePickingCache();
   QStringListModel&                                 rcNameModel();
 
   RenderCamPair&                                    rcPair(const QString& name);
   const RenderCamPair&                              rcPair(const QString& name) const;
   RenderCamPair&                                    createRCPair( const QString& name );
   void                                              updateRCPairNameModel();
+  std::vector<GMlib::Camera*>                       rcPairCameras() const;
+
+  ReplotScheduler&                                  replotScheduler();
+  SceneLoader&                                      sceneLoader();
 
+  // Closest-point, ray and intersection queries against the curves of the scene; scene locked
+  CurveQueryIndex&                                  curveQuery();
+
+  // CPU scopes of the hot paths and GL timings of every RenderCamPair, per frame
+  FrameProfiler&                                    profiler();
+
+  // The camera keeps the viewport size (picking and HID work in it); a non-empty resolution renders at that size instead
   void                                              render( const QString& name, const QRect& viewport,
-                                                            GMlib::RenderTarget& target );
+                                                            GMlib::RenderTarget& target, const QSize& resolution = QSize() );
 
   void                                              prepare();
 
+  // Cull every RenderCamPair camera in one scene traversal; once per frame, before the viewports render
+  void                                              prepareViews();
+  void                                              setBatchedRendering( bool enabled );
+  bool                                              isBatchedRendering() const { return _batched_rendering; }
+
 public slots:
   void                                              toggleSimulation();
 
 protected:
   void                                              timerEvent(QTimerEvent *e) override;
+  void                                              simulateStep( double dt );
 
   virtual void                                      initializeScenario() = 0;
   virtual void                                      cleanupScenario() = 0;
@@ -92,7 +140,28 @@ private:
   std::shared_ptr<GMlib::Scene>                     _scene;
 
   std::unordered_map<std::string, RenderCamPair>    _rc_pairs;
-  std::shared_ptr<GMlib::DefaultSelectRenderer>     _select_renderer;
+  PickingCache                                      _picking_cache;
+
+  // Shared by the loader, the replots and the parallel simulation; they go before it
+  WorkerPool                                        _worker_pool;
+  ReplotScheduler                                   _replot_scheduler;
+  SceneLoader                                       _scene_loader;
+  CurveQueryIndex                                   _curve_query;
+  FrameProfiler                                     _profiler;
+
+  ViewBatch                                         _view_batch;
+  bool                                              _batched_rendering {true};
+
+  ParallelSimulator                                 _parallel_simulator;
+  bool                                              _parallel_simulation {true};
+  std::chrono::steady_clock::time_point             _last_timer_step;
+
+  bool                                              _render_on_demand {false};
+  std::atomic<bool>                                 _frame_requested {false};
+
+  SimulationThread                                  _simulation_thread;
+  bool                                              _threaded_simulation {false};
+  double                                            _simulation_timestep {1.0 / 120.0};
 
   int                                               _replot_low_medium_high {1};
   bool                                              _move_object_button_pressed {false};
@@ -105,6 +174,7 @@ private:
 
 signals:
   void                                              signFrameReady();
+  void                                              signLoadProgress( int loaded, int total );
 
 
 
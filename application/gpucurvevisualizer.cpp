@@ -0,0 +1,506 @@
+#include "gpucurvevisualizer.h"
+
+// gmlib
+#include <scene/gmsceneobject.h>
+#include <scene/camera/gmcamera.h>
+#include <scene/render/gmdefaultrenderer.h>
+
+// stl
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+
+
+namespace {
+
+  /*!
+   *  One invocation per sample: finds the knot span, builds the basis functions and
+   *  their derivatives in one triangle (The NURBS Book, A2.3) and writes position and
+   *  derivatives for the sample. MAX_DEGREE/MAX_DERIVATIVES size the local arrays.
+   */
+  const char* eval_source = R"(
+layout( local_size_x = 64 ) in;
+
+layout( std430, binding = 0 ) readonly  buffer Knots    { float knots[]; };
+layout( std430, binding = 1 ) readonly  buffer Points   { vec4  points[]; };
+layout( std430, binding = 2 ) writeonly buffer Vertices { vec4  vertices[]; };
+
+uniform int   u_degree;
+uniform int   u_points;
+uniform int   u_samples;
+uniform int   u_derivatives;
+uniform float u_start;
+uniform float u_end;
+uniform float u_scale;
+uniform float u_offset;
+uniform float u_period;
+
+void main() {
+
+  const int i = int( gl_GlobalInvocationID.x );
+  if( i >= u_samples ) return;
+
+  const int p = u_degree;
+  const int n = u_points;
+
+  const float t = u_samples > 1 ? mix( u_start, u_end, float(i) / float(u_samples - 1) ) : u_start;
+  float s = u_offset + u_scale * t;
+  if( u_period > 0.0 ) s = knots[p] + mod( s - knots[p], u_period );
+
+  // knots[span] <= s < knots[span+1], span in [p, n-1]
+  int span = n - 1;
+  if( s < knots[n] ) {
+    int lo = p, hi = n;
+    while( hi - lo > 1 ) {
+      const int mid = (lo + hi) / 2;
+      if( s < knots[mid] ) hi = mid; else lo = mid;
+    }
+    span = lo;
+  }
+
+  float ndu[MAX_DEGREE + 1][MAX_DEGREE + 1];
+  float left[MAX_DEGREE + 1];
+  float right[MAX_DEGREE + 1];
+  ndu[0][0] = 1.0;
+  for( int j = 1; j <= p; ++j ) {
+    left[j]  = s - knots[span + 1 - j];
+    right[j] = knots[span + j] - s;
+    float saved = 0.0;
+    for( int r = 0; r < j; ++r ) {
+      ndu[j][r] = right[r + 1] + left[j - r];
+      const float temp = ndu[r][j - 1] / ndu[j][r];
+      ndu[r][j] = saved + right[r + 1] * temp;
+      saved     = left[j - r] * temp;
+    }
+    ndu[j][j] = saved;
+  }
+
+  const int nd = min( u_derivatives, p );
+  float ders[MAX_DERIVATIVES + 1][MAX_DEGREE + 1];
+  for( int j = 0; j <= p; ++j ) ders[0][j] = ndu[j][p];
+
+  float a[2][MAX_DEGREE + 1];
+  for( int r = 0; r <= p; ++r ) {
+    int s1 = 0, s2 = 1;
+    a[0][0] = 1.0;
+    for( int k = 1; k <= nd; ++k ) {
+      float d = 0.0;
+      const int rk = r - k, pk = p - k;
+      if( r >= k ) {
+        a[s2][0] = a[s1][0] / ndu[pk + 1][rk];
+        d = a[s2][0] * ndu[rk][pk];
+      }
+      const int j1 = rk >= -1 ? 1 : -rk;
+      const int j2 = r - 1 <= pk ? k - 1 : p - r;
+      for( int j = j1; j <= j2; ++j ) {
+        a[s2][j] = (a[s1][j] - a[s1][j - 1]) / ndu[pk + 1][rk + j];
+        d += a[s2][j] * ndu[rk + j][pk];
+      }
+      if( r <= pk ) {
+        a[s2][k] = -a[s1][k - 1] / ndu[pk + 1][r];
+        d += a[s2][k] * ndu[r][pk];
+      }
+      ders[k][r] = d;
+      const int tmp = s1; s1 = s2; s2 = tmp;
+    }
+  }
+
+  // The k-th derivative carries p!/(p-k)! and the k-th power of the parameter scale
+  const int base = i * (u_derivatives + 1);
+  float f = 1.0;
+  for( int k = 0; k <= u_derivatives; ++k ) {
+    vec3 c = vec3( 0.0 );
+    if( k <= nd )
+      for( int j = 0; j <= p; ++j )
+        c += ders[k][j] * points[span - p + j].xyz;
+    vertices[base + k] = vec4( f * c, k == 0 ? 1.0 : 0.0 );
+    f *= float(p - k) * u_scale;
+  }
+}
+)";
+
+  const char* vertex_source = R"(#version 330 core
+uniform mat4 u_mvpmat;
+layout( location = 0 ) in vec4 in_vertex;
+void main() { gl_Position = u_mvpmat * vec4( in_vertex.xyz, 1.0 ); }
+)";
+
+  const char* fragment_source = R"(#version 330 core
+uniform vec4 u_color;
+out vec4 frag_color;
+void main() { frag_color = u_color; }
+)";
+
+  GLuint compileShader( GLenum type, const std::string& source ) {
+
+    const GLuint shader = glCreateShader(type);
+    const char* src = source.c_str();
+    glShaderSource( shader, 1, &src, nullptr );
+    glCompileShader( shader );
+
+    GLint ok = GL_FALSE;
+    glGetShaderiv( shader, GL_COMPILE_STATUS, &ok );
+    if( !ok ) {
+      char log[1024];
+      glGetShaderInfoLog( shader, sizeof(log), nullptr, log );
+      std::cerr << "GpuCurveVisualizer: shader compilation failed: " << log << std::endl;
+      glDeleteShader( shader );
+      return 0;
+    }
+
+    return shader;
+  }
+
+  GLuint linkProgram( const std::vector<GLuint>& shaders ) {
+
+    for( auto shader : shaders )
+      if( !shader ) {
+        for( auto s : shaders ) if( s ) glDeleteShader(s);
+        return 0;
+      }
+
+    const GLuint program = glCreateProgram();
+    for( auto shader : shaders )
+      glAttachShader( program, shader );
+    glLinkProgram( program );
+    for( auto shader : shaders ) {
+      glDetachShader( program, shader );
+      glDeleteShader( shader );
+    }
+
+    GLint ok = GL_FALSE;
+    glGetProgramiv( program, GL_LINK_STATUS, &ok );
+    if( !ok ) {
+      char log[1024];
+      glGetProgramInfoLog( program, sizeof(log), nullptr, log );
+      std::cerr << "GpuCurveVisualizer: program link failed: " << log << std::endl;
+      glDeleteProgram( program );
+      return 0;
+    }
+
+    return program;
+  }
+
+  void pack( const GMlib::Vector<float,3>& v, float w, GLfloat* out ) {
+
+    out[0] = v[0];  out[1] = v[1];  out[2] = v[2];  out[3] = w;
+  }
+
+  bool same( const GMlib::Vector<float,3>& a, const GMlib::Vector<float,3>& b ) {
+
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+  }
+
+} // END anonymous namespace
+
+
+
+
+float GpuCurveVisualizer::_pixel_tolerance = 0.5f;
+
+GpuCurveVisualizer::GpuCurveVisualizer( int m, int d ) : _m{std::max(m,1)}, _d{std::max(0,std::min(d,MaxDerivatives))} {}
+
+GpuCurveVisualizer::GpuCurveVisualizer( const GpuCurveVisualizer& copy )
+  : GMlib::PCurveVisualizer<float,3>(copy), _m{copy._m}, _d{copy._d} {}
+
+GpuCurveVisualizer::~GpuCurveVisualizer() { releaseGL(); }
+
+// Compute shaders and std430 storage buffers are core in GL 4.3
+bool GpuCurveVisualizer::isSupported() { return GLEW_VERSION_4_3 != 0; }
+
+GpuCurveVisualizer* GpuCurveVisualizer::find( GMlib::SceneObject* obj ) {
+
+  if( !obj ) return nullptr;
+
+  auto& visualizers = obj->getVisualizers();
+  for( int i = 0; i < visualizers.getSize(); ++i )
+    if( auto gpu = dynamic_cast<GpuCurveVisualizer*>( visualizers[i] ) )
+      return gpu;
+
+  return nullptr;
+}
+
+void GpuCurveVisualizer::setSampling( int m, int d ) {
+
+  _m = std::max(m,1);
+  _d = std::max(0,std::min(d,MaxDerivatives));
+}
+
+bool GpuCurveVisualizer::initGL() {
+
+  if( _draw_program ) return true;
+  if( _gl_failed )    return false;
+
+  _draw_program = linkProgram( { compileShader( GL_VERTEX_SHADER, vertex_source ),
+                                 compileShader( GL_FRAGMENT_SHADER, fragment_source ) } );
+  if( isSupported() ) {
+    const std::string header = "#version 430 core\n"
+                               "#define MAX_DEGREE "      + std::to_string(MaxDegree)      + "\n"
+                               "#define MAX_DERIVATIVES " + std::to_string(MaxDerivatives) + "\n";
+    _eval_program = linkProgram( { compileShader( GL_COMPUTE_SHADER, header + eval_source ) } );
+  }
+
+  if( !_draw_program ) {
+    releaseGL();
+    _gl_failed = true;
+    return false;
+  }
+
+  _u_mvpmat = glGetUniformLocation( _draw_program, "u_mvpmat" );
+  _u_color  = glGetUniformLocation( _draw_program, "u_color" );
+
+  glGenBuffers( 1, &_knot_buffer );
+  glGenBuffers( 1, &_point_buffer );
+  glGenBuffers( 1, &_vertex_buffer );
+  return true;
+}
+
+void GpuCurveVisualizer::releaseGL() {
+
+  if( _eval_program )  glDeleteProgram( _eval_program );
+  if( _draw_program )  glDeleteProgram( _draw_program );
+  if( _knot_buffer )   glDeleteBuffers( 1, &_knot_buffer );
+  if( _point_buffer )  glDeleteBuffers( 1, &_point_buffer );
+  if( _vertex_buffer ) glDeleteBuffers( 1, &_vertex_buffer );
+  _stream.release();
+  for( auto& level : _levels )
+    glDeleteBuffers( 1, &level.buffer );
+  _levels.clear();
+  _lod_revision = -1;
+
+  _eval_program = _draw_program = 0;
+  _knot_buffer = _point_buffer = _vertex_buffer = 0;
+  _knots.clear();
+  _points.clear();
+  _vertex_bytes = 0;
+  _vertices = 0;
+}
+
+/*!
+ *  evaluate(obj)
+ *
+ *  - Evaluates the curve into the vertex buffer on the GPU. Returns false, leaving the
+ *    buffer as it was, when the object is no GpuEvaluableCurve, has no B-spline form of
+ *    at most MaxDegree, or the context can not run the compute shader.
+ */
+bool GpuCurveVisualizer::evaluate( const GMlib::SceneObject* obj ) {
+
+  auto curve = dynamic_cast<const GpuEvaluableCurve*>(obj);
+  if( !curve || !initGL() || !_eval_program )
+    return false;
+
+  GpuBSplineForm form;
+  if( !curve->gpuBSplineForm(form) )
+    return false;
+
+  const int n = int( form.points.size() );
+  if( form.degree < 0 || form.degree > MaxDegree || n <= form.degree
+      || int( form.knots.size() ) != n + form.degree + 1 )
+    return false;
+
+  uploadForm( form );
+
+  const GLsizeiptr bytes = GLsizeiptr(_m) * (_d + 1) * 4 * GLsizeiptr(sizeof(GLfloat));
+  glBindBuffer( GL_SHADER_STORAGE_BUFFER, _vertex_buffer );
+  if( bytes != _vertex_bytes ) {
+    glBufferData( GL_SHADER_STORAGE_BUFFER, bytes, nullptr, GL_DYNAMIC_COPY );
+    _vertex_bytes = bytes;
+  }
+
+  glUseProgram( _eval_program );
+  glUniform1i( glGetUniformLocation( _eval_program, "u_degree" ),      form.degree );
+  glUniform1i( glGetUniformLocation( _eval_program, "u_points" ),      n );
+  glUniform1i( glGetUniformLocation( _eval_program, "u_samples" ),     _m );
+  glUniform1i( glGetUniformLocation( _eval_program, "u_derivatives" ), _d );
+  glUniform1f( glGetUniformLocation( _eval_program, "u_start" ),       form.start );
+  glUniform1f( glGetUniformLocation( _eval_program, "u_end" ),         form.end );
+  glUniform1f( glGetUniformLocation( _eval_program, "u_scale" ),       form.scale );
+  glUniform1f( glGetUniformLocation( _eval_program, "u_offset" ),      form.offset );
+  glUniform1f( glGetUniformLocation( _eval_program, "u_period" ),      form.period );
+
+  glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, _knot_buffer );
+  glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 1, _point_buffer );
+  glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, _vertex_buffer );
+  glDispatchCompute( GLuint( (_m + 63) / 64 ), 1, 1 );
+
+  // The draw reads the buffer as vertex attributes
+  glMemoryBarrier( GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT );
+
+  for( GLuint binding = 0; binding < 3; ++binding )
+    glBindBufferBase( GL_SHADER_STORAGE_BUFFER, binding, 0 );
+  glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+  glUseProgram( 0 );
+
+  _vertices = _m;
+  _stride   = GLsizei( (_d + 1) * 4 * sizeof(GLfloat) );
+  _streamed = false;
+  return true;
+}
+
+// Knots are written whole when they changed; control points as the one range spanning the changes
+void GpuCurveVisualizer::uploadForm( const GpuBSplineForm& form ) {
+
+  if( form.knots != _knots ) {
+
+    glBindBuffer( GL_SHADER_STORAGE_BUFFER, _knot_buffer );
+    glBufferData( GL_SHADER_STORAGE_BUFFER, GLsizeiptr( form.knots.size() * sizeof(GLfloat) ), form.knots.data(), GL_STATIC_DRAW );
+    _knots = form.knots;
+  }
+
+  const size_t n = form.points.size();
+  size_t first = 0, last = n;
+  if( n == _points.size() ) {
+
+    while( first < n && same( form.points[first], _points[first] ) ) ++first;
+    while( last > first && same( form.points[last - 1], _points[last - 1] ) ) --last;
+  }
+
+  _last_upload = last - first;
+  if( _last_upload == 0 )
+    return;
+
+  std::vector<GLfloat> data( 4 * _last_upload );
+  for( size_t i = first; i < last; ++i )
+    pack( form.points[i], 1.0f, &data[4 * (i - first)] );
+
+  glBindBuffer( GL_SHADER_STORAGE_BUFFER, _point_buffer );
+  if( n != _points.size() )
+    glBufferData( GL_SHADER_STORAGE_BUFFER, GLsizeiptr( data.size() * sizeof(GLfloat) ), data.data(), GL_DYNAMIC_DRAW );
+  else
+    glBufferSubData( GL_SHADER_STORAGE_BUFFER, GLintptr( 4 * first * sizeof(GLfloat) ), GLsizeiptr( data.size() * sizeof(GLfloat) ), data.data() );
+  glBindBuffer( GL_SHADER_STORAGE_BUFFER, 0 );
+
+  _points = form.points;
+}
+
+// CPU sampling, when the curve was sampled through GMlib; same layout as the compute shader writes
+void GpuCurveVisualizer::replot( const GMlib::DVector< GMlib::DVector< GMlib::Vector<float,3> > >& p,
+                                 int m, int d, bool /*closed*/ ) {
+
+  if( m < 1 || !initGL() )
+    return;
+
+  const GLsizeiptr bytes = GLsizeiptr(m) * (d + 1) * 4 * GLsizeiptr(sizeof(GLfloat));
+  auto data = static_cast<GLfloat*>( _stream.beginWrite( bytes ) );
+  if( !data )
+    return;
+
+  for( int i = 0; i < m; ++i )
+    for( int k = 0; k <= d; ++k )
+      pack( p[i][k], k == 0 ? 1.0f : 0.0f, &data[ (size_t(i) * size_t(d + 1) + size_t(k)) * 4 ] );
+  _stream.endWrite();
+
+  _vertices = m;
+  _stride   = GLsizei( (d + 1) * 4 * sizeof(GLfloat) );
+  _streamed = true;
+}
+
+void GpuCurveVisualizer::render( const GMlib::SceneObject* obj, const GMlib::DefaultRenderer* renderer ) const {
+
+  const auto camera = renderer->getCamera();
+  draw( obj->getModelViewProjectionMatrix( camera ), obj->getColor(), selectLevel( obj, camera ) );
+}
+
+void GpuCurveVisualizer::renderGeometry( const GMlib::SceneObject* obj, const GMlib::Renderer* renderer, const GMlib::Color& color ) const {
+
+  const auto camera = renderer->getCamera();
+  draw( obj->getModelViewProjectionMatrix( camera ), color, selectLevel( obj, camera ) );
+}
+
+/*!
+ *  selectLevel(obj, camera)
+ *
+ *  - World units project to P(1,1) h/2 / z pixels at eye depth z, for a viewport h pixels
+ *    high; z is taken at the near side of the surrounding sphere. Returns the coarsest
+ *    level within the pixel tolerance, -1 when none is or the curve has no levels.
+ */
+int GpuCurveVisualizer::selectLevel( const GMlib::SceneObject* obj, const GMlib::Camera* camera ) const {
+
+  _last_level = -1;
+
+  auto lod = dynamic_cast<const LodSampledCurve*>( obj );
+  if( !_streamed || !lod || !camera )
+    return -1;
+
+  if( lod->lodRevision() != _lod_revision )
+    uploadLevels( *lod );
+
+  const auto& sphere = obj->getSurroundingSphereClean();
+  if( _levels.empty() || !sphere.isValid() )
+    return -1;
+
+  const double depth = double( (sphere.getPos() - camera->getPos()) * camera->getDir() ) - double( sphere.getRadius() );
+  if( depth <= 0.0 )
+    return -1;
+
+  GLint viewport[4];
+  glGetIntegerv( GL_VIEWPORT, viewport );
+  const double pixels = double( camera->getProjectionMatrix()[1][1] ) * 0.5 * double( viewport[3] ) / depth;
+
+  for( int level = int( _levels.size() ) - 1; level >= 0; --level )
+    if( _levels[level].vertices > 1 && double( _levels[level].tolerance ) * pixels <= double( _pixel_tolerance ) )
+      return _last_level = level;
+
+  return -1;
+}
+
+// All levels at once; they change with full replots only
+void GpuCurveVisualizer::uploadLevels( const LodSampledCurve& lod ) const {
+
+  std::vector<float> xyz;
+  const int count = lod.lodLevelCount();
+
+  for( int level = count; level < int( _levels.size() ); ++level )
+    glDeleteBuffers( 1, &_levels[level].buffer );
+  _levels.resize( count );
+
+  for( int level = 0; level < count; ++level ) {
+
+    auto& l = _levels[level];
+    if( !l.buffer )
+      glGenBuffers( 1, &l.buffer );
+
+    lod.lodPositions( level, xyz );
+    l.vertices  = GLsizei( xyz.size() / 3 );
+    l.tolerance = lod.lodTolerance( level );
+
+    glBindBuffer( GL_ARRAY_BUFFER, l.buffer );
+    glBufferData( GL_ARRAY_BUFFER, GLsizeiptr( xyz.size() * sizeof(GLfloat) ), xyz.data(), GL_STATIC_DRAW );
+  }
+  glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+  _lod_revision = lod.lodRevision();
+}
+
+void GpuCurveVisualizer::draw( const GMlib::HqMatrix<float,3>& mvpmat, const GMlib::Color& color, int level ) const {
+
+  if( !_vertices || !_draw_program )
+    return;
+
+  glUseProgram( _draw_program );
+  glUniformMatrix4fv( _u_mvpmat, 1, GL_TRUE, mvpmat.getPtr() );
+  glUniform4f( _u_color, GLfloat( color.getRed() ), GLfloat( color.getGreen() ), GLfloat( color.getBlue() ), GLfloat( color.getAlpha() ) );
+
+  glEnableVertexAttribArray( 0 );
+  if( level >= 0 ) {
+
+    // Levels are tightly packed positions; w defaults to 1
+    glBindBuffer( GL_ARRAY_BUFFER, _levels[level].buffer );
+    glVertexAttribPointer( 0, 3, GL_FLOAT, GL_FALSE, 0, nullptr );
+    glDrawArrays( GL_LINE_STRIP, 0, _levels[level].vertices );
+  }
+  else {
+
+    glBindBuffer( GL_ARRAY_BUFFER, _streamed ? _stream.buffer() : _vertex_buffer );
+    glVertexAttribPointer( 0, 4, GL_FLOAT, GL_FALSE, _stride, reinterpret_cast<const GLvoid*>( _streamed ? _stream.offset() : 0 ) );
+    glDrawArrays( GL_LINE_STRIP, 0, _vertices );
+
+    if( _streamed )
+      _stream.fence();
+  }
+  glDisableVertexAttribArray( 0 );
+  glBindBuffer( GL_ARRAY_BUFFER, 0 );
+
+  glUseProgram( 0 );
+}
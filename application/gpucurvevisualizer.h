@@ -0,0 +1,119 @@
+#ifndef GPUCURVEVISUALIZER_H
+#define GPUCURVEVISUALIZER_H
+
+#include "streamingvertexbuffer.h"
+#include "../work/gpuevaluation.h"
+#include "../work/lodsampling.h"
+
+// gmlib
+#include <opengl/gmopengl.h>
+#include <parametrics/visualizers/gmpcurvevisualizer.h>
+
+// stl
+#include <vector>
+
+
+/*!
+ *  GpuCurveVisualizer
+ *
+ *  - Draws a curve from a vertex buffer filled by a compute shader: evaluate() takes the
+ *    B-spline form of a GpuEvaluableCurve (MyB_spline, ClosedSubdivisionCurve) and writes
+ *    m samples with d derivatives, [sample][derivative] as vec4, straight into the
+ *    buffer it draws from. No geometry passes through the CPU.
+ *  - Knots and control points stay on the GPU between evaluations. A changed knot vector
+ *    is written whole; of the control points only the range that changed since the last
+ *    upload is written again, unless their count changed.
+ *  - Inserted in place of the default visualizer. ReplotScheduler replots curves that
+ *    carry one through evaluate(). When the context has no compute shaders (GL < 4.3),
+ *    or the curve has no B-spline form, evaluate() returns false and the curve is
+ *    sampled as usual. replot() then streams the CPU samples through a
+ *    StreamingVertexBuffer, which also suits any other PCurve<float,3> that is replotted
+ *    often: a write of unchanged size goes in place, without reallocation or a stall.
+ *  - Samples streamed from the CPU give way to the levels of detail of a LodSampledCurve:
+ *    each render picks, for its camera, the coarsest level whose deviation projects to
+ *    at most the pixel tolerance, from the surrounding sphere and the viewport height.
+ *    A view that needs more than the finest level draws the replot samples.
+ *  - GL thread only.
+ */
+class GpuCurveVisualizer : public GMlib::PCurveVisualizer<float,3> {
+  GM_VISUALIZER(GpuCurveVisualizer)
+public:
+  static constexpr int  MaxDegree      = 7;
+  static constexpr int  MaxDerivatives = 2;
+
+  explicit GpuCurveVisualizer( int m = 500, int d = 0 );
+  GpuCurveVisualizer( const GpuCurveVisualizer& copy );
+  ~GpuCurveVisualizer() override;
+
+  static bool                   isSupported();
+  static GpuCurveVisualizer*    find( GMlib::SceneObject* obj );
+
+  void                          setSampling( int m, int d = 0 );
+  int                           getSamples() const { return _m; }
+  int                           getDerivatives() const { return _d; }
+
+  bool                          evaluate( const GMlib::SceneObject* obj );
+
+  // Screen-space deviation allowed when a level of detail is picked, in pixels
+  static void                   setPixelTolerance( float pixels ) { _pixel_tolerance = pixels; }
+  static float                  getPixelTolerance() { return _pixel_tolerance; }
+
+  // Level drawn by the last render; -1 for the full samples
+  int                           getLastLevel() const { return _last_level; }
+
+  // Control points written by the last evaluate()
+  size_t                        getLastUploadCount() const { return _last_upload; }
+
+  void                          render( const GMlib::SceneObject* obj, const GMlib::DefaultRenderer* renderer ) const override;
+  void                          renderGeometry( const GMlib::SceneObject* obj, const GMlib::Renderer* renderer, const GMlib::Color& color ) const override;
+
+  void                          replot( const GMlib::DVector< GMlib::DVector< GMlib::Vector<float,3> > >& p,
+                                        int m, int d, bool closed ) override;
+
+private:
+  bool                          initGL();
+  void                          releaseGL();
+  void                          uploadForm( const GpuBSplineForm& form );
+  void                          draw( const GMlib::HqMatrix<float,3>& mvpmat, const GMlib::Color& color, int level ) const;
+  int                           selectLevel( const GMlib::SceneObject* obj, const GMlib::Camera* camera ) const;
+  void                          uploadLevels( const LodSampledCurve& lod ) const;
+
+  int                           _m;
+  int                           _d;
+
+  // GL objects are made on first use, per instance
+  bool                          _gl_failed      {false};
+  GLuint                        _eval_program   {0};
+  GLuint                        _draw_program   {0};
+  GLuint                        _knot_buffer    {0};
+  GLuint                        _point_buffer   {0};
+  GLuint                        _vertex_buffer  {0};     // Compute shader output
+  mutable StreamingVertexBuffer _stream;                 // CPU samples
+  bool                          _streamed       {false}; // Last written by replot()
+  GLint                         _u_mvpmat       {-1};
+  GLint                         _u_color        {-1};
+
+  // What the GPU holds; edits are diffed against it
+  std::vector<float>            _knots;
+  std::vector<GMlib::Vector<float,3>> _points;
+  size_t                        _last_upload    {0};
+
+  GLsizeiptr                    _vertex_bytes   {0};
+  GLsizei                       _vertices       {0};
+  GLsizei                       _stride         {0};
+
+  // Levels of detail as last uploaded; refreshed from render() when the curve has new ones
+  struct Level {
+    GLuint                      buffer          {0};
+    GLsizei                     vertices        {0};
+    float                       tolerance       {0};
+  };
+  mutable std::vector<Level>    _levels;
+  mutable int                   _lod_revision   {-1};
+  mutable int                   _last_level     {-1};
+
+  static float                  _pixel_tolerance;
+};
+
+
+#endif // GPUCURVEVISUALIZER_H
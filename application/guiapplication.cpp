@@ -21,7 +21,8 @@
 std::unique_ptr<GuiApplication> GuiApplication::_instance {nullptr};
 
 
-GuiApplication::GuiApplication(int& argc, char **argv) : QGuiApplication(argc, argv) {
+GuiApplication::GuiApplication(int& argc, char **argv)
+  : QGuiApplication(argc, argv), _profiler_model(_scenario.profiler()) {
 
   assert(!_instance);
   _instance = std::unique_ptr<GuiApplication>(this);
@@ -29,6 +30,8 @@ GuiApplication::GuiApplication(int& argc, char **argv) : QGuiApplication(argc, a
 
   qRegisterMetaType<HidInputEvent::HidInputParams> ("HidInputEvent::HidInputParams");
 
+  _scenario.profiler().setThreadName("GUI");
+
   connect( &_window, &Window::sceneGraphInitialized,
            this,     &GuiApplication::onSceneGraphInitialized,
            Qt::DirectConnection );
@@ -45,6 +48,7 @@ GuiApplication::GuiApplication(int& argc, char **argv) : QGuiApplication(argc, a
 
   _window.rootContext()->setContextProperty( "rc_name_model", &_scenario.rcNameModel() );
   _window.rootContext()->setContextProperty( "hidmanager_model", _hidmanager.getModel() );
+  _window.rootContext()->setContextProperty( "frame_profiler", &_profiler_model );
   _window.setSource(QUrl("qrc:///qml/main.qml"));
 
   _window.show();
@@ -66,6 +70,9 @@ GuiApplication::onSceneGraphInitialized() {
 
   qDebug() << "GL context: " << QOpenGLContext::currentContext()->format();
 
+  // Same as the GUI thread under the basic render loop; the first name sticks
+  _scenario.profiler().setThreadName("Render");
+
   // Init GMlibWrapper
   _scenario.initialize();
   _hidmanager.init(_scenario);
@@ -97,6 +104,10 @@ GuiApplication::afterOnSceneGraphInitialized() {
   connect( &_window, &Window::signMouseReleased,      &_hidmanager, &StandardHidManager::registerMouseReleaseEvent );
   connect( &_window, &Window::signWheelEventOccurred, &_hidmanager, &StandardHidManager::registerWheelEvent );
 
+  // Coalesced move/wheel events are dispatched once per frame, ahead of the scene graph sync
+  connect( &_window,     &Window::afterAnimating,                &_hidmanager, &StandardHidManager::flushMotionEvents );
+  connect( &_hidmanager, &StandardHidManager::signMotionPending, &_window,     &Window::update );
+
   // Handle HID OpenGL actions; needs to have the OGL context bound;
   // QQuickWindow's beforeRendering singnal provides that on a DirectConnection
   connect( &_window, &Window::beforeRendering,        &_hidmanager, &DefaultHidManager::triggerOGLActions,
@@ -116,14 +127,41 @@ GuiApplication::afterOnSceneGraphInitialized() {
   connect( &_hidmanager,          SIGNAL(signOpenCloseHidHelp()),
            _window.rootObject(),  SIGNAL(toggleHidBindView()) );
 
+  connect( &_hidmanager,          SIGNAL(signOpenCloseFrameProfiler()),
+           _window.rootObject(),  SIGNAL(toggleFrameProfilerView()) );
+
+  // Time every HID action; OpenGL actions are triggered on the render thread
+  auto& profiler = _scenario.profiler();
+  connect( &_hidmanager, &HidManager::signBeforeHidAction, &_scenario,
+           [&profiler]() { profiler.begin("HidManager::triggerAction"); }, Qt::DirectConnection );
+  connect( &_hidmanager, &HidManager::signAfterHidAction,  &_scenario,
+           [&profiler]() { profiler.end(); }, Qt::DirectConnection );
+
+  // Progress of the staged scene load; emitted on the render thread
+  connect( &_scenario,            SIGNAL(signLoadProgress(int,int)),
+           _window.rootObject(),  SIGNAL(loadProgress(int,int)) );
+
   // Update RCPair name model
   _scenario.updateRCPairNameModel();
 
-  // Start simulator
+  // Only render when something changed
+  if( arguments().contains("--render-on-demand") )
+    _scenario.setRenderOnDemand(true);
+
+  // Start simulator; "--threaded-simulation" steps the scene at a fixed rate off the GUI thread
+  if( arguments().contains("--threaded-simulation") )
+    _scenario.setThreadedSimulation(true);
   _scenario.start();
 
 
   connect( &_window, &Window::beforeRendering, &_scenario, &Scenario::callDefferedGL, Qt::DirectConnection );
+
+  // After the deferred replots, so that the culling sees this frame's bounding spheres
+  connect( &_window, &Window::beforeRendering, &_scenario, &GMlibWrapper::prepareViews, Qt::DirectConnection );
+
+  // Frames of the profiler end once the scene graph has rendered
+  connect( &_window, &Window::afterRendering, &_scenario,
+           [&profiler]() { profiler.endFrame(); }, Qt::DirectConnection );
 }
 
 const GuiApplication& GuiApplication::instance() {  return *_instance; }
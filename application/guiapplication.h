@@ -2,6 +2,7 @@
 #define GUIAPPLICATION_H
 
 
+#include "frameprofilermodel.h"
 #include "gmlibwrapper.h"
 #include "window.h"
 #include "../scenario.h"
@@ -33,6 +34,7 @@ private:
   Window                                      _window;
   Scenario                                    _scenario;
   DefaultHidManager                           _hidmanager;
+  FrameProfilerModel                          _profiler_model;
 
 private slots:
   virtual void                                onSceneGraphInitialized();
@@ -0,0 +1,342 @@
+#include "headlessrenderer.h"
+
+#include "window.h"
+#include "../scenario.h"
+
+// gmlib
+#include <scene/render/gmrendertarget.h>
+
+// qt
+#include <QDir>
+#include <QOffscreenSurface>
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QStringListModel>
+
+// stl
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+
+namespace {
+
+  class FboRenderTarget : public GMlib::RenderTarget {
+  public:
+    FboRenderTarget() { _gl.initializeOpenGLFunctions(); }
+    GLuint _fbo {0};
+
+  private:
+    mutable QOpenGLFunctions _gl;
+
+    void doPrepare()  const override {}
+    void doBind()   const override { _gl.glBindFramebuffer(GL_FRAMEBUFFER,_fbo); }
+    void doUnbind() const override { _gl.glBindFramebuffer(GL_FRAMEBUFFER,0x0); }
+    void doResize()  override {}
+  };
+
+  int toInt( const QStringList& args, int i, int min ) {
+
+    bool ok     = false;
+    const int v = i < args.size() ? args[i].toInt(&ok) : 0;
+    if( !ok || v < min )
+      throw std::invalid_argument("[][]" + args[i-1].toStdString() + " needs a number of at least " + std::to_string(min) + "!");
+    return v;
+  }
+
+  QString toString( const QStringList& args, int i ) {
+
+    if( i >= args.size() )
+      throw std::invalid_argument("[][]" + args[i-1].toStdString() + " needs a value!");
+    return args[i];
+  }
+}
+
+
+struct HeadlessRenderer::Readback {
+  QOpenGLBuffer                           pbo {QOpenGLBuffer::PixelPackBuffer};
+  QSize                                   size;
+  QString                                 path;
+  bool                                    pending {false};
+};
+
+
+HeadlessRenderer::Options
+HeadlessRenderer::parseArguments( const QStringList& args ) {
+
+  Options options;
+  for( int i = 1; i < args.size(); ++i ) {
+
+    const auto& arg = args[i];
+    if( arg == "--frames" )
+      options.frames = toInt( args, ++i, 1 );
+    else if( arg == "--samples" )
+      options.samples = toInt( args, ++i, 0 );
+    else if( arg == "--output" )
+      options.output = toString( args, ++i );
+    else if( arg == "--trace" )
+      options.trace = toString( args, ++i );
+    else if( arg == "--timeout" )
+      options.timeout = toInt( args, ++i, 0 );
+    else if( arg == "--size" ) {
+
+      const auto wh = toString( args, ++i ).split('x');
+      bool ok_w = false, ok_h = false;
+      options.size = wh.size() == 2 ? QSize( wh[0].toInt(&ok_w), wh[1].toInt(&ok_h) ) : QSize();
+      if( !ok_w || !ok_h || options.size.isEmpty() )
+        throw std::invalid_argument("[][]--size needs <width>x<height>!");
+    }
+  }
+
+  return options;
+}
+
+HeadlessRenderer::HeadlessRenderer( Scenario& scenario ) : _scenario(scenario) {}
+
+HeadlessRenderer::~HeadlessRenderer() {
+
+  stopWriters();
+}
+
+int HeadlessRenderer::run( const Options& options ) {
+
+  QOpenGLContext context;
+  context.setFormat( Window::surfaceFormat() );
+  if( !context.create() )
+    throw std::runtime_error("[][]Headless: no OpenGL context could be created!");
+
+  QOffscreenSurface surface;
+  surface.setFormat( context.format() );
+  surface.create();
+  if( !context.makeCurrent(&surface) )
+    throw std::runtime_error("[][]Headless: the offscreen surface can not be made current!");
+
+  auto& profiler = _scenario.profiler();
+  profiler.setThreadName("Headless");
+
+  // Same setup as the windowed application, without the simulation timer
+  _scenario.initialize();
+  _scenario.initializeScenario();
+  _scenario.prepare();
+  _scenario.updateRCPairNameModel();
+  settle( options.timeout );
+
+  // Views share the FBOs; the read back copy of one view is ordered before the next renders
+  QOpenGLFramebufferObjectFormat format;
+  format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+  format.setSamples(options.samples);
+  _render_fbo.reset( new QOpenGLFramebufferObject(options.size, format) );
+  if( _render_fbo->format().samples() > 0 )
+    _resolve_fbo.reset( new QOpenGLFramebufferObject(options.size) );
+
+  if( !options.output.isEmpty() ) {
+
+    if( !QDir().mkpath(options.output) )
+      throw std::invalid_argument("[][]Headless: output directory '" + options.output.toStdString() + "' can not be created!");
+
+    for( int i = 0; i < ReadbackSlots; ++i )
+      _readbacks.emplace_back( new Readback );
+
+    // Encoding png takes longer than rendering a view
+    const unsigned int threads = std::max( 1u, std::thread::hardware_concurrency() / 2 );
+    for( unsigned int i = 0; i < threads; ++i )
+      _writers.emplace_back( &HeadlessRenderer::writeLoop, this );
+  }
+
+  const auto names = _scenario.rcNameModel().stringList();
+  const auto start = std::chrono::steady_clock::now();
+
+  for( int frame = 0; frame < options.frames; ++frame ) {
+
+    // Edits and replots of the previous frame land as in the windowed render loop
+    if( frame > 0 )
+      _scenario.callDefferedGL();
+
+    _scenario.prepare();
+    _scenario.prepareViews();
+    for( const auto& name : names )
+      renderView( name, frame, options );
+
+    profiler.endFrame();
+  }
+
+  // Oldest first
+  for( size_t i = 0; i < _readbacks.size(); ++i )
+    finish( *_readbacks[ (_next_readback + i) % _readbacks.size() ] );
+
+  // Every view is on the GPU's queue until here
+  context.functions()->glFinish();
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  stopWriters();
+
+  const size_t views = size_t(options.frames) * size_t(names.size());
+  std::cout << "Headless: " << views << " views rendered in " << elapsed << " s ("
+            << (elapsed > 0 ? views / elapsed : 0.0) << " views/s), "
+            << _written << " images written";
+  if( _failed )
+    std::cout << ", " << _failed << " failed";
+  std::cout << std::endl;
+
+  if( !options.trace.isEmpty() ) {
+
+    std::ofstream out( options.trace.toStdString() );
+    profiler.writeChromeTrace(out);
+    if( !out )
+      std::cerr << "Headless: trace '" << options.trace.toStdString() << "' could not be written" << std::endl;
+  }
+
+  // GL resources go while the context is current
+  _readbacks.clear();
+  _resolve_fbo.reset();
+  _render_fbo.reset();
+  _scenario.cleanUp();
+  context.doneCurrent();
+
+  return _failed ? 1 : 0;
+}
+
+// Loads and replots until nothing is pending; they would otherwise show up only in later frames
+void HeadlessRenderer::settle( double timeout ) {
+
+  auto& loader   = _scenario.sceneLoader();
+  auto& replots  = _scenario.replotScheduler();
+  const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+
+  while( loader.isLoading() || replots.getPendingCount() > 0 ) {
+
+    if( std::chrono::steady_clock::now() > end ) {
+
+      std::cerr << "Headless: scene not settled after " << timeout << " s; rendering it as it is" << std::endl;
+      return;
+    }
+
+    const auto loaded  = loader.getLoaded();
+    const auto pending = replots.getPendingCount();
+    _scenario.callDefferedGL();
+
+    // Waiting on the load and replot workers
+    if( loader.getLoaded() == loaded && replots.getPendingCount() == pending )
+      std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+  }
+}
+
+void HeadlessRenderer::renderView( const QString& name, int frame, const Options& options ) {
+
+  FboRenderTarget target;
+  target._fbo = _render_fbo->handle();
+  _scenario.render( name, QRect(QPoint(0,0),options.size), target );
+
+  if( _resolve_fbo )
+    QOpenGLFramebufferObject::blitFramebuffer( _resolve_fbo.get(), _render_fbo.get() );
+
+  if( _readbacks.empty() )
+    return;
+
+  // The slot taken was issued ReadbackSlots views ago; its copy is most likely done
+  auto& slot = *_readbacks[_next_readback];
+  _next_readback = (_next_readback + 1) % _readbacks.size();
+  finish(slot);
+
+  const auto& size  = options.size;
+  const int   bytes = size.width() * size.height() * 4;
+  if( !slot.pbo.isCreated() ) {
+
+    slot.pbo.create();
+    slot.pbo.setUsagePattern(QOpenGLBuffer::StreamRead);
+  }
+
+  auto source = _resolve_fbo ? _resolve_fbo.get() : _render_fbo.get();
+  auto gl     = QOpenGLContext::currentContext()->functions();
+
+  source->bind();
+  slot.pbo.bind();
+  if( slot.pbo.size() != bytes )
+    slot.pbo.allocate(bytes);
+  gl->glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+  gl->glReadPixels( 0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr );
+  slot.pbo.release();
+  source->release();
+
+  slot.size    = size;
+  slot.path    = QString("%1/%2_%3.png").arg(options.output).arg(name).arg(frame,4,10,QChar('0'));
+  slot.pending = true;
+}
+
+void HeadlessRenderer::finish( Readback& slot ) {
+
+  if( !slot.pending )
+    return;
+
+  slot.pending = false;
+  slot.pbo.bind();
+  const auto data = static_cast<const uchar*>( slot.pbo.map(QOpenGLBuffer::ReadOnly) );
+  if( data ) {
+
+    // GL rows are bottom up; mirrored() copies out of the mapped buffer
+    const QImage image( data, slot.size.width(), slot.size.height(), QImage::Format_RGBA8888 );
+    write( image.mirrored(), slot.path );
+    slot.pbo.unmap();
+  }
+  else {
+
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    ++_failed;
+    std::cerr << "Headless: read back of '" << slot.path.toStdString() << "' failed" << std::endl;
+  }
+  slot.pbo.release();
+}
+
+// Blocks while every writer is busy and as many images wait, to bound the memory held
+void HeadlessRenderer::write( QImage image, const QString& path ) {
+
+  std::unique_lock<std::mutex> lock(_write_mutex);
+  _write_room.wait( lock, [this]() { return _write_queue.size() < 2 * _writers.size(); } );
+  _write_queue.emplace_back( std::move(image), path );
+  _write_wake.notify_one();
+}
+
+void HeadlessRenderer::writeLoop() {
+
+  std::unique_lock<std::mutex> lock(_write_mutex);
+  for(;;) {
+
+    _write_wake.wait( lock, [this]() { return _stop || !_write_queue.empty(); } );
+    if( _write_queue.empty() )
+      return;
+
+    auto job = std::move(_write_queue.front());
+    _write_queue.pop_front();
+    _write_room.notify_one();
+
+    lock.unlock();
+    const bool ok = job.first.save(job.second, "PNG");
+    lock.lock();
+
+    if( ok )
+      ++_written;
+    else {
+
+      ++_failed;
+      std::cerr << "Headless: image '" << job.second.toStdString() << "' could not be written" << std::endl;
+    }
+  }
+}
+
+// Writes every queued image first
+void HeadlessRenderer::stopWriters() {
+
+  {
+    std::lock_guard<std::mutex> lock(_write_mutex);
+    _stop = true;
+  }
+  _write_wake.notify_all();
+
+  for( auto& writer : _writers )
+    writer.join();
+  _writers.clear();
+}
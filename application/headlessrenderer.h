@@ -0,0 +1,91 @@
+#ifndef HEADLESSRENDERER_H
+#define HEADLESSRENDERER_H
+
+class Scenario;
+
+// qt
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+class QOpenGLFramebufferObject;
+
+// stl
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/*!
+ *  HeadlessRenderer
+ *
+ *  - Runs the Scenario without a window: an offscreen surface and context, the scenario
+ *    setup, then every RenderCamPair rendered frames times into an FBO as fast as the
+ *    GPU goes, without the 16 ms timer or the QML scene graph.
+ *  - The staged load and pending replots are settled before the first frame, so the
+ *    images show the fully sampled scene.
+ *  - Pixels are read back into a ring of ReadbackSlots pixel pack buffers. A buffer is
+ *    mapped only once the views after it have been issued, so the GPU is not waited on.
+ *    The images are flipped and written as png on worker threads.
+ *  - Needs a platform plugin with OpenGL, e.g. xcb with a display or eglfs on a server.
+ */
+class HeadlessRenderer {
+public:
+  static constexpr int            ReadbackSlots = 3;
+
+  struct Options {
+    int                           frames   {1};
+    QSize                         size     {512,512};
+    int                           samples  {4};
+    QString                       output;           // Directory of <rcpair>_<frame>.png; empty: no readback
+    QString                       trace;            // Chrome trace of the run; empty: none
+    double                        timeout  {60.0};  // s; settling the load and replots gives up after it
+  };
+
+  //   --frames <n> --size <w>x<h> --samples <n> --output <dir> --trace <file> --timeout <s>
+  static Options                  parseArguments( const QStringList& args );
+
+  explicit HeadlessRenderer( Scenario& scenario );
+  ~HeadlessRenderer();
+
+  HeadlessRenderer( const HeadlessRenderer& ) = delete;
+  HeadlessRenderer& operator = ( const HeadlessRenderer& ) = delete;
+
+  // Exit code: 0, or 1 if an image could not be written
+  int                             run( const Options& options );
+
+private:
+  struct Readback;
+
+  void                            settle( double timeout );
+  void                            renderView( const QString& name, int frame, const Options& options );
+  void                            finish( Readback& slot );
+
+  // Image writer threads
+  void                            write( QImage image, const QString& path );
+  void                            writeLoop();
+  void                            stopWriters();
+
+  Scenario&                       _scenario;
+
+  std::unique_ptr<QOpenGLFramebufferObject>   _render_fbo;
+  std::unique_ptr<QOpenGLFramebufferObject>   _resolve_fbo;   // Multisampled FBOs are resolved into it
+  std::vector<std::unique_ptr<Readback>>      _readbacks;
+  size_t                                      _next_readback {0};
+
+  std::mutex                                  _write_mutex;
+  std::condition_variable                     _write_wake;
+  std::condition_variable                     _write_room;
+  std::deque<std::pair<QImage,QString>>       _write_queue;
+  std::vector<std::thread>                    _writers;
+  size_t                                      _written  {0};
+  size_t                                      _failed   {0};
+  bool                                        _stop     {false};
+};
+
+
+#endif // HEADLESSRENDERER_H
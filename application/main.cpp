@@ -1,5 +1,8 @@
 // local
 #include "guiapplication.h"
+#include "controlnetfile.h"
+#include "headlessrenderer.h"
+#include "../scenario.h"
 
 // gmlib
 #include <core/gmglobal.h>
@@ -8,6 +11,7 @@
 #include <QDebug>
 
 // stl
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
@@ -40,6 +44,36 @@ int main(int argc, char *argv[]) try {
   else
     qDebug() << QString( "GMlib version: %1" ).arg( GM_VERSION_STR ).toStdString().c_str();
 
+  // Control net conversion; no window is opened:
+  //   --convert-control-net <text file> <binary file> [--single-precision]
+  for( int i = 1; i < argc; ++i ) {
+
+    if( std::strcmp( argv[i], "--convert-control-net" ) != 0 )
+      continue;
+
+    if( i + 2 >= argc )
+      throw std::invalid_argument("[][]--convert-control-net needs a text and a binary file name!");
+
+    const bool single_precision = i + 3 < argc && std::strcmp( argv[i+3], "--single-precision" ) == 0;
+    ControlNetFile::convertText( QString::fromLocal8Bit(argv[i+1]), QString::fromLocal8Bit(argv[i+2]), single_precision );
+    return 0;
+  }
+
+  // Offscreen batch rendering of every view; no window is opened:
+  //   --headless [--frames <n>] [--size <w>x<h>] [--samples <n>] [--output <dir>] [--trace <file>] [--timeout <s>]
+  for( int i = 1; i < argc; ++i ) {
+
+    if( std::strcmp( argv[i], "--headless" ) != 0 )
+      continue;
+
+    QGuiApplication a(argc, argv);
+    const auto options = HeadlessRenderer::parseArguments( a.arguments() );
+
+    Scenario scenario;
+    HeadlessRenderer headless( scenario );
+    return headless.run( options );
+  }
+
   // Create the application object
   GuiApplication a(argc, argv);
 
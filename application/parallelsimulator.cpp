@@ -0,0 +1,136 @@
+#include "parallelsimulator.h"
+
+#include "workerpool.h"
+
+// gmlib
+#include <scene/gmscene.h>
+#include <scene/gmsceneobject.h>
+
+// stl
+#include <algorithm>
+
+
+
+ParallelSimulator::ParallelSimulator( WorkerPool& workers ) : _workers(workers) {}
+
+// Helpers posted for earlier steps still reference the simulator; they return at once
+ParallelSimulator::~ParallelSimulator() {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _done.wait( lock, [this]{ return _posted == 0; } );
+}
+
+// dt is the scene's fixed step; scaled by its time scale, as Scene::simulate() does
+void ParallelSimulator::simulate( GMlib::Scene& scene, double dt ) {
+
+  _count = 0;
+  buildTasks( scene, dt * scene.getTimeScale() );
+
+  if( !_tasks.empty() )
+    runTasks();
+
+  _last_count = _count;
+}
+
+bool ParallelSimulator::isIndependent( GMlib::SceneObject* obj ) {
+
+  return dynamic_cast<IndependentSimulation*>(obj) != nullptr;
+}
+
+// Steps an independent obj, then its independent children depth first; returns the
+// objects stepped. Objects under any other parent are left to Scene::simulate(), which
+// steps them after their parent.
+size_t ParallelSimulator::stepSubtree( GMlib::SceneObject* obj, double dt ) {
+
+  auto independent = dynamic_cast<IndependentSimulation*>(obj);
+  independent->simulateIndependent(dt);
+  independent->_stepped_in_parallel = true;
+  size_t count = 1;
+
+  auto& children = obj->getChildren();
+  for( int i = 0; i < children.getSize(); ++i )
+    if( isIndependent( children[i] ) )
+      count += stepSubtree( children[i], dt );
+
+  return count;
+}
+
+void ParallelSimulator::buildTasks( GMlib::Scene& scene, double dt ) {
+
+  _dt = dt;
+  _tasks.clear();
+  for( int i = 0; i < scene.getSize(); ++i )
+    if( isIndependent( scene[i] ) )
+      _tasks.push_back( scene[i] );
+
+  // Too few subtrees to keep every worker busy: step a root here and split it into its children
+  const size_t wanted = 4 * (_workers.threadCount() + 1);
+  while( _tasks.size() < wanted ) {
+
+    auto itr = std::max_element( _tasks.begin(), _tasks.end(),
+                                 []( GMlib::SceneObject* a, GMlib::SceneObject* b ) {
+                                   return a->getChildren().getSize() < b->getChildren().getSize(); } );
+    if( itr == _tasks.end() || (*itr)->getChildren().getSize() == 0 )
+      break;
+
+    auto obj = *itr;
+    _tasks.erase(itr);
+
+    auto independent = dynamic_cast<IndependentSimulation*>(obj);
+    independent->simulateIndependent(dt);
+    independent->_stepped_in_parallel = true;
+    ++_count;
+
+    auto& children = obj->getChildren();
+    for( int i = 0; i < children.getSize(); ++i )
+      if( isIndependent( children[i] ) )
+        _tasks.push_back( children[i] );
+  }
+}
+
+void ParallelSimulator::runTasks() {
+
+  // Helpers still waiting from an earlier step count against the pool's threads
+  const size_t wanted  = std::min( _tasks.size(), _workers.threadCount() );
+  size_t       helpers = 0;
+  _next_task = 0;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _open    = true;
+    helpers  = _posted < wanted ? wanted - _posted : 0;
+    _posted += helpers;
+  }
+  for( size_t i = 0; i < helpers; ++i )
+    _workers.post( [this]{ helper(); } );
+
+  // The calling thread works too
+  for( size_t i = _next_task++; i < _tasks.size(); i = _next_task++ )
+    _count += stepSubtree( _tasks[i], _dt );
+
+  // Barrier; helpers not started by now do not touch the tasks
+  std::unique_lock<std::mutex> lock(_mutex);
+  _open = false;
+  _done.wait( lock, [this]{ return _active == 0; } );
+}
+
+// One WorkerPool task
+void ParallelSimulator::helper() {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  if( _open ) {
+
+    ++_active;
+    lock.unlock();
+
+    size_t count = 0;
+    for( size_t i = _next_task++; i < _tasks.size(); i = _next_task++ )
+      count += stepSubtree( _tasks[i], _dt );
+    _count += count;
+
+    lock.lock();
+    --_active;
+  }
+
+  --_posted;
+  _done.notify_all();
+}
@@ -0,0 +1,101 @@
+#ifndef PARALLELSIMULATOR_H
+#define PARALLELSIMULATOR_H
+
+namespace GMlib {
+
+  class Scene;
+  class SceneObject;
+}
+
+class WorkerPool;
+
+// stl
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+
+/*!
+ *  IndependentSimulation
+ *
+ *  - Opt-in for scene objects whose localSimulate() only touches the object itself,
+ *    so that siblings (and their subtrees) may be simulated concurrently.
+ *  - The object moves its localSimulate() body to simulateIndependent() and forwards
+ *    from localSimulate() through localSimulateFallback(dt). That runs the body only
+ *    when the parallel pass did not already step the object this frame.
+ */
+class IndependentSimulation {
+public:
+  virtual ~IndependentSimulation() = default;
+
+  virtual void                    simulateIndependent( double dt ) = 0;
+
+protected:
+  void                            localSimulateFallback( double dt ) {
+
+    if( !_stepped_in_parallel.exchange(false) )
+      simulateIndependent(dt);
+  }
+
+private:
+  friend class ParallelSimulator;
+  std::atomic<bool>               _stepped_in_parallel {false};
+};
+
+
+/*!
+ *  ParallelSimulator
+ *
+ *  - Parallel pass over the IndependentSimulation objects of a scene, run before the
+ *    serial Scene::simulate(), which then only steps the remaining objects.
+ *  - Independent root subtrees are the tasks, and a task only descends through
+ *    independent objects. Children of any other object, independent or not, are left
+ *    to Scene::simulate(), which steps them after their parent.
+ *  - While there are too few tasks for the workers, the largest is split by stepping
+ *    its root here, and its independent children become tasks. Parents are therefore
+ *    always stepped before their children.
+ *  - dt is the fixed step Scene::simulate() takes next, see Scene::setFixedDt(); both
+ *    scale it by the time scale of the scene.
+ *  - The calling thread and helpers posted to the shared WorkerPool pull tasks from a
+ *    shared counter. simulate() returns only when every task is done, which is the
+ *    barrier before Scene::prepare(). Helpers that start only after the calling thread
+ *    ran out of tasks return at once, so a pool busy with loads or replots does not
+ *    hold up the step.
+ */
+class ParallelSimulator {
+public:
+  explicit ParallelSimulator( WorkerPool& workers );
+  ~ParallelSimulator();
+
+  ParallelSimulator( const ParallelSimulator& ) = delete;
+  ParallelSimulator& operator = ( const ParallelSimulator& ) = delete;
+
+  void                            simulate( GMlib::Scene& scene, double dt );
+
+  size_t                          getLastObjectCount() const { return _last_count; }
+
+private:
+  void                            buildTasks( GMlib::Scene& scene, double dt );
+  void                            runTasks();
+  void                            helper();
+  static bool                     isIndependent( GMlib::SceneObject* obj );
+  static size_t                   stepSubtree( GMlib::SceneObject* obj, double dt );
+
+  WorkerPool&                     _workers;
+  std::vector<GMlib::SceneObject*> _tasks;
+  double                          _dt {0.0};
+
+  std::mutex                      _mutex;
+  std::condition_variable         _done;
+  size_t                          _posted {0};     // Helpers on the WorkerPool not yet done
+  size_t                          _active {0};     // Helpers working on the current tasks
+  bool                            _open {false};   // Helpers may join the current tasks
+
+  std::atomic<size_t>             _next_task {0};
+  std::atomic<size_t>             _count {0};
+  size_t                          _last_count {0};
+};
+
+
+#endif // PARALLELSIMULATOR_H
@@ -0,0 +1,163 @@
+#include "pickingcache.h"
+
+// gmlib
+#include <scene/gmscene.h>
+#include <scene/gmsceneobject.h>
+#include <scene/camera/gmcamera.h>
+#include <scene/render/gmdefaultselectrenderer.h>
+
+
+namespace {
+
+  // FNV-1a over the raw bits; only equality matters
+  void hashBytes( std::uint64_t& h, const void* data, size_t n ) {
+
+    auto bytes = static_cast<const unsigned char*>(data);
+    for( size_t i = 0; i < n; ++i ) {
+      h ^= bytes[i];
+      h *= 1099511628211ull;
+    }
+  }
+
+  template <typename T>
+  void hashValue( std::uint64_t& h, const T& value ) { hashBytes( h, &value, sizeof(T) ); }
+
+  void hashVector( std::uint64_t& h, const GMlib::Point<float,3>& v ) {
+
+    for( int i = 0; i < 3; ++i )
+      hashValue( h, v(i) );
+  }
+
+  void hashSubtree( std::uint64_t& h, GMlib::SceneObject* obj ) {
+
+    hashValue( h, obj );
+    hashValue( h, obj->isVisible() );
+    if( !obj->isVisible() )
+      return;
+
+    const auto& sphere = obj->getSurroundingSphereClean();
+    hashVector( h, sphere.getPos() );
+    hashValue( h, sphere.getRadius() );
+    hashVector( h, obj->getPos() );
+    hashVector( h, obj->getDir() );
+    hashVector( h, obj->getUp() );
+
+    auto& children = obj->getChildren();
+    hashValue( h, children.getSize() );
+    for( int i = 0; i < children.getSize(); ++i )
+      hashSubtree( h, children[i] );
+  }
+}
+
+
+
+PickingCache::PickingCache() {
+
+  _selectors.type =  GMlib::GM_SO_TYPE_SELECTOR;
+  _others.type    = -GMlib::GM_SO_TYPE_SELECTOR;
+}
+
+PickingCache::~PickingCache() = default;
+
+void PickingCache::initialize() {
+
+  _selectors.renderer = std::make_shared<GMlib::DefaultSelectRenderer>();
+  _others.renderer    = std::make_shared<GMlib::DefaultSelectRenderer>();
+  reset();
+}
+
+void PickingCache::cleanUp() {
+
+  releaseCamera();
+  _selectors.renderer.reset();
+  _others.renderer.reset();
+  reset();
+}
+
+// Render thread
+void PickingCache::reset() {
+
+  _valid = false;
+  _selectors.rendered = false;
+  _others.rendered    = false;
+  _hits.clear();
+}
+
+GMlib::SceneObject* PickingCache::find( GMlib::Scene& scene, GMlib::Camera* camera,
+                                        const GMlib::Vector<int,2>& size, const GMlib::Point<int,2>& pos ) {
+
+  const auto key = viewKey( scene, camera, size );
+  if( _dirty.exchange(false) || !_valid || key != _key || camera != _camera ) {
+
+    reset();
+    releaseCamera();
+
+    _camera = camera;
+    _size   = size;
+    _key    = key;
+    _valid  = true;
+    _selectors.renderer->setCamera(camera);
+    _others.renderer->setCamera(camera);
+  }
+
+  // Repeated pixel
+  const auto pixel = (std::uint64_t(std::uint32_t(pos(1))) << 32) | std::uint32_t(pos(0));
+  auto itr = _hits.find(pixel);
+  if( itr != _hits.end() )
+    return itr->second;
+
+  // Selectors first, then the other objects
+  auto sel_obj = findInPass( _selectors, pos );
+  if( !sel_obj )
+    sel_obj = findInPass( _others, pos );
+
+  if( _hits.size() > 4096 )
+    _hits.clear();
+  _hits.emplace( pixel, sel_obj );
+
+  return sel_obj;
+}
+
+GMlib::SceneObject* PickingCache::findInPass( Pass& pass, const GMlib::Point<int,2>& pos ) {
+
+  if( !pass.rendered ) {
+
+    pass.renderer->reshape( _size );
+    pass.renderer->prepare();
+    pass.renderer->select( pass.type );
+    pass.rendered = true;
+    ++_renders;
+  }
+
+  return pass.renderer->findObject( pos(0), pos(1) );
+}
+
+void PickingCache::releaseCamera() {
+
+  if( !_camera )
+    return;
+
+  if( _selectors.renderer ) _selectors.renderer->releaseCamera();
+  if( _others.renderer )    _others.renderer->releaseCamera();
+  _camera = nullptr;
+}
+
+std::uint64_t PickingCache::viewKey( GMlib::Scene& scene, const GMlib::Camera* camera,
+                                     const GMlib::Vector<int,2>& size ) {
+
+  std::uint64_t h = 14695981039346656037ull;
+
+  hashValue( h, size(0) );
+  hashValue( h, size(1) );
+
+  hashValue( h, camera );
+  hashVector( h, camera->getPos() );
+  hashVector( h, camera->getDir() );
+  hashVector( h, camera->getUp() );
+
+  hashValue( h, scene.getSize() );
+  for( int i = 0; i < scene.getSize(); ++i )
+    hashSubtree( h, scene[i] );
+
+  return h;
+}
@@ -0,0 +1,78 @@
+#ifndef PICKINGCACHE_H
+#define PICKINGCACHE_H
+
+// gmlib
+#include <core/types/gmpoint.h>
+
+namespace GMlib {
+
+  class Scene;
+  class SceneObject;
+  class Camera;
+  class DefaultSelectRenderer;
+}
+
+// stl
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+
+/*!
+ *  PickingCache
+ *
+ *  - Keeps the select-ID buffers of GMlibWrapper::findSceneObject alive between queries.
+ *    Selectors and the other objects get a DefaultSelectRenderer each, so after one
+ *    render of each pass any pixel is answered by the readback alone, and repeated
+ *    pixels are answered from a memo without touching GL.
+ *  - The buffers are re-rendered only when the view key changes: camera, viewport size
+ *    and a signature of the scene tree (visibility, local frames and bounding spheres).
+ *    Changes the signature can not see, e.g. an IsoCamera zoom, call invalidate(). It
+ *    only raises an atomic flag, safe from any thread; the next find() on the render
+ *    thread clears the passes and the memo.
+ *  - A pass is rendered lazily; the non-selector pass only on the first selector miss.
+ */
+class PickingCache {
+public:
+  PickingCache();
+  ~PickingCache();
+
+  void                                  initialize();
+  void                                  cleanUp();
+
+  GMlib::SceneObject*                   find( GMlib::Scene& scene, GMlib::Camera* camera,
+                                              const GMlib::Vector<int,2>& size, const GMlib::Point<int,2>& pos );
+  void                                  invalidate() { _dirty = true; }
+
+  size_t                                getRenderCount() const { return _renders; }
+
+private:
+  struct Pass {
+    std::shared_ptr<GMlib::DefaultSelectRenderer>   renderer;
+    int                                             type {0};
+    bool                                            rendered {false};
+  };
+
+  GMlib::SceneObject*                   findInPass( Pass& pass, const GMlib::Point<int,2>& pos );
+  void                                  releaseCamera();
+  void                                  reset();
+
+  static std::uint64_t                  viewKey( GMlib::Scene& scene, const GMlib::Camera* camera,
+                                                 const GMlib::Vector<int,2>& size );
+
+  Pass                                  _selectors;
+  Pass                                  _others;
+
+  GMlib::Camera*                        _camera {nullptr};
+  GMlib::Vector<int,2>                  _size;
+  std::uint64_t                         _key {0};
+  bool                                  _valid {false};
+  std::atomic<bool>                     _dirty {true};
+
+  std::unordered_map<std::uint64_t, GMlib::SceneObject*> _hits;
+  size_t                                _renders {0};
+};
+
+
+#endif // PICKINGCACHE_H
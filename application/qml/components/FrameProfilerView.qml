@@ -0,0 +1,88 @@
+import QtQuick 2.2
+import QtQuick.Controls 1.1
+import QtQuick.Layouts 1.1
+
+Rectangle {
+  id: root
+
+  // Frame time at the top of the graph
+  property real graph_ms: 33.3
+
+  opacity: 0.7
+  border.color: "black"
+  border.width: 5
+  radius: 10
+
+  implicitHeight: col.implicitHeight + 20
+
+  // Statistics are only gathered while the overlay is shown
+  Binding {
+    target: frame_profiler
+    property: "active"
+    value: root.visible
+  }
+
+  ColumnLayout {
+    id: col
+    anchors.fill: parent
+    anchors.margins: 10
+    spacing: 2
+
+    Text {
+      text: "Frame: " + frame_profiler.frameMs.toFixed(2) + " ms, max " + frame_profiler.frameMaxMs.toFixed(2)
+            + " ms (" + (frame_profiler.frameMs > 0 ? (1000 / frame_profiler.frameMs).toFixed(0) : "-") + " fps)"
+      font.bold: true
+    }
+
+    // Recent frame times, oldest first
+    Item {
+      Layout.fillWidth: true
+      height: 40
+
+      Row {
+        anchors.bottom: parent.bottom
+        spacing: 1
+
+        Repeater {
+          model: frame_profiler.frameTimes
+          Rectangle {
+            width: 3
+            height: Math.min(40, 40 * modelData / root.graph_ms)
+            anchors.bottom: parent.bottom
+            color: modelData > root.graph_ms / 2 ? "red" : "green"
+          }
+        }
+      }
+    }
+
+    Repeater {
+      model: frame_profiler.scopes
+      RowLayout {
+        Layout.fillWidth: true
+        Text { text: (modelData.gpu ? "GPU " : "") + modelData.name; Layout.fillWidth: true; elide: Text.ElideRight }
+        Text { text: modelData.mean.toFixed(2); font.bold: true; horizontalAlignment: Text.AlignRight; Layout.preferredWidth: 50 }
+        Text { text: modelData.max.toFixed(2); color: "gray"; horizontalAlignment: Text.AlignRight; Layout.preferredWidth: 50 }
+      }
+    }
+
+    RowLayout {
+      Layout.fillWidth: true
+
+      CheckBox {
+        text: "Enabled"
+        checked: frame_profiler.enabled
+        onClicked: frame_profiler.enabled = checked
+      }
+
+      Item { Layout.fillWidth: true }
+
+      Text { id: export_status; color: "gray" }
+
+      Button {
+        text: "Export trace"
+        onClicked: export_status.text = frame_profiler.writeChromeTrace("frame_trace.json")
+                                        ? "frame_trace.json" : "Export failed"
+      }
+    }
+  }
+}
@@ -10,8 +10,15 @@ Item {
   id: root
 
   signal toggleHidBindView
+  signal toggleFrameProfilerView
+  signal loadProgress(int loaded, int total)
 
   onToggleHidBindView: hid_bind_view.toggle()
+  onToggleFrameProfilerView: frame_profiler_view.visible = !frame_profiler_view.visible
+  onLoadProgress: {
+    load_progress.maximumValue = total
+    load_progress.value = loaded
+  }
 
   Renderer {
     id: renderer
@@ -35,6 +42,7 @@ Item {
     }
 
     Button {
+      id: hid_bind_button
       text: "?"
       anchors.top: parent.top
       anchors.right: parent.right
@@ -46,6 +54,42 @@ Item {
       onClicked: hid_bind_view.toggle()
     }
 
+    Button {
+      text: "ms"
+      anchors.top: parent.top
+      anchors.right: hid_bind_button.left
+      anchors.margins: 5
+
+      opacity: 0.7
+
+      onClicked: frame_profiler_view.visible = !frame_profiler_view.visible
+    }
+
+    FrameProfilerView {
+      id: frame_profiler_view
+      anchors.top: hid_bind_button.bottom
+      anchors.right: parent.right
+      anchors.margins: 5
+
+      width: 360
+      visible: false
+    }
+
+    ProgressBar {
+      id: load_progress
+      anchors.bottom: parent.bottom
+      anchors.horizontalCenter: parent.horizontalCenter
+      anchors.margins: 5
+
+      width: 256
+      opacity: 0.7
+
+      minimumValue: 0
+      maximumValue: 1
+      value: 0
+      visible: value < maximumValue
+    }
+
     HidBindingView {
       id: hid_bind_view
       anchors.fill: parent
@@ -0,0 +1,277 @@
+#include "replotscheduler.h"
+
+#include "gpucurvevisualizer.h"
+#include "../work/asyncsampling.h"
+#include "../work/gpuevaluation.h"
+
+// gmlib
+#include <scene/gmscene.h>
+#include <scene/gmsceneobject.h>
+#include <scene/camera/gmcamera.h>
+#include <parametrics/curves/gmperbscurve.h>
+#include <parametrics/surfaces/gmperbssurf.h>
+
+// stl
+#include <algorithm>
+#include <chrono>
+
+
+
+ReplotScheduler::ReplotScheduler( WorkerPool& workers ) : _pool(workers) {}
+
+/*!
+ *  requestReplot(obj)
+ *
+ *  - The object was edited: replot it at its own resolution. Repeated requests before
+ *    the job has run merge into one; a request for a job in flight restarts it coarse.
+ */
+void ReplotScheduler::requestReplot( GMlib::SceneObject* obj ) {
+
+  _parked.erase(obj);
+  auto& job = _jobs[obj];
+  job.factor = 0;
+  job.stage  = Stage::Coarse;
+  job.dirty  = true;
+
+  auto async = dynamic_cast<AsyncReplottable*>(obj);
+  job.async  = (async && async->asyncReplotEnabled()) ? async : nullptr;
+}
+
+/*!
+ *  requestResample(obj, factor)
+ *
+ *  - Quick replot at the given resolution factor (see resample()); runs at factor 1
+ *    first when a finer factor is asked for.
+ *  - Adaptively sampled curves keep to their tolerance, factor does not apply to them;
+ *    they get a normal replot job, prepared on the worker pool.
+ */
+void ReplotScheduler::requestResample( GMlib::SceneObject* obj, int factor ) {
+
+  auto async = dynamic_cast<AsyncReplottable*>(obj);
+  if( async && async->adaptiveSampling() ) {
+    requestReplot(obj);
+    return;
+  }
+
+  _parked.erase(obj);
+  auto& job = _jobs[obj];
+  job.factor = std::max(1, factor);
+  job.stage  = job.factor > 1 ? Stage::Coarse : Stage::Fine;
+  job.dirty  = true;
+  job.async  = nullptr;
+}
+
+void ReplotScheduler::runFrame( GMlib::Scene& scene, const std::vector<GMlib::Camera*>& cameras ) {
+
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  auto elapsed_ms = [start]() {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  };
+
+  // Coalesce this frame's edits into the pending jobs
+  GMlib::Array<const GMlib::SceneObject*> e_obj;
+  scene.getEditedObjects(e_obj);
+  for( int i = 0; i < e_obj.getSize(); i++ )
+    if( e_obj(i)->isVisible() )
+      requestReplot( const_cast<GMlib::SceneObject*>(e_obj(i)) );
+
+  // Uploads of finished worker results are cheap and always done
+  commitFinished();
+  parkHidden();
+
+  // Visible objects in order of on-screen importance
+  std::vector<std::pair<double, GMlib::SceneObject*>> order;
+  order.reserve(_jobs.size());
+  for( const auto& job : _jobs )
+    if( !job.second.in_flight )
+      order.emplace_back( priority(job.first, cameras), job.first );
+  std::sort( order.begin(), order.end(),
+             []( const std::pair<double, GMlib::SceneObject*>& a, const std::pair<double, GMlib::SceneObject*>& b ) {
+               return a.first > b.first; } );
+
+  // Work through them until the budget is spent; at least one synchronous job per frame
+  bool progressed = false;
+  for( const auto& entry : order ) {
+
+    auto obj = entry.second;
+    auto& job = _jobs[obj];
+
+    // Curves with a GPU visualizer are evaluated by a compute shader; nothing is sampled
+    // here, and the surrounding sphere is taken from the control polygon
+    if( job.factor == 0 ) {
+
+      auto gpu = GpuCurveVisualizer::find(obj);
+      if( gpu && gpu->evaluate(obj) ) {
+        dynamic_cast<GpuEvaluableCurve*>(obj)->gpuEvaluated();
+        replotted(obj);
+        _jobs.erase(obj);
+        continue;
+      }
+    }
+
+    // Handing work to the pool costs nothing on this thread
+    if( job.async ) {
+
+      _pool.submit( job.async, job.stage == Stage::Coarse ? _coarsening : 0 );
+      _async_objects[job.async] = obj;
+      job.in_flight = true;
+      job.dirty     = false;
+      continue;
+    }
+
+    if( progressed && elapsed_ms() >= _budget_ms )
+      continue;
+    progressed = true;
+
+    if( job.factor > 0 )
+      resample( obj, job.stage == Stage::Coarse ? 1 : job.factor );
+    else
+      obj->replot();
+    replotted(obj);
+
+    if( job.stage == Stage::Coarse && job.factor > 1 ) {
+      job.stage = Stage::Fine;
+      job.dirty = false;
+    }
+    else
+      _jobs.erase(obj);
+  }
+}
+
+// Commit the worker results and advance their jobs: dirty ones start over, coarse
+// ones are queued again for the full resolution pass, fine ones are done
+void ReplotScheduler::commitFinished() {
+
+  for( auto async : _pool.takeFinished() ) {
+
+    auto owner = _async_objects.find(async);
+    if( owner == _async_objects.end() )
+      continue;
+    auto obj = owner->second;
+    _async_objects.erase(owner);
+
+    async->commitReplot();
+    replotted(obj);
+
+    auto itr = _jobs.find(obj);
+    if( itr == _jobs.end() )
+      continue;
+
+    auto& job = itr->second;
+    job.in_flight = false;
+    if( job.dirty )
+      job.stage = Stage::Coarse;
+    else if( job.stage == Stage::Coarse && _coarsening > 0 )
+      job.stage = Stage::Fine;
+    else
+      _jobs.erase(itr);
+  }
+}
+
+// Jobs of hidden objects wait in _parked, so they do not keep frames coming; they are
+// queued again, as they were, on the first frame the object is visible again
+void ReplotScheduler::parkHidden() {
+
+  for( auto itr = _parked.begin(); itr != _parked.end(); ) {
+
+    if( itr->first->isVisible() ) {
+      _jobs[itr->first] = itr->second;
+      itr = _parked.erase(itr);
+    }
+    else
+      ++itr;
+  }
+
+  for( auto itr = _jobs.begin(); itr != _jobs.end(); ) {
+
+    if( !itr->second.in_flight && !itr->first->isVisible() ) {
+      _parked[itr->first] = itr->second;
+      itr = _jobs.erase(itr);
+    }
+    else
+      ++itr;
+  }
+}
+
+// Projected size of the surrounding sphere in the camera that sees it largest:
+// (0, 1] in front of a camera, -1 behind all of them, 0 without a valid sphere
+double ReplotScheduler::priority( GMlib::SceneObject* obj, const std::vector<GMlib::Camera*>& cameras ) const {
+
+  const auto& sphere = obj->getSurroundingSphereClean();
+  if( !sphere.isValid() )
+    return 0.0;
+
+  const double radius = std::max( double(sphere.getRadius()), 1e-6 );
+
+  double best = -1.0;
+  for( auto cam : cameras ) {
+
+    const double depth = double( (sphere.getPos() - cam->getPos()) * cam->getDir() );
+    if( depth + radius <= 0.0 )
+      continue;
+
+    best = std::max( best, radius / std::max(depth, radius) );
+  }
+
+  return best;
+}
+
+// Must be called before a scene object with a pending job is destroyed
+void ReplotScheduler::cancel( GMlib::SceneObject* obj ) {
+
+  for( auto itr = _async_objects.begin(); itr != _async_objects.end(); ++itr ) {
+
+    if( itr->second == obj ) {
+      _pool.cancel(itr->first);
+      _async_objects.erase(itr);
+      break;
+    }
+  }
+
+  _jobs.erase(obj);
+  _parked.erase(obj);
+}
+
+void ReplotScheduler::clear() {
+
+  _pool.waitIdle();
+  _pool.takeFinished();
+  _async_objects.clear();
+  _jobs.clear();
+  _parked.clear();
+}
+
+/*!
+ *  resample(obj, factor)
+ *
+ *  - Resamples curves and surfaces with a resolution proportional to factor; ERBS
+ *    objects are sampled per local curve/patch. Adaptively sampled curves never get
+ *    here, see requestResample().
+ */
+void ReplotScheduler::resample( GMlib::SceneObject* obj, int factor ) {
+
+  GMlib::PCurve<float,3> *curve = dynamic_cast<GMlib::PCurve<float,3>*>( obj );
+  GMlib::PSurf<float,3> *surf = dynamic_cast<GMlib::PSurf<float,3>*>( obj );
+
+  if( curve ) {
+
+    GMlib::PERBSCurve<float> *erbs = dynamic_cast<GMlib::PERBSCurve<float>*>(curve);
+    if( erbs )
+      erbs->sample( (erbs->getLocalCurves().getDim()-1)*factor + 1, 1 );
+    else
+      curve->sample( factor*factor*100, 2 );
+  }
+  else if( surf ) {
+
+    GMlib::PERBSSurf<float> *erbs = dynamic_cast<GMlib::PERBSSurf<float>*>(surf);
+    if( erbs )
+      erbs->sample(
+        (erbs->getLocalPatches().getDim1()-1)*factor + 1,
+        (erbs->getLocalPatches().getDim2()-1)*factor + 1,
+        2, 2 );
+    else {
+      surf->sample( 10*factor, 10*factor, 2, 2 );
+    }
+  }
+}
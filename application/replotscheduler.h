@@ -0,0 +1,94 @@
+#ifndef REPLOTSCHEDULER_H
+#define REPLOTSCHEDULER_H
+
+#include "replotworkerpool.h"
+
+class AsyncReplottable;
+class WorkerPool;
+
+namespace GMlib {
+
+  class Scene;
+  class SceneObject;
+  class Camera;
+}
+
+// stl
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+
+/*!
+ *  ReplotScheduler
+ *
+ *  - Collects replot requests (edited objects, quick-replot commands) and coalesces
+ *    repeated requests of one object into a single pending job.
+ *  - Once per frame, runFrame() orders the pending jobs: objects in front of a camera
+ *    come first, larger on screen before smaller. It then works through them until
+ *    the frame budget is spent. Anything left over waits for the next frame.
+ *  - Work is done coarse first and refined on following frames. AsyncReplottable
+ *    objects are prepared on the worker pool with a coarsened preview pass. Quick
+ *    replots run at the lowest factor first, then at the requested one.
+ *  - Jobs of hidden objects are parked and left out of getPendingCount(), so render on
+ *    demand can go idle. They run on the first frame the object is visible again.
+ *  - All calls are made from the GL thread.
+ */
+class ReplotScheduler {
+public:
+  explicit ReplotScheduler( WorkerPool& workers );
+
+  void                                            setFrameBudget( double ms ) { _budget_ms = ms; }
+  double                                          getFrameBudget() const { return _budget_ms; }
+
+  void                                            setCoarsening( int coarsening ) { _coarsening = coarsening; }
+  int                                             getCoarsening() const { return _coarsening; }
+
+  // Called with every object whose geometry was replaced, after the replot
+  using ReplotListener = std::function<void( GMlib::SceneObject* )>;
+  void                                            setReplotListener( ReplotListener listener ) { _listener = std::move(listener); }
+
+  void                                            requestReplot( GMlib::SceneObject* obj );
+  void                                            requestResample( GMlib::SceneObject* obj, int factor );
+
+  void                                            runFrame( GMlib::Scene& scene, const std::vector<GMlib::Camera*>& cameras );
+
+  void                                            cancel( GMlib::SceneObject* obj );
+  void                                            clear();
+
+  // Runnable and in-flight jobs; jobs of hidden objects are parked and not counted
+  size_t                                          getPendingCount() const { return _jobs.size(); }
+  size_t                                          getParkedCount() const { return _parked.size(); }
+
+private:
+  enum class Stage { Coarse, Fine };
+
+  struct Job {
+    int                                           factor    {0};   // 0 => replot at the object's own resolution
+    Stage                                         stage     {Stage::Coarse};
+    bool                                          dirty     {true};  // Requested again since the last submit
+    bool                                          in_flight {false};
+    AsyncReplottable*                             async     {nullptr};
+  };
+
+  double                                          priority( GMlib::SceneObject* obj,
+                                                            const std::vector<GMlib::Camera*>& cameras ) const;
+  void                                            commitFinished();
+  void                                            parkHidden();
+  void                                            replotted( GMlib::SceneObject* obj ) { if( _listener ) _listener(obj); }
+
+  static void                                     resample( GMlib::SceneObject* obj, int factor );
+
+  std::unordered_map<GMlib::SceneObject*, Job>    _jobs;
+  std::unordered_map<GMlib::SceneObject*, Job>    _parked;   // Objects hidden while their job waited
+  std::unordered_map<AsyncReplottable*, GMlib::SceneObject*> _async_objects;   // In-flight jobs
+
+  ReplotListener                                  _listener;
+
+  ReplotWorkerPool                                _pool;
+  double                                          _budget_ms  {4.0};
+  int                                             _coarsening {2};
+};
+
+
+#endif // REPLOTSCHEDULER_H
@@ -0,0 +1,108 @@
+#include "replotworkerpool.h"
+
+#include "workerpool.h"
+#include "../work/asyncsampling.h"
+
+// stl
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+
+
+ReplotWorkerPool::ReplotWorkerPool( WorkerPool& workers ) : _workers(workers) {}
+
+// Tasks of cancelled jobs still reference the pool; they return without running
+ReplotWorkerPool::~ReplotWorkerPool() {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _queued.clear();
+  _idle.wait( lock, [this]{ return _posted == 0; } );
+}
+
+bool ReplotWorkerPool::submit( AsyncReplottable* obj, int coarsening ) {
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if( !_in_flight.insert(obj).second )
+      return false;
+
+    _queued[obj] = coarsening;
+    ++_posted;
+  }
+  _workers.post( [this,obj]{ run(obj); } );
+
+  return true;
+}
+
+std::vector<AsyncReplottable*> ReplotWorkerPool::takeFinished() {
+
+  std::vector<AsyncReplottable*> finished;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  finished.swap(_finished);
+  for( auto* obj : finished )
+    _in_flight.erase(obj);
+
+  return finished;
+}
+
+/*!
+ *  cancel(obj)
+ *
+ *  - Drops a queued job, or waits for a running one, and forgets any finished result.
+ *    Must be called before an in-flight object is destroyed.
+ */
+void ReplotWorkerPool::cancel( AsyncReplottable* obj ) {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  if( !_in_flight.count(obj) )
+    return;
+
+  _queued.erase(obj);
+  _idle.wait( lock, [this,obj]{ return !_running.count(obj); } );
+
+  _finished.erase( std::remove( _finished.begin(), _finished.end(), obj ), _finished.end() );
+  _in_flight.erase(obj);
+  _idle.notify_all();
+}
+
+void ReplotWorkerPool::waitIdle() {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _idle.wait( lock, [this]{ return _queued.empty() && _running.empty(); } );
+}
+
+bool ReplotWorkerPool::isInFlight( AsyncReplottable* obj ) const {
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _in_flight.count(obj) > 0;
+}
+
+// One WorkerPool task; obj is only dereferenced while its job is queued
+void ReplotWorkerPool::run( AsyncReplottable* obj ) {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  auto itr = _queued.find(obj);
+  if( itr != _queued.end() ) {
+
+    const int coarsening = itr->second;
+    _queued.erase(itr);
+    _running.insert(obj);
+    lock.unlock();
+
+    try {
+      obj->prepareReplot(coarsening);
+    }
+    catch( const std::exception& e ) {
+      std::cerr << "ReplotWorkerPool: prepareReplot failed: " << e.what() << std::endl;
+    }
+
+    lock.lock();
+    _running.erase(obj);
+    _finished.push_back(obj);
+  }
+
+  --_posted;
+  _idle.notify_all();
+}
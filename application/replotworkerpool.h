@@ -0,0 +1,56 @@
+#ifndef REPLOTWORKERPOOL_H
+#define REPLOTWORKERPOOL_H
+
+class AsyncReplottable;
+class WorkerPool;
+
+// stl
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+/*!
+ *  ReplotWorkerPool
+ *
+ *  - Runs AsyncReplottable::prepareReplot() for edited scene objects on the shared
+ *    WorkerPool, one task per object; the pool's workers steal across objects.
+ *  - An object stays "in flight" from submit() until takeFinished() hands it back for
+ *    its GL-side commit, so resubmitting it meanwhile is a no-op.
+ *  - A task whose job was cancelled finds nothing queued for its object and returns.
+ */
+class ReplotWorkerPool {
+public:
+  explicit ReplotWorkerPool( WorkerPool& workers );
+  ~ReplotWorkerPool();
+
+  ReplotWorkerPool( const ReplotWorkerPool& ) = delete;
+  ReplotWorkerPool& operator = ( const ReplotWorkerPool& ) = delete;
+
+  bool                                    submit( AsyncReplottable* obj, int coarsening = 0 );
+  std::vector<AsyncReplottable*>          takeFinished();
+
+  void                                    cancel( AsyncReplottable* obj );
+  void                                    waitIdle();
+
+  bool                                    isInFlight( AsyncReplottable* obj ) const;
+
+private:
+  void                                    run( AsyncReplottable* obj );
+
+  WorkerPool&                             _workers;
+
+  mutable std::mutex                      _mutex;
+  std::condition_variable                 _idle;
+  size_t                                  _posted  {0};   // Tasks on the WorkerPool not yet done
+
+  std::unordered_map<AsyncReplottable*, int>  _queued;    // Coarsening of the job
+  std::unordered_set<AsyncReplottable*>   _in_flight;     // Queued, running or finished
+  std::unordered_set<AsyncReplottable*>   _running;
+  std::vector<AsyncReplottable*>          _finished;
+};
+
+
+#endif // REPLOTWORKERPOOL_H
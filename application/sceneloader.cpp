@@ -0,0 +1,149 @@
+#include "sceneloader.h"
+
+#include "workerpool.h"
+#include "../work/asyncsampling.h"
+
+// gmlib
+#include <scene/gmscene.h>
+#include <scene/gmsceneobject.h>
+
+// stl
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+
+
+namespace {
+
+  AsyncReplottable* asyncReplottable( GMlib::SceneObject* obj ) {
+
+    auto async = dynamic_cast<AsyncReplottable*>(obj);
+    return (async && async->asyncReplotEnabled()) ? async : nullptr;
+  }
+
+} // END anonymous namespace
+
+
+
+SceneLoader::SceneLoader( WorkerPool& workers ) : _workers(workers) {}
+
+// Tasks of cleared jobs still reference the loader; they find the queue empty and return
+SceneLoader::~SceneLoader() {
+
+  clear();
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _idle.wait( lock, [this]() { return _posted == 0; } );
+}
+
+void SceneLoader::add( Build build, Upload upload ) {
+
+  auto job = std::unique_ptr<Job>( new Job );
+  job->build  = std::move(build);
+  job->upload = std::move(upload);
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queue.push_back( std::move(job) );
+    ++_posted;
+  }
+  _workers.post( [this]() { run(); } );
+
+  ++_total;
+}
+
+size_t SceneLoader::uploadFrame( GMlib::Scene& scene ) {
+
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+
+  size_t inserted = 0;
+  while( std::chrono::duration<double, std::milli>(Clock::now() - start).count() < _budget_ms || inserted == 0 ) {
+
+    std::unique_ptr<Job> job;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if( _ready.empty() )
+        break;
+      job = std::move( _ready.front() );
+      _ready.pop_front();
+    }
+
+    ++_loaded;
+    if( !job->obj ) {
+      std::cerr << "SceneLoader: object " << _loaded << " of " << _total << " not loaded: " << job->error << std::endl;
+      continue;
+    }
+
+    if( job->upload )
+      job->upload( job->obj );
+
+    if( auto async = asyncReplottable( job->obj ) )
+      async->commitReplot();
+
+    scene.insert( job->obj );
+    ++inserted;
+  }
+
+  // Surrounding spheres of the new objects, for culling and picking
+  if( inserted )
+    scene.prepare();
+
+  return inserted;
+}
+
+void SceneLoader::clear() {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _queue.clear();
+  _idle.wait( lock, [this]() { return _running == 0; } );
+
+  for( auto& job : _ready )
+    delete job->obj;
+  _ready.clear();
+
+  _total  = 0;
+  _loaded = 0;
+}
+
+// One WorkerPool task per add(); builds the oldest queued job, if any is left
+void SceneLoader::run() {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  if( !_queue.empty() ) {
+
+    auto job = std::move( _queue.front() );
+    _queue.pop_front();
+    ++_running;
+    lock.unlock();
+
+    try {
+
+      job->obj = job->build();
+      if( !job->obj )
+        job->error = "no object built";
+      else if( auto async = asyncReplottable( job->obj ) )
+        async->prepareReplot();
+    }
+    catch( const std::exception& e ) {
+
+      delete job->obj;
+      job->obj   = nullptr;
+      job->error = e.what();
+    }
+    catch( ... ) {
+
+      delete job->obj;
+      job->obj   = nullptr;
+      job->error = "unknown exception";
+    }
+
+    lock.lock();
+    --_running;
+    _ready.push_back( std::move(job) );
+  }
+
+  --_posted;
+  _idle.notify_all();
+}
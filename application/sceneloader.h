@@ -0,0 +1,86 @@
+#ifndef SCENELOADER_H
+#define SCENELOADER_H
+
+namespace GMlib {
+
+  class Scene;
+  class SceneObject;
+}
+
+class WorkerPool;
+
+// stl
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/*!
+ *  SceneLoader
+ *
+ *  - Staged construction of a scene. add() queues one object: its build function runs
+ *    as a task on the shared WorkerPool and does the file parsing, construction and CPU-side evaluation
+ *    (no GL, no scene graph). AsyncReplottable objects with a replot sampling are also
+ *    prepared there, see asyncsampling.h.
+ *  - uploadFrame() is called once per frame on the GL thread. It takes the built objects
+ *    in the order they got ready and runs the upload function (visualizers, sampling).
+ *    It commits the prepared samples and inserts the object into the scene. It stops
+ *    once the frame budget is spent; at least one object is inserted per frame.
+ *  - A build that throws or returns no object counts as loaded; it is reported on stderr.
+ *  - Every call except the build functions is made from the GL thread.
+ */
+class SceneLoader {
+public:
+  using Build  = std::function<GMlib::SceneObject*()>;
+  using Upload = std::function<void( GMlib::SceneObject* )>;
+
+  explicit SceneLoader( WorkerPool& workers );
+  ~SceneLoader();
+
+  SceneLoader( const SceneLoader& ) = delete;
+  SceneLoader& operator = ( const SceneLoader& ) = delete;
+
+  void                                    setFrameBudget( double ms ) { _budget_ms = ms; }
+  double                                  getFrameBudget() const { return _budget_ms; }
+
+  void                                    add( Build build, Upload upload = Upload() );
+  size_t                                  uploadFrame( GMlib::Scene& scene );
+
+  // Drops queued jobs, waits for running builds and deletes objects that were not inserted
+  void                                    clear();
+
+  size_t                                  getTotal() const { return _total; }
+  size_t                                  getLoaded() const { return _loaded; }
+  bool                                    isLoading() const { return _loaded < _total; }
+
+private:
+  struct Job {
+    Build                                 build;
+    Upload                                upload;
+    GMlib::SceneObject*                   obj {nullptr};
+    std::string                           error;
+  };
+
+  void                                    run();
+
+  WorkerPool&                             _workers;
+
+  mutable std::mutex                      _mutex;
+  std::condition_variable                 _idle;
+
+  std::deque<std::unique_ptr<Job>>        _queue;
+  std::deque<std::unique_ptr<Job>>        _ready;
+  size_t                                  _running {0};
+  size_t                                  _posted  {0};     // Tasks on the WorkerPool not yet done
+
+  size_t                                  _total   {0};     // GL thread only
+  size_t                                  _loaded  {0};
+  double                                  _budget_ms {4.0};
+};
+
+
+#endif // SCENELOADER_H
@@ -0,0 +1,123 @@
+#include "simulationthread.h"
+
+// gmlib
+#include <scene/gmscene.h>
+
+// stl
+#include <algorithm>
+#include <chrono>
+
+#include <cassert>
+
+
+
+SimulationThread::SimulationThread() {}
+
+SimulationThread::~SimulationThread() {
+
+  stop();
+}
+
+void SimulationThread::setStepCallback( std::function<void()> callback ) {
+
+  assert(!isRunning());
+  _callback = std::move(callback);
+}
+
+void SimulationThread::setStepFunction( std::function<void(double)> step ) {
+
+  assert(!isRunning());
+  _step = std::move(step);
+}
+
+void SimulationThread::start( const std::shared_ptr<GMlib::Scene>& scene, double timestep ) {
+
+  if( isRunning() )
+    return;
+
+  _scene    = scene;
+  _timestep = timestep;
+  _stop     = false;
+  publish( State{} );
+
+  // Every simulate() advances the scene by exactly one timestep
+  _scene->setFixedDt(timestep);
+  _scene->enabelFixedDt();
+
+  _thread = std::thread( &SimulationThread::run, this );
+}
+
+void SimulationThread::stop() {
+
+  if( !isRunning() )
+    return;
+
+  _stop = true;
+  _thread.join();
+
+  _scene->disabelFixedDt();
+  _scene.reset();
+}
+
+SimulationThread::State SimulationThread::state() const {
+
+  std::lock_guard<std::mutex> lock(_state_mutex);
+  return _states[_front];
+}
+
+void SimulationThread::publish( const State& state ) {
+
+  const int back = 1 - _front;
+  _states[back] = state;
+
+  std::lock_guard<std::mutex> lock(_state_mutex);
+  _front = back;
+}
+
+void SimulationThread::run() {
+
+  using Clock = std::chrono::steady_clock;
+  const auto step = std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>(_timestep) );
+
+  State state;
+  auto  next = Clock::now() + step;
+
+  while( !_stop ) {
+
+    std::this_thread::sleep_until(next);
+
+    // Drain the accumulator in whole steps; a long stall is not replayed in full
+    int n_steps = 0;
+    const int max_steps = std::max( 1, _max_catch_up.load() );
+    while( Clock::now() >= next && n_steps < max_steps ) {
+
+      const auto t0 = Clock::now();
+      {
+        std::lock_guard<std::mutex> lock(_scene_mutex);
+        if( _step )
+          _step(_timestep);
+        else {
+          _scene->simulate();
+          _scene->prepare();
+        }
+      }
+      state.step_ms  = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+      state.steps   += 1;
+      state.sim_time = double(state.steps) * _timestep;
+
+      next += step;
+      ++n_steps;
+    }
+
+    const auto now = Clock::now();
+    if( now >= next ) {
+      const auto behind = (now - next) / step + 1;
+      state.dropped_steps += std::uint64_t(behind);
+      next += behind * step;
+    }
+
+    publish(state);
+    if( _callback && n_steps > 0 )
+      _callback();
+  }
+}
@@ -0,0 +1,82 @@
+#ifndef SIMULATIONTHREAD_H
+#define SIMULATIONTHREAD_H
+
+namespace GMlib {
+
+  class Scene;
+}
+
+// stl
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+/*!
+ *  SimulationThread
+ *
+ *  - Runs Scene::simulate() and Scene::prepare() on a dedicated thread with a fixed
+ *    timestep: wall time goes into an accumulator that is drained in whole steps
+ *    (at most getMaxCatchUp() per wake-up; any further backlog is dropped and counted).
+ *  - Each step runs under sceneMutex(). The renderer takes the same lock around its own
+ *    scene access, so it always sees the scene between two whole steps.
+ *  - The step count and simulated time are published through a double buffer that the
+ *    render and GUI threads read without touching the scene.
+ */
+class SimulationThread {
+public:
+  struct State {
+    std::uint64_t   steps           {0};
+    double          sim_time        {0.0};   // steps * timestep [s]
+    std::uint64_t   dropped_steps   {0};
+    double          step_ms         {0.0};   // Wall time of the last step
+  };
+
+  SimulationThread();
+  ~SimulationThread();
+
+  SimulationThread( const SimulationThread& ) = delete;
+  SimulationThread& operator = ( const SimulationThread& ) = delete;
+
+  void                          start( const std::shared_ptr<GMlib::Scene>& scene, double timestep );
+  void                          stop();
+  bool                          isRunning() const { return _thread.joinable(); }
+
+  double                        getTimestep() const { return _timestep; }
+  void                          setMaxCatchUp( int steps ) { _max_catch_up = steps; }
+  int                           getMaxCatchUp() const { return _max_catch_up; }
+
+  // Called on the simulation thread after each batch of steps, outside the scene lock
+  void                          setStepCallback( std::function<void()> callback );
+
+  // One step under the scene lock; defaults to Scene::simulate() followed by prepare()
+  void                          setStepFunction( std::function<void(double)> step );
+
+  std::mutex&                   sceneMutex() { return _scene_mutex; }
+  State                         state() const;
+
+private:
+  void                          run();
+  void                          publish( const State& state );
+
+  std::shared_ptr<GMlib::Scene> _scene;
+  std::thread                   _thread;
+  std::atomic<bool>             _stop {false};
+  double                        _timestep {1.0 / 120.0};
+  std::atomic<int>              _max_catch_up {8};
+  std::function<void()>         _callback;
+  std::function<void(double)>   _step;
+
+  std::mutex                    _scene_mutex;
+
+  // Published state: written to the back slot, then made current by flipping _front
+  State                         _states[2];
+  std::atomic<int>              _front {0};
+  mutable std::mutex            _state_mutex;
+};
+
+
+#endif // SIMULATIONTHREAD_H
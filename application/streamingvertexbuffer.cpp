@@ -0,0 +1,143 @@
+#include "streamingvertexbuffer.h"
+
+// stl
+#include <algorithm>
+
+
+
+namespace {
+
+  // Segment offsets stay aligned for any attribute format
+  constexpr GLsizeiptr  Alignment = 256;
+
+  GLsizeiptr segmentSizeFor( GLsizeiptr bytes ) {
+
+    const GLsizeiptr headroom = bytes + bytes / 2;
+    return std::max( Alignment, (headroom + Alignment - 1) / Alignment * Alignment );
+  }
+
+} // END anonymous namespace
+
+
+
+StreamingVertexBuffer::~StreamingVertexBuffer() { release(); }
+
+void* StreamingVertexBuffer::beginWrite( GLsizeiptr bytes ) {
+
+  if( bytes <= 0 || !reserve( bytes ) )
+    return nullptr;
+
+  _current = (_current + 1) % Segments;
+  _written = bytes;
+  wait( _current );
+
+  if( _persistent )
+    return static_cast<char*>(_mapped) + offset();
+
+  glBindBuffer( GL_ARRAY_BUFFER, _buffer );
+  void* ptr = glMapBufferRange( GL_ARRAY_BUFFER, offset(), bytes,
+                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT );
+  glBindBuffer( GL_ARRAY_BUFFER, 0 );
+  return ptr;
+}
+
+void StreamingVertexBuffer::endWrite() {
+
+  // Coherent persistent writes are visible to the following commands as they are
+  if( _persistent )
+    return;
+
+  glBindBuffer( GL_ARRAY_BUFFER, _buffer );
+  glUnmapBuffer( GL_ARRAY_BUFFER );
+  glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+void StreamingVertexBuffer::fence() {
+
+  if( !_buffer )
+    return;
+
+  if( _fences[_current] )
+    glDeleteSync( _fences[_current] );
+  _fences[_current] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+void StreamingVertexBuffer::release() {
+
+  for( auto& sync : _fences ) {
+    if( sync ) glDeleteSync( sync );
+    sync = nullptr;
+  }
+
+  if( _buffer ) {
+    if( _persistent ) {
+      glBindBuffer( GL_ARRAY_BUFFER, _buffer );
+      glUnmapBuffer( GL_ARRAY_BUFFER );
+      glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    }
+    glDeleteBuffers( 1, &_buffer );
+  }
+
+  _buffer       = 0;
+  _segment_size = 0;
+  _written      = 0;
+  _current      = 0;
+  _persistent   = false;
+  _mapped       = nullptr;
+}
+
+// Storage for a ring of segments of at least bytes each; keeps the current one when it is large enough
+bool StreamingVertexBuffer::reserve( GLsizeiptr bytes ) {
+
+  if( _buffer && bytes <= _segment_size )
+    return true;
+
+  release();
+  ++_reallocations;
+
+  _segment_size = segmentSizeFor( bytes );
+  const GLsizeiptr total = _segment_size * Segments;
+
+  glGenBuffers( 1, &_buffer );
+  glBindBuffer( GL_ARRAY_BUFFER, _buffer );
+
+  if( GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage ) {
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage( GL_ARRAY_BUFFER, total, nullptr, flags );
+    _mapped     = glMapBufferRange( GL_ARRAY_BUFFER, 0, total, flags );
+    _persistent = _mapped != nullptr;
+  }
+
+  if( !_persistent ) {
+
+    // Mutable storage, mapped per write
+    glDeleteBuffers( 1, &_buffer );
+    glGenBuffers( 1, &_buffer );
+    glBindBuffer( GL_ARRAY_BUFFER, _buffer );
+    glBufferData( GL_ARRAY_BUFFER, total, nullptr, GL_STREAM_DRAW );
+  }
+
+  glBindBuffer( GL_ARRAY_BUFFER, 0 );
+  return _buffer != 0;
+}
+
+// Blocks only when the GPU is still drawing from a write Segments writes old
+void StreamingVertexBuffer::wait( int segment ) {
+
+  GLsync& sync = _fences[segment];
+  if( !sync )
+    return;
+
+  GLenum status = glClientWaitSync( sync, 0, 0 );
+  if( status == GL_TIMEOUT_EXPIRED ) {
+
+    ++_waits;
+    do {
+      status = glClientWaitSync( sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000 );
+    } while( status == GL_TIMEOUT_EXPIRED );
+  }
+
+  glDeleteSync( sync );
+  sync = nullptr;
+}
@@ -0,0 +1,64 @@
+#ifndef STREAMINGVERTEXBUFFER_H
+#define STREAMINGVERTEXBUFFER_H
+
+// gmlib
+#include <opengl/gmopengl.h>
+
+
+/*!
+ *  StreamingVertexBuffer
+ *
+ *  - Vertex data that is rewritten every few frames (replots while dragging). One buffer
+ *    holds a ring of Segments equally sized segments. Each write goes to the next
+ *    segment while the GPU may still read the previous ones, so writing never waits for
+ *    draws in flight.
+ *  - With GL 4.4 / ARB_buffer_storage the buffer is mapped once, persistent and
+ *    coherent. Otherwise each write maps its segment unsynchronized. A fence placed
+ *    after the draws of a segment guards it until the ring comes round again.
+ *  - Storage only grows, with some headroom; writes of a size that fits go in place.
+ *  - GL thread only.
+ */
+class StreamingVertexBuffer {
+public:
+  static constexpr int              Segments = 3;
+
+  StreamingVertexBuffer() = default;
+  StreamingVertexBuffer( const StreamingVertexBuffer& ) = delete;
+  StreamingVertexBuffer& operator = ( const StreamingVertexBuffer& ) = delete;
+  ~StreamingVertexBuffer();
+
+  // Start writing bytes into the next segment; nullptr if no storage could be had
+  void*                             beginWrite( GLsizeiptr bytes );
+  void                              endWrite();
+
+  // Segment of the last write
+  GLuint                            buffer() const { return _buffer; }
+  GLintptr                          offset() const { return GLintptr(_current) * _segment_size; }
+  GLsizeiptr                        size() const { return _written; }
+
+  // After the draws reading the last write; the segment is reused only when they are done
+  void                              fence();
+
+  void                              release();
+
+  size_t                            getReallocationCount() const { return _reallocations; }
+  size_t                            getWaitCount() const { return _waits; }
+
+private:
+  bool                              reserve( GLsizeiptr bytes );
+  void                              wait( int segment );
+
+  GLuint                            _buffer        {0};
+  GLsizeiptr                        _segment_size  {0};
+  GLsizeiptr                        _written       {0};
+  int                               _current       {0};
+  bool                              _persistent    {false};
+  void*                             _mapped        {nullptr};  // Whole ring while persistent
+  GLsync                            _fences[Segments] {};
+
+  size_t                            _reallocations {0};
+  size_t                            _waits         {0};
+};
+
+
+#endif // STREAMINGVERTEXBUFFER_H
@@ -0,0 +1,111 @@
+#include "viewbatch.h"
+
+// gmlib
+#include <scene/gmscene.h>
+#include <scene/gmsceneobject.h>
+#include <scene/camera/gmcamera.h>
+
+// stl
+#include <algorithm>
+
+
+
+void ViewBatch::build( GMlib::Scene& scene, const std::vector<GMlib::Camera*>& cameras ) {
+
+  _tests = 0;
+  _cameras.assign( cameras.begin(), cameras.begin() + std::min( cameras.size(), size_t(MaxCameras) ) );
+
+  _lists.resize( _cameras.size() );
+  for( auto& list : _lists )
+    list.resetSize();
+
+  if( _cameras.empty() )
+    return;
+
+  const std::uint64_t all = _cameras.size() == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << _cameras.size()) - 1;
+  for( int i = 0; i < scene.getSize(); ++i )
+    visit( scene[i], all );
+}
+
+void ViewBatch::clear() {
+
+  _cameras.clear();
+  _lists.clear();
+}
+
+const ViewBatch::DrawList* ViewBatch::drawList( const GMlib::Camera* camera ) const {
+
+  auto itr = std::find( _cameras.begin(), _cameras.end(), camera );
+  if( itr == _cameras.end() )
+    return nullptr;
+
+  return &_lists[size_t(itr - _cameras.begin())];
+}
+
+// Same rules as SceneObject::culling, for all cameras still partially seeing obj at once:
+// the total sphere (obj and its children) decides the descent, the clean sphere whether obj
+// itself is drawn
+void ViewBatch::visit( GMlib::SceneObject* obj, std::uint64_t partial ) {
+
+  if( !obj->isVisible() )
+    return;
+
+  std::uint64_t inside = 0;
+  const auto&   total  = obj->getSurroundingSphere();
+  for( size_t i = 0; i < _cameras.size(); ++i ) {
+
+    const auto bit = std::uint64_t(1) << i;
+    if( !(partial & bit) )
+      continue;
+
+    ++_tests;
+    const int k = _cameras[i]->getFrustum().isInterfering(total);
+    if( k != 0 ) partial &= ~bit;
+    if( k  > 0 ) inside  |=  bit;
+  }
+
+  if( inside )
+    addSubtree( obj, inside );
+
+  if( !partial )
+    return;
+
+  std::uint64_t own   = 0;
+  const auto&   clean = obj->getSurroundingSphereClean();
+  for( size_t i = 0; i < _cameras.size(); ++i ) {
+
+    const auto bit = std::uint64_t(1) << i;
+    if( !(partial & bit) )
+      continue;
+
+    ++_tests;
+    if( _cameras[i]->getFrustum().isInterfering(clean) >= 0 )
+      own |= bit;
+  }
+
+  if( own )
+    addObject( obj, own );
+
+  auto& children = obj->getChildren();
+  for( int i = 0; i < children.getSize(); ++i )
+    visit( children[i], partial );
+}
+
+void ViewBatch::addSubtree( GMlib::SceneObject* obj, std::uint64_t cameras ) {
+
+  if( !obj->isVisible() )
+    return;
+
+  addObject( obj, cameras );
+
+  auto& children = obj->getChildren();
+  for( int i = 0; i < children.getSize(); ++i )
+    addSubtree( children[i], cameras );
+}
+
+void ViewBatch::addObject( const GMlib::SceneObject* obj, std::uint64_t cameras ) {
+
+  for( size_t i = 0; i < _cameras.size(); ++i )
+    if( cameras & (std::uint64_t(1) << i) )
+      _lists[i].insertAlways(obj);
+}
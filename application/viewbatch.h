@@ -0,0 +1,56 @@
+#ifndef VIEWBATCH_H
+#define VIEWBATCH_H
+
+// gmlib
+#include <core/containers/gmarray.h>
+
+namespace GMlib {
+
+  class Scene;
+  class SceneObject;
+  class Camera;
+}
+
+// stl
+#include <cstdint>
+#include <vector>
+
+
+/*!
+ *  ViewBatch
+ *
+ *  - Frustum culling for every RenderCamPair camera in a single traversal of the scene.
+ *    Each object's total surrounding sphere, which covers its children, is tested against
+ *    the cameras that still see it partially; a subtree fully inside a frustum is added
+ *    without further tests for that camera, and a subtree outside every frustum is
+ *    skipped. Where the subtree is cut, the object's clean sphere decides whether the
+ *    object itself is drawn, and its children are visited either way.
+ *  - The result is one draw list per camera, handed to the BatchedRenderers before the
+ *    viewports issue any GL; it is valid for the frame it was built in.
+ */
+class ViewBatch {
+public:
+  using DrawList = GMlib::Array<const GMlib::SceneObject*>;
+
+  static constexpr size_t                   MaxCameras = 64;
+
+  void                                      build( GMlib::Scene& scene, const std::vector<GMlib::Camera*>& cameras );
+  void                                      clear();
+
+  // nullptr when the camera was not part of the last build
+  const DrawList*                           drawList( const GMlib::Camera* camera ) const;
+
+  size_t                                    getLastTestCount() const { return _tests; }
+
+private:
+  void                                      visit( GMlib::SceneObject* obj, std::uint64_t partial );
+  void                                      addSubtree( GMlib::SceneObject* obj, std::uint64_t cameras );
+  void                                      addObject( const GMlib::SceneObject* obj, std::uint64_t cameras );
+
+  std::vector<const GMlib::Camera*>         _cameras;
+  std::vector<DrawList>                     _lists;
+  size_t                                    _tests {0};
+};
+
+
+#endif // VIEWBATCH_H
@@ -19,6 +19,14 @@ Window::Window(QWindow *parent) : QQuickView(parent) {
   setMinimumSize( QSize( 600, 600 ) );
   resize(1600, 1000);
 
+  const QSurfaceFormat format = surfaceFormat();
+  QSurfaceFormat::setDefaultFormat(format);
+  setFormat(format);
+
+  create();
+}
+
+QSurfaceFormat Window::surfaceFormat() {
 
   QSurfaceFormat format;
   if(QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGL) {
@@ -35,11 +43,8 @@ Window::Window(QWindow *parent) : QQuickView(parent) {
   format.setGreenBufferSize(8);
   format.setBlueBufferSize(8);
   format.setAlphaBufferSize(8);
-  format.setSamples(4);
+  format.setSamples(0);                                       // Viewports multisample their own FBOs (Renderer.samples)
   format.setStencilBufferSize(8);
 
-  QSurfaceFormat::setDefaultFormat(format);
-  setFormat(format);
-
-  create();
+  return format;
 }
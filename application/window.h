@@ -14,6 +14,9 @@ class Window : public QQuickView {
 public:
   explicit Window(QWindow *parent = nullptr);
 
+  // The GL format of the window; also used by the headless renderer's context
+  static QSurfaceFormat surfaceFormat();
+
 signals:
   void      signRcPairActiveStateChanged( const QString& name, bool state );
   void      signRcPairViewportChanged( const QString& name, const QRectF& geometry );
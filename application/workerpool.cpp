@@ -0,0 +1,158 @@
+#include "workerpool.h"
+
+// stl
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iostream>
+#include <memory>
+
+
+
+WorkerPool::WorkerPool( unsigned int threads ) {
+
+  // Leave one hardware thread to the GUI/render threads
+  if( threads == 0 )
+    threads = std::max( 2u, std::thread::hardware_concurrency() ) - 1;
+
+  _queues.resize(threads);
+  _threads.reserve(threads);
+  for( size_t i = 0; i < threads; ++i )
+    _threads.emplace_back( &WorkerPool::run, this, i );
+}
+
+WorkerPool::~WorkerPool() {
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _wake.notify_all();
+
+  for( auto& thread : _threads )
+    thread.join();
+}
+
+void WorkerPool::post( Task task ) {
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _queues[_next].push_back( std::move(task) );
+    _next = (_next + 1) % _queues.size();
+    ++_queued;
+  }
+  _wake.notify_one();
+}
+
+/*!
+ *  parallelFor(count, body)
+ *
+ *  - Posts up to threadCount() helpers. They and the calling thread take indices from a
+ *    shared counter.
+ *  - Once the caller runs out of indices it closes the batch and waits only for the
+ *    helpers that joined. A helper that starts later returns without touching body, so
+ *    a busy pool never holds up the caller.
+ *  - The first exception of a body is rethrown on the calling thread.
+ */
+void WorkerPool::parallelFor( size_t count, const std::function<void( size_t )>& body ) {
+
+  struct Batch {
+    std::mutex                            mutex;
+    std::condition_variable               done;
+    std::atomic<size_t>                   next   {0};
+    size_t                                active {0};
+    bool                                  open   {true};
+    std::exception_ptr                    error;
+  };
+
+  auto batch = std::make_shared<Batch>();
+  const auto work = [batch,count,&body]() {
+
+    try {
+      for( size_t i = batch->next++; i < count; i = batch->next++ )
+        body(i);
+    }
+    catch( ... ) {
+
+      batch->next = count;
+      std::lock_guard<std::mutex> lock(batch->mutex);
+      if( !batch->error )
+        batch->error = std::current_exception();
+    }
+  };
+
+  const size_t helpers = std::min( count > 0 ? count - 1 : 0, threadCount() );
+  for( size_t i = 0; i < helpers; ++i )
+    post( [batch,work]() {
+
+      {
+        std::lock_guard<std::mutex> lock(batch->mutex);
+        if( !batch->open )
+          return;
+        ++batch->active;
+      }
+
+      work();
+
+      std::lock_guard<std::mutex> lock(batch->mutex);
+      if( --batch->active == 0 )
+        batch->done.notify_one();
+    } );
+
+  work();
+
+  std::unique_lock<std::mutex> lock(batch->mutex);
+  batch->open = false;
+  batch->done.wait( lock, [&batch]() { return batch->active == 0; } );
+
+  if( batch->error )
+    std::rethrow_exception( batch->error );
+}
+
+// Own queue newest first, otherwise steal the oldest task of the next non-empty queue.
+// Called with _mutex held and _queued > 0.
+WorkerPool::Task WorkerPool::takeTask( size_t index ) {
+
+  auto& own = _queues[index];
+  if( !own.empty() ) {
+    auto task = std::move( own.back() );
+    own.pop_back();
+    return task;
+  }
+
+  for( size_t i = 1; i < _queues.size(); ++i ) {
+
+    auto& victim = _queues[(index + i) % _queues.size()];
+    if( !victim.empty() ) {
+      auto task = std::move( victim.front() );
+      victim.pop_front();
+      return task;
+    }
+  }
+
+  return Task();
+}
+
+void WorkerPool::run( size_t index ) {
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  while( true ) {
+
+    _wake.wait( lock, [this]{ return _stop || _queued > 0; } );
+    if( _stop )
+      return;
+
+    auto task = takeTask(index);
+    --_queued;
+    lock.unlock();
+
+    try {
+      task();
+    }
+    catch( const std::exception& e ) {
+      std::cerr << "WorkerPool: task failed: " << e.what() << std::endl;
+    }
+
+    lock.lock();
+  }
+}
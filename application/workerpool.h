@@ -0,0 +1,59 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+// stl
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/*!
+ *  WorkerPool
+ *
+ *  - The one set of worker threads of the application; GMlibWrapper owns it and hands
+ *    it to the SceneLoader, the ReplotWorkerPool and the ParallelSimulator, so loading,
+ *    replots and simulation together use the hardware threads once.
+ *  - post() queues a task round-robin; every worker has its own deque, takes its newest
+ *    task first and steals the oldest task of another worker when it runs dry.
+ *  - Tasks must not wait on other tasks. A task that throws is reported on stderr.
+ *    parallelFor() is the exception: its caller does the work itself when no worker is
+ *    free, so it may be called from inside a task.
+ *  - Tasks still queued when the pool is destroyed are dropped; the users wait for their
+ *    own tasks before they go, and are destroyed before the pool.
+ */
+class WorkerPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit WorkerPool( unsigned int threads = 0 );   // 0 => hardware threads - 1
+  ~WorkerPool();
+
+  WorkerPool( const WorkerPool& ) = delete;
+  WorkerPool& operator = ( const WorkerPool& ) = delete;
+
+  void                                    post( Task task );
+
+  // body(0) .. body(count-1) on the calling thread and free workers; returns when all are done
+  void                                    parallelFor( size_t count, const std::function<void( size_t )>& body );
+
+  size_t                                  threadCount() const { return _threads.size(); }
+
+private:
+  void                                    run( size_t index );
+  Task                                    takeTask( size_t index );
+
+  std::mutex                              _mutex;
+  std::condition_variable                 _wake;
+
+  std::vector<std::thread>                _threads;
+  std::vector<std::deque<Task>>           _queues;        // One per worker
+  size_t                                  _queued  {0};
+  size_t                                  _next    {0};   // Round-robin post target
+  bool                                    _stop    {false};
+};
+
+
+#endif // WORKERPOOL_H
@@ -0,0 +1,90 @@
+#include "benchmark.h"
+
+// stl
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+
+
+
+namespace {
+
+  volatile double value_sink = 0.0;
+
+  double seconds( std::chrono::steady_clock::duration d ) {
+
+    return std::chrono::duration<double>( d ).count();
+  }
+
+  void writeValues( std::ostream& out, const Benchmark::Values& values ) {
+
+    out << "{";
+    for( size_t i = 0; i < values.size(); ++i )
+      out << (i ? ", " : "") << "\"" << values[i].first << "\": " << values[i].second;
+    out << "}";
+  }
+
+} // END anonymous namespace
+
+
+
+void keepValue( double value ) { value_sink = value; }
+
+Benchmark::Benchmark( bool quick, std::string filter )
+  : _quick{quick}, _filter{std::move(filter)}, _round_seconds{quick ? 0.01 : 0.1}, _rounds{quick ? 3 : 5} {}
+
+bool Benchmark::isEnabled( const std::string& name ) const {
+
+  return _filter.empty() || name.find( _filter ) != std::string::npos;
+}
+
+double Benchmark::time( const std::function<void()>& body ) const {
+
+  using Clock = std::chrono::steady_clock;
+
+  // Calibrate the calls per round on a first, untimed warm-up call
+  auto start = Clock::now();
+  body();
+  const double once  = std::max( seconds( Clock::now() - start ), 1e-9 );
+  const long   calls = std::max( 1L, long( _round_seconds / once ) );
+
+  double best = std::numeric_limits<double>::max();
+  for( int r = 0; r < _rounds; ++r ) {
+
+    start = Clock::now();
+    for( long c = 0; c < calls; ++c )
+      body();
+    best = std::min( best, seconds( Clock::now() - start ) / double(calls) );
+  }
+
+  return best;
+}
+
+void Benchmark::record( const std::string& name, Values params, Values metrics ) {
+
+  std::cerr << name;
+  for( const auto& p : params )  std::cerr << " " << p.first << "=" << p.second;
+  std::cerr << ":";
+  for( const auto& m : metrics ) std::cerr << " " << m.first << "=" << m.second;
+  std::cerr << std::endl;
+
+  _records.push_back( Record{ name, std::move(params), std::move(metrics) } );
+}
+
+void Benchmark::writeJson( std::ostream& out ) const {
+
+  out << std::setprecision(9);
+  out << "{\n  \"version\": 1,\n  \"quick\": " << (_quick ? "true" : "false") << ",\n  \"results\": [";
+  for( size_t i = 0; i < _records.size(); ++i ) {
+
+    const auto& r = _records[i];
+    out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"params\": ";
+    writeValues( out, r.params );
+    out << ", \"metrics\": ";
+    writeValues( out, r.metrics );
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+}
@@ -0,0 +1,62 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+// stl
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/*!
+ *  Benchmark
+ *
+ *  - Harness of the headless QmlDemoBenchmarks target. time() runs a body in rounds of
+ *    enough calls to last at least the minimum round time and returns the best round's
+ *    seconds per call, which is the least disturbed by the rest of the machine.
+ *  - Every measurement is kept as a record: a benchmark name, the parameters it ran
+ *    with and the metrics it gave. writeJson() writes them all in one document, so
+ *    runs can be diffed and plotted against earlier ones.
+ *  - Benchmarks whose name does not contain the filter are skipped.
+ */
+class Benchmark {
+public:
+  using Values = std::vector<std::pair<std::string,double>>;
+
+  struct Record {
+    std::string                           name;
+    Values                                params;
+    Values                                metrics;
+  };
+
+  Benchmark( bool quick, std::string filter );
+
+  bool                                    isQuick() const { return _quick; }
+  bool                                    isEnabled( const std::string& name ) const;
+
+  double                                  time( const std::function<void()>& body ) const;
+
+  void                                    record( const std::string& name, Values params, Values metrics );
+  const std::vector<Record>&              getRecords() const { return _records; }
+
+  void                                    writeJson( std::ostream& out ) const;
+
+private:
+  bool                                    _quick;
+  std::string                             _filter;
+  double                                  _round_seconds;
+  int                                     _rounds;
+  std::vector<Record>                     _records;
+};
+
+
+// Keeps a computed value alive, so the work producing it is not optimised away
+void keepValue( double value );
+
+void runCurveBenchmarks( Benchmark& bench );
+void runQueryBenchmarks( Benchmark& bench );
+void runHidBenchmarks( Benchmark& bench );
+
+
+#endif // BENCHMARK_H
@@ -0,0 +1,191 @@
+#include "benchmark.h"
+
+#include "../work/closedsubdivisioncurve.h"
+#include "../work/gpuevaluation.h"
+#include "../work/mybspline.h"
+#include "../work/torusknot.h"
+
+// stl
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace {
+
+  // Control polygon on a helix; smooth, but every span different
+  GMlib::DVector<GMlib::Vector<float,3>> helix( int n ) {
+
+    GMlib::DVector<GMlib::Vector<float,3>> c(n);
+    for( int i = 0; i < n; ++i ) {
+      const float a = 0.37f * float(i);
+      c[i] = GMlib::Vector<float,3>( std::cos(a), std::sin(a), 0.05f * float(i) );
+    }
+    return c;
+  }
+
+  template <typename Curve>
+  double evaluateAll( Curve& curve, int m, int d ) {
+
+    const float start = curve.getParStart();
+    const float step  = (curve.getParEnd() - start) / float(m - 1);
+
+    double sum = 0.0;
+    for( int i = 0; i < m; ++i )
+      sum += double( curve.evaluate( start + step * float(i), d )[0][0] );
+    return sum;
+  }
+
+  // eval() and sampleBatch() throughput of one curve over m uniform samples
+  template <typename Curve>
+  void timeEvaluation( Benchmark& bench, const std::string& name, Curve& curve, int m, int d,
+                       Benchmark::Values params ) {
+
+    params.emplace_back( "derivatives", d );
+    params.emplace_back( "samples", m );
+
+    if( bench.isEnabled( name + "_eval" ) ) {
+      const double s = bench.time( [&]() { keepValue( evaluateAll( curve, m, d ) ); } );
+      bench.record( name + "_eval", params, { { "samples_per_second", m / s } } );
+    }
+
+    if( bench.isEnabled( name + "_sample_batch" ) ) {
+      CurveSamples<float,3> out;
+      const double s = bench.time( [&]() { curve.sampleBatch( out, m, d ); keepValue( out.data.back() ); } );
+      bench.record( name + "_sample_batch", params, { { "samples_per_second", m / s } } );
+    }
+  }
+
+  void bsplineEvaluation( Benchmark& bench ) {
+
+    const int m = bench.isQuick() ? 1024 : 16384;
+    const std::vector<int> counts = bench.isQuick() ? std::vector<int>{ 8, 512 } : std::vector<int>{ 8, 64, 512, 4096 };
+
+    for( int n : counts ) {
+
+      const auto c = helix(n);
+      for( int degree = 1; degree <= 5; ++degree ) {
+        MyB_spline<float,DYNAMIC_DEGREE> curve( degree, c );
+        timeEvaluation( bench, "bspline", curve, m, 1,
+                        { { "degree", degree }, { "control_points", n }, { "fixed_degree", 0 } } );
+      }
+
+      // The default curve: degree fixed at compile time
+      MyB_spline<float,2> curve( c );
+      timeEvaluation( bench, "bspline", curve, m, 1,
+                      { { "degree", 2 }, { "control_points", n }, { "fixed_degree", 1 } } );
+    }
+  }
+
+  void bsplineFit( Benchmark& bench ) {
+
+    if( !bench.isEnabled( "bspline_fit" ) )
+      return;
+
+    const std::vector<int> counts = bench.isQuick() ? std::vector<int>{ 1000, 100000 }
+                                                    : std::vector<int>{ 1000, 10000, 100000, 1000000 };
+
+    // As in the application, large fits are assembled on the shared pool
+    WorkerPool workers;
+    for( int m : counts ) {
+
+      const auto p = helix(m);
+      const int  n = std::min( 64, m / 4 );
+      const double s = bench.time( [&]() {
+        MyB_spline<float,3> fit( p, n, &workers );
+        keepValue( fit.getControlPoints()[0][0] );
+      } );
+      bench.record( "bspline_fit", { { "degree", 3 }, { "points", m }, { "control_points", n },
+                                     { "threads", double( workers.threadCount() + 1 ) } },
+                    { { "seconds", s }, { "points_per_second", m / s } } );
+    }
+  }
+
+  // Lane-Riesenfeld pyramid from the control polygon up to the level, on a fresh curve
+  void subdivision( Benchmark& bench ) {
+
+    if( !bench.isEnabled( "subdivision" ) )
+      return;
+
+    const int  n      = 16;
+    const int  levels = bench.isQuick() ? 8 : 12;
+    const auto c      = helix(n);
+    for( int level = 1; level <= levels; ++level ) {
+
+      const double s = bench.time( [&]() {
+        ClosedSubdivisionCurve<float> curve( c, levels );
+        keepValue( curve.getLevel( level )[0][0] );
+      } );
+      bench.record( "subdivision", { { "degree", levels }, { "control_points", n }, { "level", level } },
+                    { { "seconds", s }, { "points", double(n) * std::ldexp( 1.0, level ) } } );
+    }
+  }
+
+  // Largest deviation of the GPU shader's CPU port from eval() over m uniform samples,
+  // per derivative and relative to the largest value of that derivative
+  template <typename Curve>
+  void checkGpuForm( Benchmark& bench, const std::string& name, Curve& curve, int m,
+                     Benchmark::Values params ) {
+
+    GpuBSplineForm form;
+    if( !curve.gpuBSplineForm( form ) )
+      return;
+
+    const int d = 2;
+    std::vector<double> error(d + 1, 0.0), size(d + 1, 0.0);
+    std::vector<GMlib::Vector<float,3>> gpu;
+    for( int i = 0; i < m; ++i ) {
+
+      const float t = form.start + (form.end - form.start) * float(i) / float(m - 1);
+      evaluateGpuForm( form, t, d, gpu );
+      const auto& cpu = curve.evaluate( t, d );
+      for( int k = 0; k <= d; ++k ) {
+        error[k] = std::max( error[k], double( (gpu[k] - cpu[k]).getLength() ) );
+        size[k]  = std::max( size[k], double( cpu[k].getLength() ) );
+      }
+    }
+
+    params.emplace_back( "samples", m );
+    bench.record( name, params, { { "position_error",          error[0] / std::max( size[0], 1e-30 ) },
+                                  { "first_derivative_error",  error[1] / std::max( size[1], 1e-30 ) },
+                                  { "second_derivative_error", error[2] / std::max( size[2], 1e-30 ) } } );
+  }
+
+  void gpuForm( Benchmark& bench ) {
+
+    const int  m = bench.isQuick() ? 1000 : 10000;
+    const auto c = helix(64);
+
+    if( bench.isEnabled( "gpu_form_bspline" ) )
+      for( int degree = 1; degree <= 5; ++degree ) {
+        MyB_spline<float,DYNAMIC_DEGREE> curve( degree, c );
+        checkGpuForm( bench, "gpu_form_bspline", curve, m, { { "degree", degree }, { "control_points", 64 } } );
+      }
+
+    if( bench.isEnabled( "gpu_form_subdivision" ) )
+      for( int degree = 1; degree <= 5; ++degree ) {
+        ClosedSubdivisionCurve<float> curve( c, degree );
+        checkGpuForm( bench, "gpu_form_subdivision", curve, m, { { "degree", degree }, { "control_points", 64 } } );
+      }
+  }
+
+  void torusKnot( Benchmark& bench ) {
+
+    const int m = bench.isQuick() ? 1024 : 16384;
+    TorusKnot knot;
+    for( int d = 0; d <= 2; ++d )
+      timeEvaluation( bench, "torusknot", knot, m, d, {} );
+  }
+
+} // END anonymous namespace
+
+
+
+void runCurveBenchmarks( Benchmark& bench ) {
+
+  bsplineEvaluation( bench );
+  bsplineFit( bench );
+  subdivision( bench );
+  gpuForm( bench );
+  torusKnot( bench );
+}
@@ -0,0 +1,79 @@
+#include "benchmark.h"
+#include "hidbenchmarks.h"
+
+#include "../hidmanager/hidkbmouseinput.h"
+#include "../hidmanager/hidmanager.h"
+
+// qt
+#include <QCoreApplication>
+
+// stl
+#include <memory>
+#include <vector>
+
+
+
+void HidBenchmarkReceiver::heTrigger( const HidInputEvent::HidInputParams& /*params*/ ) { ++_triggers; }
+
+
+
+namespace {
+
+  const Qt::KeyboardModifier Modifiers[] = { Qt::ShiftModifier, Qt::ControlModifier, Qt::AltModifier, Qt::MetaModifier };
+  constexpr int              Keys        = 94;   // Printable Latin-1, '!' to '~'
+
+  // Binding i: one of the printable keys under one of the 16 modifier combinations.
+  // Consecutive bindings share a modifier set, and so a bucket of the dispatch index.
+  std::unique_ptr<KeyPressInput> bindingInput( int i ) {
+
+    Qt::KeyboardModifiers mods = Qt::NoModifier;
+    for( int b = 0; b < 4; ++b )
+      if( (i / Keys) & (1 << b) )
+        mods |= Modifiers[b];
+    return std::unique_ptr<KeyPressInput>( new KeyPressInput( Qt::Key( '!' + i % Keys ), mods ) );
+  }
+
+} // END anonymous namespace
+
+
+
+// customEvent() dispatch latency against the number of registered bindings; every
+// binding is hit in turn, a miss is an input of a bound modifier set with no action
+void runHidBenchmarks( Benchmark& bench ) {
+
+  if( !bench.isEnabled( "hid_dispatch" ) )
+    return;
+
+  const std::vector<int> counts = bench.isQuick() ? std::vector<int>{ 1, 64, 1024 }
+                                                  : std::vector<int>{ 1, 16, 64, 256, 1024, 1504 };
+  for( int n : counts ) {
+
+    HidManager           manager;
+    HidBenchmarkReceiver receiver;
+
+    // The manager keeps pointers to the inputs it is given
+    std::vector<std::unique_ptr<KeyPressInput>> inputs;
+    std::vector<std::unique_ptr<HidInputEvent>> hits;
+    for( int i = 0; i < n; ++i ) {
+
+      const QString id = manager.registerHidAction( "Benchmark", QString("Action %1").arg(i), QString(),
+                                                    &receiver, SLOT(heTrigger(HidInputEvent::HidInputParams)) );
+      inputs.push_back( bindingInput(i) );
+      manager.registerHidMapping( id, inputs.back().get() );
+      hits.emplace_back( new HidInputEvent( *inputs.back() ) );
+    }
+
+    size_t next = 0;
+    const double hit = bench.time( [&]() {
+      QCoreApplication::sendEvent( &manager, hits[next].get() );
+      next = (next + 1) % hits.size();
+    } );
+
+    HidInputEvent miss( KeyPressInput( Qt::Key_F35 ) );
+    const double missed = bench.time( [&]() { QCoreApplication::sendEvent( &manager, &miss ); } );
+
+    keepValue( double( receiver.getTriggerCount() ) );
+    bench.record( "hid_dispatch", { { "bindings", n } },
+                  { { "hit_ns", hit * 1e9 }, { "miss_ns", missed * 1e9 } } );
+  }
+}
@@ -0,0 +1,29 @@
+#ifndef HIDBENCHMARKS_H
+#define HIDBENCHMARKS_H
+
+#include "../hidmanager/hidinputevent.h"
+
+// qt
+#include <QObject>
+
+
+/*!
+ *  HidBenchmarkReceiver
+ *
+ *  - Slot end of the benchmark's HID actions; counts the triggers, so dispatch is timed
+ *    through the same signal connection the application uses, without any action work.
+ */
+class HidBenchmarkReceiver : public QObject {
+  Q_OBJECT
+public:
+  long long                 getTriggerCount() const { return _triggers; }
+
+public slots:
+  void                      heTrigger( const HidInputEvent::HidInputParams& params );
+
+private:
+  long long                 _triggers {0};
+};
+
+
+#endif // HIDBENCHMARKS_H
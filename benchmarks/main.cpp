@@ -0,0 +1,62 @@
+// local
+#include "benchmark.h"
+
+// qt
+#include <QCoreApplication>
+
+// stl
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+/*
+ *  Headless benchmarks of the work/ curve kernels, the curve queries and the HID dispatch:
+ *    QmlDemoBenchmarks [--quick] [--filter <name part>] [--output <json file>]
+ *  Progress goes to stderr; the JSON document to the output file, stdout otherwise.
+ */
+int main(int argc, char *argv[]) try {
+
+  // HID events are delivered through the Qt event system; no window is opened
+  QCoreApplication a(argc, argv);
+
+  bool        quick = false;
+  std::string filter;
+  std::string output;
+  for( int i = 1; i < argc; ++i ) {
+
+    if( std::strcmp( argv[i], "--quick" ) == 0 )
+      quick = true;
+    else if( std::strcmp( argv[i], "--filter" ) == 0 && i + 1 < argc )
+      filter = argv[++i];
+    else if( std::strcmp( argv[i], "--output" ) == 0 && i + 1 < argc )
+      output = argv[++i];
+    else
+      throw std::invalid_argument( std::string("[][]Unknown benchmark argument '") + argv[i] + "'!" );
+  }
+
+  Benchmark bench( quick, filter );
+  runCurveBenchmarks( bench );
+  runQueryBenchmarks( bench );
+  runHidBenchmarks( bench );
+
+  if( output.empty() )
+    bench.writeJson( std::cout );
+  else {
+
+    std::ofstream file( output );
+    if( !file )
+      throw std::invalid_argument( "[][]Benchmark output '" + output + "' can not be written!" );
+    bench.writeJson( file );
+  }
+
+  return 0;
+}
+catch(const std::invalid_argument& e) {
+  std::cerr << "std::invlid_argument " << e.what() << std::endl;
+  exit(1);
+}
+catch(const std::exception& e) {
+  std::cerr << "std::exception : " << e.what() << std::endl;
+  exit(1);
+}
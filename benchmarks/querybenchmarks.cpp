@@ -0,0 +1,61 @@
+#include "benchmark.h"
+
+#include "../application/curvequeryindex.h"
+#include "../work/mybspline.h"
+
+// gmlib
+#include <scene/gmscene.h>
+
+// stl
+#include <cmath>
+
+
+
+namespace {
+
+  // Moves a curve between two scene prepares, as a simulation step does, and asks for the
+  // closest point to where a point of the curve went. Both distances are ~0 while the
+  // index follows the move; a stale tree answers from the old place.
+  void movedCurve( Benchmark& bench ) {
+
+    if( !bench.isEnabled( "curve_query_moved" ) )
+      return;
+
+    GMlib::DVector<GMlib::Vector<float,3>> c(16);
+    for( int i = 0; i < 16; ++i )
+      c[i] = GMlib::Vector<float,3>( std::cos( 0.37f * float(i) ), std::sin( 0.37f * float(i) ), 0.05f * float(i) );
+
+    GMlib::Scene scene;
+    auto curve = new MyB_spline<float>( c );
+    curve->sample( 200, 1 );
+    scene.insert( curve );
+    scene.prepare();
+
+    CurveQueryIndex index;
+    const float t = 0.5f * ( curve->getParStart() + curve->getParEnd() );
+    const GMlib::Point<float,3> p = curve->evaluate( t, 0 )[0];
+    const auto before = index.closestPoint( scene, p );
+
+    const GMlib::Vector<float,3> offset( 0.0f, 0.0f, 2.0f );
+    curve->translateGlobal( offset );
+    scene.prepare();
+    index.invalidateFrame();   // As GMlibWrapper::simulateStep() after Scene::prepare()
+
+    const auto after = index.closestPoint( scene, p + offset );
+
+    bench.record( "curve_query_moved", { { "offset", 2.0 } },
+                  { { "distance_before", before.distance }, { "distance_after", after.distance },
+                    { "builds", double( index.getBuildCount() ) } } );
+
+    scene.remove( curve );
+    delete curve;
+  }
+
+} // END anonymous namespace
+
+
+
+void runQueryBenchmarks( Benchmark& bench ) {
+
+  movedCurve( bench );
+}
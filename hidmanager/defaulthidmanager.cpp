@@ -19,6 +19,9 @@ using namespace GMlib;
 // qt
 #include <QGuiApplication>
 
+// stl
+#include <cmath>
+
 // Local Defines
 #define SNAP 0.01f
 
@@ -38,16 +41,32 @@ void DefaultHidManager::triggerAction(const HidAction* action, const HidInputEve
     _ogl_actions.emplace(action,params);
   else
     HidManager::triggerAction(action,params);
+
+  // Any action may move a camera or edit the scene; OpenGL actions run in that frame.
+  // The others run here, on the GUI thread, and take sceneMutex() themselves where they
+  // touch cameras or objects, so they stay between two steps of a threaded simulation
+  // and do not read a camera viewport while GMlibWrapper::render() has it reshaped.
+  if(_gmlib)
+    _gmlib->requestFrame();
 }
 
 void DefaultHidManager::triggerOGLActions() {
 
+  if(_ogl_actions.empty())
+    return;
+
+  // Actions edit the scene; keep them between two steps of a threaded simulation
+  std::lock_guard<std::mutex> lock(_gmlib->sceneMutex());
+
   while(!_ogl_actions.empty()) {
 
     auto action = _ogl_actions.front();
     HidManager::triggerAction(action.first,action.second);
     _ogl_actions.pop();
   }
+
+  // Show their result
+  _gmlib->requestFrame();
 }
 
 void DefaultHidManager::heDeSelectAllObjects() {
@@ -216,6 +235,8 @@ void DefaultHidManager::heLockTo(const HidInputEvent::HidInputParams& params) {
 
 void DefaultHidManager::heMoveCamera(const HidInputEvent::HidInputParams& params) {
 
+  std::lock_guard<std::mutex> lock(_gmlib->sceneMutex());
+
   auto view_name = viewNameFromParams(params);
   auto pos       = toGMlibViewPoint(view_name, posFromParams(params));
   auto prev      = toGMlibViewPoint(view_name, prevPosFromParams(params));
@@ -266,6 +287,7 @@ void DefaultHidManager::hePanHorizontal(const HidInputEvent::HidInputParams& par
   auto wheel_delta = wheelDeltaFromParams(params);
 
   Camera *cam = findCamera(view_name);
+  std::lock_guard<std::mutex> lock(_gmlib->sceneMutex());
   if( cam )
     cam->move(
       Vector<float,2>(
@@ -280,6 +302,7 @@ void DefaultHidManager::hePanVertical(const HidInputEvent::HidInputParams& param
   auto wheel_delta = wheelDeltaFromParams(params);
 
   Camera *cam = findCamera(view_name);
+  std::lock_guard<std::mutex> lock(_gmlib->sceneMutex());
   if( cam )
     cam->move(
       Vector<float,2>(
@@ -290,36 +313,11 @@ void DefaultHidManager::hePanVertical(const HidInputEvent::HidInputParams& param
 
 void DefaultHidManager::heReplotQuick(int factor) {
 
+  // Queued; the scheduler does a factor 1 pass first and refines within its frame budget
   const Array<SceneObject*> &sel_objs = scene()->getSelectedObjects();
 
-  for( int i = 0; i < sel_objs.getSize(); i++ ) {
-
-    GMlib::SceneObject *sel_obj = sel_objs(i);
-
-    GMlib::PCurve<float,3> *curve = dynamic_cast<GMlib::PCurve<float,3>*>( sel_obj );
-    GMlib::PSurf<float,3> *surf = dynamic_cast<GMlib::PSurf<float,3>*>( sel_obj );
-
-    if( curve ) {
-
-      GMlib::PERBSCurve<float> *erbs = dynamic_cast<GMlib::PERBSCurve<float>*>(curve);
-      if( erbs )
-        erbs->sample( (erbs->getLocalCurves().getDim()-1)*factor + 1, 1 );
-      else
-        curve->sample( factor*factor*100, 2 );
-    }
-    else if( surf ) {
-
-      GMlib::PERBSSurf<float> *erbs = dynamic_cast<GMlib::PERBSSurf<float>*>(surf);
-      if( erbs )
-        erbs->sample(
-          (erbs->getLocalPatches().getDim1()-1)*factor + 1,
-          (erbs->getLocalPatches().getDim2()-1)*factor + 1,
-          2, 2 );
-      else {
-        surf->sample( 10*factor, 10*factor, 2, 2 );
-      }
-    }
-  }
+  for( int i = 0; i < sel_objs.getSize(); i++ )
+    _gmlib->replotScheduler().requestResample( sel_objs(i), factor );
 }
 
 void DefaultHidManager::heReplotQuickHigh() {
@@ -339,6 +337,8 @@ void DefaultHidManager::heReplotQuickMedium() {
 
 void DefaultHidManager::heRotateSelectedObjects(const HidInputEvent::HidInputParams& params) {
 
+  std::lock_guard<std::mutex> lock(_gmlib->sceneMutex());
+
   auto view_name = viewNameFromParams(params);
   auto pos       = toGMlibViewPoint(view_name, posFromParams(params));
   auto prev      = toGMlibViewPoint(view_name, prevPosFromParams(params));
@@ -377,6 +377,8 @@ void DefaultHidManager::heRotateSelectedObjects(const HidInputEvent::HidInputPar
 
 void DefaultHidManager::heScaleSelectedObjects(const HidInputEvent::HidInputParams& params) {
 
+  std::lock_guard<std::mutex> lock(_gmlib->sceneMutex());
+
   auto view_name = viewNameFromParams(params);
   auto pos       = toGMlibViewPoint(view_name, posFromParams(params));
   auto prev      = toGMlibViewPoint(view_name, prevPosFromParams(params));
@@ -469,6 +471,7 @@ void DefaultHidManager::heToggleSimulation() {
 
 void DefaultHidManager::heToggleSelectAllObjects() {
 
+  std::lock_guard<std::mutex> lock(_gmlib->sceneMutex());
   if( scene()->getSelectedObjects().getSize() > 0 )
     heDeSelectAllObjects();
   else
@@ -478,17 +481,20 @@ void DefaultHidManager::heToggleSelectAllObjects() {
 void DefaultHidManager::heZoom(const HidInputEvent::HidInputParams& params) {
 
   auto view_name   = viewNameFromParams(params);
-  auto wheel_delta = wheelDeltaFromParams(params);
 
-  // Qt comp scale
-  wheel_delta /= 8;
+  // Coalesced wheel events carry their summed delta; Qt gives 120 (15 degrees) per notch
+  const float notches = wheelDeltaFromParams(params) / 120.0f;
 
   Camera *cam    = findCamera(view_name);
   Camera *isocam = dynamic_cast<IsoCamera*>( cam );
 
+  std::lock_guard<std::mutex> lock(_gmlib->sceneMutex());
   if( isocam ) {
-    if( wheel_delta < 0 ) isocam->zoom( 1.05f );
-    if( wheel_delta > 0 ) isocam->zoom( 0.95f );
+    // 5 % per notch
+    isocam->zoom( std::pow( 1.05f, -notches ) );
+
+    // The frame stays put; the picking cache can not see the projection change
+    _gmlib->invalidatePickingCache();
   }
   else if( cam ) {
       double scale;
@@ -497,7 +503,7 @@ void DefaultHidManager::heZoom(const HidInputEvent::HidInputParams& params) {
     else
       scale = double(scene()->getSphere().getRadius());
 
-    cam->move( wheel_delta*scale/cam->getViewportH() );
+    cam->move( 15.0f*notches*scale/cam->getViewportH() );
   }
 }
 
@@ -511,6 +517,11 @@ void DefaultHidManager::heOpenCloseHidHelp() {
   emit signOpenCloseHidHelp();
 }
 
+void DefaultHidManager::heOpenCloseFrameProfiler() {
+
+  emit signOpenCloseFrameProfiler();
+}
+
 Camera* DefaultHidManager::findCamera( const QString& view_name ) const {
 
   return _gmlib->camera(view_name).get();
@@ -711,6 +722,13 @@ void DefaultHidManager::setupDefaultHidBindings() {
                          "Toggle open/close the Hid bindings help view",
                          this, SLOT(heOpenCloseHidHelp()) );
 
+  // Open/Close frame profiler overlay
+  QString ha_id_var_open_close_fpview =
+      registerHidAction( "Application",
+                         "Open/Close frame profiler",
+                         "Toggle open/close the frame time overlay",
+                         this, SLOT(heOpenCloseFrameProfiler()) );
+
   // Various cleanup
   QString ha_id_var_lm_rel =
       registerHidAction( "Various",
@@ -745,6 +763,7 @@ void DefaultHidManager::setupDefaultHidBindings() {
 
   registerHidMapping( ha_id_var_lm_rel,                   new MouseReleaseInput( Qt::LeftButton ) );
   registerHidMapping( ha_id_var_open_close_hbview,        new KeyPressInput( Qt::Key_Question, Qt::ShiftModifier ) );
+  registerHidMapping( ha_id_var_open_close_fpview,        new KeyPressInput( Qt::Key_F3 ) );
 
   registerHidMapping( ha_id_view_pan_h,                   new WheelInput( Qt::ControlModifier ) );
   registerHidMapping( ha_id_view_pan_v,                   new WheelInput( Qt::ShiftModifier ) );
@@ -31,6 +31,7 @@ protected:
 signals:
   void signToggleSimulation();
   void signOpenCloseHidHelp();
+  void signOpenCloseFrameProfiler();
 
 public slots:
   virtual void                      heDeSelectAllObjects();
@@ -62,6 +63,7 @@ public slots:
 
   virtual void                      heLeftMouseReleaseStuff();
   virtual void                      heOpenCloseHidHelp();
+  virtual void                      heOpenCloseFrameProfiler();
 
 private:
   GMlib::Camera*                    findCamera( const QString& view_name ) const;
@@ -1,35 +1,142 @@
 #include "hidinput.h"
 
+// qt
+#include <QHash>
 
-HidInput::HidInput() : _type(), _data() {}
 
-HidInput::HidInput(const QVariant &type) : _type(type), _data() {}
+int
+HidInput::Keys::bit( Qt::Key key ) {
 
-HidInput::HidInput(const HidInput &copy) : _type(copy._type), _data(copy._data) {}
+  const auto code = quint32(key);
+  if( code < 0x100 )                             return int(code);
+  if( code >= 0x01000000 && code < 0x01000100 )  return int(256 + (code & 0xff));
+  return -1;
+}
 
-const
-QVariant& HidInput::getType() const {  return _type; }
+void
+HidInput::Keys::set( Qt::Key key, bool state ) {
+
+  const int b = bit(key);
+  if( b < 0 ) {
+    if( state )                        _other = quint32(key);
+    else if( _other == quint32(key) )  _other = 0;
+    return;
+  }
+
+  const quint64 mask = quint64(1) << (b & 63);
+  if( state ) _bits[size_t(b >> 6)] |=  mask;
+  else        _bits[size_t(b >> 6)] &= ~mask;
+}
 
 bool
-HidInput::equals( const HidInput& /*other*/ ) const { return false; }
+HidInput::Keys::test( Qt::Key key ) const {
+
+  const int b = bit(key);
+  if( b < 0 )
+    return _other != 0 && _other == quint32(key);
+
+  return (_bits[size_t(b >> 6)] >> (b & 63)) & 1;
+}
+
+bool
+HidInput::Keys::isEmpty() const {
+
+  for( auto word : _bits )
+    if( word ) return false;
+
+  return _other == 0;
+}
+
+Qt::Key
+HidInput::Keys::first() const {
+
+  for( size_t w = 0; w < _bits.size(); ++w ) {
 
-const QMap<QString,QVariant>&
-HidInput::getData() const { return _data; }
+    if( !_bits[w] )
+      continue;
 
-QVariant
-HidInput::getData( const QString& name ) const { return _data.value(name); }
+    int b = int(w * 64);
+    for( auto word = _bits[w]; !(word & 1); word >>= 1 )
+      ++b;
+
+    return static_cast<Qt::Key>( b < 256 ? b : 0x01000000 + (b - 256) );
+  }
+
+  return _other ? static_cast<Qt::Key>(_other) : Qt::Key_unknown;
+}
+
+QList<Qt::Key>
+HidInput::Keys::keys() const {
+
+  QList<Qt::Key> list;
+  for( int b = 0; b < 512; ++b ) {
+    if( (_bits[size_t(b >> 6)] >> (b & 63)) & 1 )
+      list.append( static_cast<Qt::Key>( b < 256 ? b : 0x01000000 + (b - 256) ) );
+  }
+
+  if( _other )
+    list.append( static_cast<Qt::Key>(_other) );
+
+  return list;
+}
+
+bool
+HidInput::Keys::operator == ( const Keys& other ) const {
+
+  return _bits == other._bits && _other == other._other;
+}
+
+
+
+
+HidInput::HidInput() { updateSignature(); }
+
+HidInput::HidInput( Type type ) : _type(type) { updateSignature(); }
+
+HidInput::Type
+HidInput::getType() const {  return _type; }
+
+Qt::KeyboardModifiers
+HidInput::getKeyboardModifiers() const { return _keymods; }
+
+void
+HidInput::setKeyboardModifiers( const Qt::KeyboardModifiers& keymods ) { _keymods = keymods; updateSignature(); }
+
+Qt::MouseButtons
+HidInput::getMouseButtons() const { return _buttons; }
+
+void
+HidInput::setMouseButtons( const Qt::MouseButtons& buttons ) { _buttons = buttons; updateSignature(); }
+
+const HidInput::Keys&
+HidInput::getKeys() const { return _keys; }
+
+void
+HidInput::setKeys( const Keys& keys ) { _keys = keys; }
+
+bool
+HidInput::isSingleKey() const { return _single_key; }
 
 void
-HidInput::setData( const QString& name, const QVariant& data ) { _data[name] = data; }
+HidInput::setSinglekey( bool state ) { _single_key = state; }
 
 QString
 HidInput::toString() const { return QString(); }
 
 bool
-HidInput::operator <  ( const HidInput& other ) const { return sizeof(_type) + sizeof(_data); }
+HidInput::operator == ( const HidInput& other ) const {
 
-bool
-HidInput::operator == ( const HidInput& other ) const {  return equals(other); }
+  if( _type == NONE || _type != other._type )
+    return false;
+
+  if( _keymods != other._keymods || _buttons != other._buttons )
+    return false;
+
+  if( _single_key )
+    return other._keys.test( _keys.first() );
+
+  return _keys == other._keys;
+}
 
 const HidInput&
 HidInput::getDefault() {
@@ -38,4 +145,8 @@ HidInput::getDefault() {
   return hid_input;
 }
 
+void
+HidInput::updateSignature() {
 
+  _signature = qHash( uint(_type) ) ^ (uint(_keymods) * 31u) ^ (uint(_buttons) * 2654435761u);
+}
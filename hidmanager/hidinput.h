@@ -2,32 +2,84 @@
 #define HIDINPUT_H
 
 // qt
-#include <QVariant>
+#include <QList>
+#include <QString>
+#include <Qt>
+
+// stl
+#include <array>
 
 class HidInput {
 public:
+  enum Type : quint8 {
+    NONE,
+    KEY_PRESS,
+    KEY_RELEASE,
+    MOUSE_PRESS,
+    MOUSE_RELEASE,
+    MOUSE_DOUBLE_CLICK,
+    MOUSE_MOVE,
+    WHEEL
+  };
+
+  // Key bitset; Latin-1 keys and the 0x010000xx special keys, plus one other key code
+  class Keys {
+  public:
+    void                          set( Qt::Key key, bool state = true );
+    bool                          test( Qt::Key key ) const;
+    bool                          isEmpty() const;
+    Qt::Key                       first() const;
+    QList<Qt::Key>                keys() const;
+
+    bool                          operator == ( const Keys& other ) const;
+    bool                          operator != ( const Keys& other ) const { return !(*this == other); }
+
+  private:
+    static int                    bit( Qt::Key key );
+
+    std::array<quint64,8>         _bits  {{}};
+    quint32                       _other {0};
+  };
+
   HidInput();
-  HidInput( const QVariant& type );
-  HidInput( const HidInput& copy );
+  HidInput( Type type );
+  virtual ~HidInput() = default;
+
+  Type                            getType() const;
+
+  Qt::KeyboardModifiers           getKeyboardModifiers() const;
+  void                            setKeyboardModifiers( const Qt::KeyboardModifiers& keymods );
 
-  const QVariant&                 getType() const;
+  Qt::MouseButtons                getMouseButtons() const;
+  void                            setMouseButtons( const Qt::MouseButtons& buttons );
 
-  const QMap<QString,QVariant>&   getData() const;
-  QVariant                        getData( const QString& name ) const;
-  void                            setData( const QString& name, const QVariant& data );
+  const Keys&                     getKeys() const;
+  void                            setKeys( const Keys& keys );
+
+  bool                            isSingleKey() const;
+  void                            setSinglekey( bool state );
 
   virtual QString                 toString() const;
 
-  bool                            operator <  ( const HidInput& other ) const;
+  // Hash key of the inputs this input can be equal to; equal inputs have equal signatures.
+  // Keys are left out, a single key binding matches any keymap holding that key
+  uint                            signature() const { return _signature; }
+
+  // Binding side on the left: a single key input matches any input holding its key
   bool                            operator == ( const HidInput& other ) const;
 
-  static const HidInput&          getDefault(); 
+  static const HidInput&          getDefault();
 
 private:
-  QVariant                    _type;
-  QMap<QString,QVariant>      _data;
+  // Packed, no heap; HidInputEvent keeps a sliced copy, so everything lives in the base
+  Type                            _type       {NONE};
+  bool                            _single_key {false};
+  Qt::KeyboardModifiers           _keymods    {Qt::NoModifier};
+  Qt::MouseButtons                _buttons    {Qt::NoButton};
+  Keys                            _keys;
+  uint                            _signature  {0};
 
-  virtual bool                equals( const HidInput& /*other*/ ) const;
+  void                            updateSignature();
 };
 
 #endif //HIDINPUT_H
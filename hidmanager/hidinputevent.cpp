@@ -8,9 +8,9 @@ HidInputEvent::HidInputEvent(const HidInput& input , const HidInputParams &param
   : QEvent( HidInputEvent::HID_INPUT ), _input(input), _params(params) {}
 
 HidInputEvent::HidInputEvent( const HidInputEvent& copy )
-  : QEvent(copy), _input(copy._input) {}
+  : QEvent(copy), _input(copy._input), _params(copy._params) {}
 
-const QVariant&
+HidInput::Type
 HidInputEvent::getType() const { return _input.getType(); }
 
 const HidInput&
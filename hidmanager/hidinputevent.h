@@ -7,16 +7,25 @@
 
 // qt
 #include <QEvent>
+#include <QPoint>
+#include <QString>
 
 class HidInputEvent : public QEvent {
 public:
   static const QEvent::Type HID_INPUT;
-  typedef QHash<QString,QVariant> HidInputParams;
+
+  // Fixed params; view_name is implicitly shared, so copies do not allocate
+  struct HidInputParams {
+    QString                       view_name;
+    QPoint                        pos;
+    QPoint                        prev_pos;
+    int                           wheel_delta {0};
+  };
 
   explicit HidInputEvent( const HidInput& input, const HidInputParams& params = HidInputParams() );
   explicit HidInputEvent( const HidInputEvent& copy );
 
-  const QVariant&                 getType() const;
+  HidInput::Type                  getType() const;
   const HidInput&                 getInput() const;
   const HidInputParams&           getParams() const;
 
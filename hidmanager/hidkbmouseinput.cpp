@@ -6,19 +6,9 @@
 #include <QStringList>
 
 
-KeyModifierInput::KeyModifierInput( const Qt::KeyboardModifiers& keymods, const QVariant& type )
+KeyModifierInput::KeyModifierInput( const Qt::KeyboardModifiers& keymods, Type type )
   : HidInput(type) {  setKeyboardModifiers( keymods ); }
 
-Qt::KeyboardModifiers
-KeyModifierInput::getKeyboardModifiers() const {
-  return static_cast<Qt::KeyboardModifiers>(getData( "keyboard_modifiers" ).toInt());
-}
-
-void
-KeyModifierInput::setKeyboardModifiers( const Qt::KeyboardModifiers& keymods ) {
-  setData( "keyboard_modifiers", QVariant(int(keymods)) );
-}
-
 bool KeyModifierInput::isKeyboardModifiersActive(const Qt::KeyboardModifiers& modifiers) const {
   return getKeyboardModifiers() == modifiers;
 }
@@ -44,7 +34,16 @@ QString KeyModifierInput::toString() const {
 
 
 
-KeyInput::KeyInput( const Keymap& keymap, const Qt::KeyboardModifiers& keymods, const QVariant& type )
+
+KeyInput::KeyInput( const Keys& keys, const Qt::KeyboardModifiers& keymods, Type type )
+  : KeyModifierInput( keymods, type ) {
+
+  setKeys( keys );
+
+  setSinglekey(false);
+}
+
+KeyInput::KeyInput( const Keymap& keymap, const Qt::KeyboardModifiers& keymods, Type type )
   : KeyModifierInput( keymods, type ) {
 
   setKeymap( keymap );
@@ -52,12 +51,12 @@ KeyInput::KeyInput( const Keymap& keymap, const Qt::KeyboardModifiers& keymods,
   setSinglekey(false);
 }
 
-KeyInput::KeyInput(const Qt::Key &key, const Qt::KeyboardModifiers &keymods, const QVariant &type)
+KeyInput::KeyInput(const Qt::Key &key, const Qt::KeyboardModifiers &keymods, Type type)
   : KeyModifierInput( keymods, type ) {
 
-  Keymap keymap;
-  keymap[key] = true;
-  setKeymap(keymap);
+  Keys keys;
+  keys.set(key);
+  setKeys(keys);
 
   setSinglekey(true);
 }
@@ -65,11 +64,9 @@ KeyInput::KeyInput(const Qt::Key &key, const Qt::KeyboardModifiers &keymods, con
 KeyInput::Keymap
 KeyInput::getKeymap() const {
 
-  QList<QVariant>         keys_var    = getData("keymap_keys").toList();
-  QMap<QString,QVariant>  keymap_var  = getData("keymap").toMap();
-  Keymap                  keymap;
-  for( QList<QVariant>::iterator itr = keys_var.begin(); itr != keys_var.end(); ++itr )
-    keymap[static_cast<Qt::Key>((*itr).toInt())] = keymap_var.value( QString((*itr).toInt()), QVariant(false) ).toBool();
+  Keymap keymap;
+  for( auto key : getKeys().keys() )
+    keymap[key] = true;
 
   return keymap;
 }
@@ -77,58 +74,32 @@ KeyInput::getKeymap() const {
 void
 KeyInput::setKeymap( const Keymap& keymap ) {
 
-  QList<Qt::Key> keys = keymap.keys();
-  QList<QVariant> keys_var;
-  QMap<QString,QVariant> keymap_var;
-  for( QList<Qt::Key>::iterator itr = keys.begin(); itr != keys.end(); ++itr ) {
-    keys_var.append( int(*itr) );
-    keymap_var[QString(int(*itr))] = keymap.value( *itr, false );
-  }
-
-  setData( "keymap_keys", keys_var );
-  setData( "keymap", keymap_var );
-}
-
-bool KeyInput::isSingleKey() const {
-
-  return getData("keyinput_single_key").toBool();
-}
-
-void KeyInput::setSinglekey(bool state) {
+  Keys keys;
+  for( Keymap::const_iterator itr = keymap.begin(); itr != keymap.end(); ++itr )
+    keys.set( itr.key(), itr.value() );
 
-  setData("keyinput_single_key", QVariant(state));
+  setKeys( keys );
 }
 
 bool KeyInput::isKeyActive(Qt::Key key) const {
 
-  const Keymap keymap = getKeymap();
-  return keymap.value( key, false );
+  return getKeys().test( key );
 }
 
 bool KeyInput::isKeymapEqual(const Keymap &keymap_other) const {
 
-  const Keymap keymap = getKeymap();
-
-  QList<Qt::Key> keys, keys_other;
-  keys        = keymap.uniqueKeys();
-  keys_other  = keymap_other.uniqueKeys();
+  Keys keys_other;
+  for( Keymap::const_iterator itr = keymap_other.begin(); itr != keymap_other.end(); ++itr )
+    keys_other.set( itr.key() );
 
-  if( keys.size() != keys_other.size() )
-    return false;
-
-  std::sort(std::begin(keys),std::end(keys));
-  std::sort(std::begin(keys_other),std::end(keys_other));
-
-  return keys == keys_other;
+  return getKeys() == keys_other;
 }
 
 QString KeyInput::toString() const {
 
-  const Keymap keymap = getKeymap();
-
   int keys_value = 0;
-  for( Keymap::const_iterator itr = keymap.begin(); itr != keymap.end(); ++itr )
-    keys_value += itr.key();
+  for( auto key : getKeys().keys() )
+    keys_value += key;
 
   QKeySequence ks(keys_value);
 
@@ -138,35 +109,23 @@ QString KeyInput::toString() const {
     return KeyModifierInput::toString() + " + " + ks.toString();
 }
 
-bool KeyInput::equals(const HidInput & other) const {
-
-  if( getType() != other.getType() )
-    return false;
 
-  const KeyInput key_input = static_cast<const KeyInput&>(other);
-
-  if( getKeyboardModifiers() != key_input.getKeyboardModifiers() )
-    return false;
-
-  if( isSingleKey() )
-    return key_input.isKeyActive( getKeymap().keys().first() );
-  else
-    return key_input.isKeymapEqual( getKeymap() );
-}
 
 
 
 
 
+KeyPressInput::KeyPressInput( const Keys& keys, const Qt::KeyboardModifiers& keymods )
+  : KeyInput( keys, keymods, KEY_PRESS ) {}
 
 KeyPressInput::KeyPressInput( const Keymap& keymap, const Qt::KeyboardModifiers& keymods )
-  : KeyInput( keymap, keymods, QVariant( "KeyPress" ) ) {}
+  : KeyInput( keymap, keymods, KEY_PRESS ) {}
 
 KeyPressInput::KeyPressInput(const Qt::Key &key, const Qt::KeyboardModifiers &keymods)
-  : KeyInput( key, keymods, QVariant( "KeyPress" ) ) {}
+  : KeyInput( key, keymods, KEY_PRESS ) {}
 
 KeyReleaseInput::KeyReleaseInput(const Qt::Key &key, const Qt::KeyboardModifiers &keymods)
-  : KeyInput( key, keymods, QVariant( "KeyRelease" ) ) {}
+  : KeyInput( key, keymods, KEY_RELEASE ) {}
 
 QString KeyReleaseInput::toString() const {
 
@@ -181,19 +140,9 @@ QString KeyReleaseInput::toString() const {
 
 
 
-MouseButtonInput::MouseButtonInput( const Qt::MouseButtons& buttons, const Qt::KeyboardModifiers& keymods, const QVariant& type )
+MouseButtonInput::MouseButtonInput( const Qt::MouseButtons& buttons, const Qt::KeyboardModifiers& keymods, Type type )
   : KeyModifierInput( keymods, type ) {  setMouseButtons(buttons); }
 
-Qt::MouseButtons
-MouseButtonInput::getMouseButtons() const {
-  return static_cast<Qt::MouseButtons>(getData( "mouse_buttons" ).toInt());
-}
-
-void
-MouseButtonInput::setMouseButtons( const Qt::MouseButtons& buttons ) {
-  setData( "mouse_buttons", QVariant(int(buttons)) );
-}
-
 QString MouseButtonInput::toString() const {
 
   QStringList mb_str_list;
@@ -241,28 +190,15 @@ QString MouseButtonInput::toString() const {
     return KeyModifierInput::toString() + " + " + mb_str_list.join( " and " ) + mb_anot;
 }
 
-bool MouseButtonInput::equals(const HidInput &other) const {
-
-  if( other.getType() != getType() )
-    return false;
-
-  const MouseButtonInput& mbi = static_cast<const MouseButtonInput&>( other );
-
-  if( mbi.getKeyboardModifiers() != getKeyboardModifiers() )
-    return false;
-
-  return  mbi.getMouseButtons() == getMouseButtons();
-}
-
 
 
 
 MousePressInput::MousePressInput( const Qt::MouseButtons& buttons, const Qt::KeyboardModifiers& keymods )
-  : MouseButtonInput( buttons, keymods, "MousePress" ) {}
+  : MouseButtonInput( buttons, keymods, MOUSE_PRESS ) {}
 
 
 MouseReleaseInput::MouseReleaseInput( const Qt::MouseButtons& buttons, const Qt::KeyboardModifiers& keymods )
-  : MouseButtonInput( buttons, keymods, "MouseRelease" ) {}
+  : MouseButtonInput( buttons, keymods, MOUSE_RELEASE ) {}
 
 QString MouseReleaseInput::toString() const {
 
@@ -271,7 +207,7 @@ QString MouseReleaseInput::toString() const {
 
 
 MouseDoubleClickInput::MouseDoubleClickInput( const Qt::MouseButtons& buttons, const Qt::KeyboardModifiers& keymods )
-  : MouseButtonInput( buttons, keymods, "MouseDoubleClick" ) {}
+  : MouseButtonInput( buttons, keymods, MOUSE_DOUBLE_CLICK ) {}
 
 QString MouseDoubleClickInput::toString() const {
 
@@ -280,7 +216,7 @@ QString MouseDoubleClickInput::toString() const {
 
 
 MouseMoveInput::MouseMoveInput( const Qt::MouseButtons& buttons, const Qt::KeyboardModifiers& keymods )
-  : MouseButtonInput( buttons, keymods, "MouseMove" ) {}
+  : MouseButtonInput( buttons, keymods, MOUSE_MOVE ) {}
 
 QString MouseMoveInput::toString() const {
 
@@ -296,7 +232,7 @@ QString MouseMoveInput::toString() const {
 
 
 WheelInput::WheelInput( const Qt::KeyboardModifiers& keymods )
-  : KeyModifierInput( keymods, "Wheel" ) {}
+  : KeyModifierInput( keymods, WHEEL ) {}
 
 QString WheelInput::toString() const {
 
@@ -307,16 +243,3 @@ QString WheelInput::toString() const {
   else
     return KeyModifierInput::toString() + " + " + wheel_str;
 }
-
-bool WheelInput::equals(const HidInput& other) const {
-
-  if( other.getType() != getType() )
-    return false;
-
-  const WheelInput wi = static_cast<const WheelInput&>( other );
-  return wi.getKeyboardModifiers() == getKeyboardModifiers();
-}
-
-
-
-
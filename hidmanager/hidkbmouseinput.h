@@ -4,13 +4,13 @@
 
 #include "hidinput.h"
 
+// qt
+#include <QHash>
+
 
 class KeyModifierInput : public HidInput {
 public:
-  KeyModifierInput( const Qt::KeyboardModifiers& keymods, const QVariant& type );
-
-  Qt::KeyboardModifiers   getKeyboardModifiers() const;
-  void                    setKeyboardModifiers( const Qt::KeyboardModifiers& keymods );
+  KeyModifierInput( const Qt::KeyboardModifiers& keymods, Type type );
 
   bool                    isKeyboardModifiersActive(const Qt::KeyboardModifiers& modifiers ) const;
 
@@ -25,22 +25,17 @@ public:
   typedef QHash<Qt::Key, bool>   Keymap;
 
 
-  KeyInput( const Qt::Key& key, const Qt::KeyboardModifiers& keymods, const QVariant& type );
-  KeyInput( const Keymap& keymap, const Qt::KeyboardModifiers& keymods, const QVariant& type );
+  KeyInput( const Qt::Key& key, const Qt::KeyboardModifiers& keymods, Type type );
+  KeyInput( const Keys& keys, const Qt::KeyboardModifiers& keymods, Type type );
+  KeyInput( const Keymap& keymap, const Qt::KeyboardModifiers& keymods, Type type );
 
   Keymap                    getKeymap() const;
   void                      setKeymap( const Keymap& keymap );
 
-  bool                      isSingleKey() const;
-  void                      setSinglekey( bool state );
-
   bool                      isKeyActive( Qt::Key key ) const;
   bool                      isKeymapEqual( const Keymap& keymap ) const;
 
   QString                   toString() const override;
-
-private:
-  bool                      equals(const HidInput &) const override;
 };
 
 
@@ -48,6 +43,7 @@ private:
 
 class KeyPressInput : public KeyInput {
 public:
+  KeyPressInput( const Keys& keys, const Qt::KeyboardModifiers& keymods );
   KeyPressInput( const Keymap& keymap, const Qt::KeyboardModifiers& keymods );
   KeyPressInput( const Qt::Key& key, const Qt::KeyboardModifiers& keymods = Qt::NoModifier );
 };
@@ -76,15 +72,9 @@ public:
 
 class MouseButtonInput : public KeyModifierInput {
 public:
-  MouseButtonInput( const Qt::MouseButtons& buttons, const Qt::KeyboardModifiers& keymods, const QVariant& type );
-
-  Qt::MouseButtons    getMouseButtons() const;
-  void                setMouseButtons( const Qt::MouseButtons& buttons );
+  MouseButtonInput( const Qt::MouseButtons& buttons, const Qt::KeyboardModifiers& keymods, Type type );
 
   QString     toString() const override;
-
-protected:
-  bool equals(const HidInput & other) const override;
 };
 
 
@@ -136,9 +126,6 @@ public:
   WheelInput( const Qt::KeyboardModifiers& keymods = Qt::NoModifier );
 
   QString     toString() const override;
-
-private:
-  bool      equals(const HidInput &) const override;
 };
 
 
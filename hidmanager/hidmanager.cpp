@@ -66,18 +66,23 @@ void HidManager::customEvent(QEvent *event) {
 
 //  qDebug() << "Mappings count: " << _hid_bindings.size();
 
-  QSet<const HidBinding>::iterator bnd_itr = std::find_if( _hid_bindings.begin(),
-                                                           _hid_bindings.end(),
-                                                           HidBindingCompare( he->getInput() ) );
-  if( bnd_itr == _hid_bindings.end() ) {
+  // Candidates share the input's signature; first equal binding wins
+  const HidInput& input = he->getInput();
+  const auto bnd_itr = _binding_index.constFind( input.signature() );
+  if( bnd_itr == _binding_index.constEnd() ) {
 //    qDebug() << "  Input does not exist";
     return;
   }
 
-  QSet<const HidAction*>::iterator act_itr = std::find_if( _hid_actions.begin(),
-                                                           _hid_actions.end(),
-                                                           HidActionCompareId( (*bnd_itr).getActionName() ) );
-  if( act_itr == _hid_actions.end() ) {
+  const HidAction* action = nullptr;
+  for( const auto& binding : bnd_itr.value() ) {
+    if( *binding.input == input ) {
+      action = binding.action;
+      break;
+    }
+  }
+
+  if( !action ) {
 
 //    qDebug() << "  Input is not mapped to any action";
     return;
@@ -91,7 +96,7 @@ void HidManager::customEvent(QEvent *event) {
 //  }
 
   event->setAccepted(true);
-  triggerAction( *act_itr, he->getParams() );
+  triggerAction( action, he->getParams() );
 }
 
 void HidManager::triggerAction(const HidAction* action, const HidInputEvent::HidInputParams& params) {
@@ -115,9 +120,7 @@ QString HidManager::registerHidAction( const QString& group,
   QString identifier = QString("%1.%2").arg(group).arg(name);
 //  qDebug() << "Registering HidAction: " << identifier;
 
-  QSet<const HidAction*>::iterator item_itr =
-      std::find_if( _hid_actions.begin(), _hid_actions.end(), HidActionCompareId( identifier ) );
-  if( item_itr != _hid_actions.end() ) {
+  if( _action_index.contains( identifier ) ) {
 //    qDebug() << "  Does already exist";
     return QString();
   }
@@ -127,8 +130,9 @@ QString HidManager::registerHidAction( const QString& group,
   connect( act, SIGNAL(signTrigger(HidInputEvent::HidInputParams)), receiver, method, Qt::DirectConnection );
 
   _hid_actions.insert( act );
+  _action_index.insert( identifier, act );
 
-  _model->update(_hid_actions, _hid_bindings);
+  _model->insertAction( act );
 
   return identifier;
 }
@@ -141,18 +145,18 @@ bool HidManager::registerHidMapping(const QString& action_name, const HidInput *
   if( !hid_input )
     return false;
 
-  HidActions::iterator act_itr =
-      std::find_if( _hid_actions.begin(), _hid_actions.end(), HidActionCompareId(action_name) );
-  if( act_itr == _hid_actions.end() )
+  const auto act_itr = _action_index.constFind( action_name );
+  if( act_itr == _action_index.constEnd() )
     return false;
 
-  HidBindings::iterator bnd_itr = std::find_if(_hid_bindings.begin(), _hid_bindings.end(), HidBindingCompare(action_name) );
-  if( bnd_itr != _hid_bindings.end() )
+  if( _mapped_actions.contains( action_name ) )
     return false;
 
   _hid_bindings.insert(HidBinding(action_name,hid_input));
+  _mapped_actions.insert( action_name );
+  _binding_index[hid_input->signature()].append( IndexedBinding { hid_input, act_itr.value() } );
 
-  _model->update(_hid_actions,_hid_bindings);
+  _model->setBinding( action_name, hid_input->toString() );
 
   return true;
 }
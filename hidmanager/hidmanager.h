@@ -77,6 +77,15 @@ public:
   HidActions              _hid_actions;
   HidBindings             _hid_bindings;
 private:
+  struct IndexedBinding {
+    const HidInput*       input;
+    const HidAction*      action;
+  };
+
+  // Kept up to date by registerHidAction/registerHidMapping; dispatch looks inputs up by signature
+  QHash<QString,const HidAction*>         _action_index;
+  QHash<uint,QList<IndexedBinding>>       _binding_index;
+  QSet<QString>                           _mapped_actions;
 
   HidManagerTreeModel     *_model;
 
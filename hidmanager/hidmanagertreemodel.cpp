@@ -20,7 +20,12 @@ public:
     _children.append(child);
   }
 
-  void          clear() { _children.clear(); }
+  void          insertChild(int row, TreeItem *child) {
+
+    _children.insert(row, child);
+  }
+
+  void          clear() { qDeleteAll(_children); _children.clear(); }
   TreeItem*     child(int row) { return _children.value(row); }
   int           childCount() const { return _children.count(); }
   int           columnCount() const { return 3; /*return _data.count();*/ }
@@ -189,72 +194,96 @@ QVariant HidManagerTreeModel::headerData(int section, Qt::Orientation orientatio
 
 void HidManagerTreeModel::update(const HidManager::HidActions &a,const HidManager::HidBindings &b) {
 
-  _hb = b;
+  // Binding text by action identifier; one pass instead of a search per action
+  QHash<QString, QString> binding_text;
+  for( auto hb_itr = b.begin(); hb_itr != b.end(); ++hb_itr )
+    binding_text.insert( hb_itr->getActionName(), hb_itr->getHidBindingText() );
 
-  _data.clear();
-  for( auto ha_itr = a.begin(); ha_itr != a.end(); ++ha_itr ) {
+  beginResetModel();
+  clearTree();
+
+  for( auto ha_itr = a.begin(); ha_itr != a.end(); ++ha_itr )
+    addEntry( *ha_itr, binding_text.value( (*ha_itr)->getIdentifier() ), false );
 
-    HidEntryInfoList heil;
-    heil.append((*ha_itr)->getName());
-    heil.append((*ha_itr)->getDescription());
+  endResetModel();
+}
 
-    heil.append(
-      [=]() {
-        auto itr = std::find_if(b.begin(), b.end(), HidBindingCompare( (*ha_itr)->getIdentifier() ));
-        return itr != b.end() ? itr->getHidBindingText() : "";
-      }()
-    );
+void HidManagerTreeModel::insertAction(const HidAction* action, const QString& binding) {
 
-    heil.append((*ha_itr)->getIdentifier());
+  if( _entries.contains( action->getIdentifier() ) )
+    return;
 
-    HidEntryMap entry_map = _data.value( (*ha_itr)->getGroup() );
+  addEntry( action, binding, true );
+}
 
-    entry_map[(*ha_itr)->getName()] = heil;
-    _data[(*ha_itr)->getGroup()] = entry_map;
-  }
+void HidManagerTreeModel::setBinding(const QString& identifier, const QString& binding) {
 
+  TreeItem *entry_item = _entries.value( identifier );
+  if( !entry_item )
+    return;
 
-  // THIS ----------------- can/should be optimized in such a way that model shouldn't be reset and tree shouldn't be cleared
-  //                        but updated instead.
+  entry_item->setData( 2, binding );
 
-  beginResetModel();
-  _root->clear();
+  const QModelIndex idx = createIndex( entry_item->row(), 0, entry_item );
+  emit dataChanged( idx, idx, QVector<int>() << Qt::UserRole+3 );
+}
 
-  // Groups
-  HidGroupMap::iterator g_itr = _data.begin();
-  while( g_itr !=  _data.end() ) {
+TreeItem* HidManagerTreeModel::groupItem(const QString& group, bool notify) {
 
-    QString group_name = g_itr.key();
-    HidEntryMap entry_map = g_itr.value();
+  TreeItem *group_item = _groups.value( group );
+  if( group_item )
+    return group_item;
 
-    QList<QVariant> group_data;
-    group_data << group_name;
-    TreeItem *group_item = new TreeItem(group_data,_root);
-    _root->appendChild( group_item );
+  const int row = sortedRow( _root, group );
 
+  if( notify ) beginInsertRows( QModelIndex(), row, row );
 
-    HidEntryMap::iterator e_itr = entry_map.begin();
-    while( e_itr != entry_map.end() ) {
+  QList<QVariant> group_data;
+  group_data << group;
+  group_item = new TreeItem( group_data, _root );
+  _root->insertChild( row, group_item );
+  _groups.insert( group, group_item );
 
-//      QString entry_name = e_itr.key();
-      HidEntryInfoList entry_info = e_itr.value();
+  if( notify ) endInsertRows();
 
-      QList<QVariant> entry_data;
-      HidEntryInfoList::iterator ei_itr = entry_info.begin();
-//      for( int i = 0; i < 2 && ei_itr != entry_info.end(); ++i, ++ei_itr ) {
-      for( ; ei_itr != entry_info.end(); ++ei_itr ) {
+  return group_item;
+}
+
+void HidManagerTreeModel::addEntry(const HidAction* action, const QString& binding, bool notify) {
+
+  TreeItem *group_item = groupItem( action->getGroup(), notify );
+  const int row = sortedRow( group_item, action->getName() );
+
+  if( notify ) beginInsertRows( createIndex( group_item->row(), 0, group_item ), row, row );
+
+  QList<QVariant> entry_data;
+  entry_data << action->getName() << action->getDescription() << binding << action->getIdentifier();
+  TreeItem *entry_item = new TreeItem( entry_data, group_item );
+  group_item->insertChild( row, entry_item );
+  _entries.insert( action->getIdentifier(), entry_item );
+
+  if( notify ) endInsertRows();
+}
+
+void HidManagerTreeModel::clearTree() {
 
-        entry_data.append( QVariant(*ei_itr) );
-      }
+  _root->clear();
+  _groups.clear();
+  _entries.clear();
+}
 
-      group_item->appendChild( new TreeItem( entry_data, group_item ) );
+// Groups and entries are kept sorted by name
+int HidManagerTreeModel::sortedRow(TreeItem* parent, const QString& name) {
 
-      ++e_itr;
-    }
+  int lo = 0, hi = parent->childCount();
+  while( lo < hi ) {
 
-    ++g_itr;
+    const int mid = (lo + hi) / 2;
+    if( parent->child(mid)->data(0).toString() < name ) lo = mid + 1;
+    else                                               hi = mid;
   }
-  endResetModel();
+
+  return lo;
 }
 
 QHash<int, QByteArray> HidManagerTreeModel::roleNames() const {
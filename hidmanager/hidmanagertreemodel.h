@@ -28,24 +28,30 @@ public:
 
   QVariant        headerData(int section, Qt::Orientation orientation, int role) const override;
 
+  // Full rebuild; resets the model
   void            update( const HidManager::HidActions& action, const HidManager::HidBindings& bindings );
 
+  // Incremental; rows are inserted in sorted place, the binding column is updated in place
+  void            insertAction( const HidAction* action, const QString& binding = QString() );
+  void            setBinding( const QString& identifier, const QString& binding );
+
   QHash< int, QByteArray >    roleNames() const override;
 
 private:
-  typedef QList<QString>                    HidEntryInfoList;
-  typedef QMap<QString, HidEntryInfoList>   HidEntryMap;
-  typedef QMap<QString, HidEntryMap>        HidGroupMap;
-
-  HidManager                    *_hm;
-  HidManager::HidActions        _hal;
-  HidManager::HidBindings       _hb;
+  TreeItem*       groupItem( const QString& group, bool notify );
+  void            addEntry( const HidAction* action, const QString& binding, bool notify );
+  void            clearTree();
 
-  HidGroupMap                   _data;
+  static int      sortedRow( TreeItem* parent, const QString& name );
 
+  HidManager                    *_hm;
 
   TreeItem                      *_root;
 
+  // Group name -> group item, action identifier -> entry item
+  QHash<QString, TreeItem*>     _groups;
+  QHash<QString, TreeItem*>     _entries;
+
 }; // END class HidBindingsModel
 
 #endif // HIDBINDINGSMODEL_H
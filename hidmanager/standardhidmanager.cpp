@@ -112,7 +112,7 @@ void StandardHidManager::registerKey(Qt::Key key, Qt::KeyboardModifiers modifier
   if( isKeyRegistered( key ) )
     return;
 
-  _reg_keymap[key] = true;
+  _reg_keymap.set( key );
 }
 
 
@@ -147,7 +147,7 @@ void StandardHidManager::unregisterKey(Qt::Key key, Qt::KeyboardModifiers modifi
 
   _reg_key_last_unreg = key;
 
-  _reg_keymap.remove( key );
+  _reg_keymap.set( key, false );
 }
 
 
@@ -171,35 +171,35 @@ void StandardHidManager::registerWheelEvent(const QString& name, QWheelEvent *e)
 
 QString
 StandardHidManager::viewNameFromParams(const HidInputEvent::HidInputParams& params) {
-  return params["view_name"].toString();
+  return params.view_name;
 }
 
 
 QPoint
 StandardHidManager::posFromParams(const HidInputEvent::HidInputParams& params) {
-  return params["pos"].toPoint();
+  return params.pos;
 }
 
 
 QPoint
 StandardHidManager::prevPosFromParams(const HidInputEvent::HidInputParams& params) {
-  return params["prev_pos"].toPoint();
+  return params.prev_pos;
 }
 
 
 int
 StandardHidManager::wheelDeltaFromParams(const HidInputEvent::HidInputParams& params) {
-  return params["wheel_delta"].toInt();
+  return params.wheel_delta;
 }
 
 
 bool StandardHidManager::isKeyRegistered(Qt::Key key) const {
-  return _reg_keymap.value(key, false);
+  return _reg_keymap.test(key);
 }
 
 
 bool StandardHidManager::isAnyKeysRegistered() const {
-  return _reg_keymap.size() > 0;
+  return !_reg_keymap.isEmpty();
 }
 
 
@@ -227,38 +227,46 @@ bool StandardHidManager::isMouseButtonRegistered(Qt::MouseButton button) const {
 
 void StandardHidManager::generateEvent() {
 
-  HidInputEvent::HidInputParams params;
-  params["view_name"] = QVariant( _reg_rcpair_name );
+  // Events live on the stack; sendEvent() dispatches synchronously
+  HidInputEvent::HidInputParams key_params;
+  key_params.view_name = _reg_rcpair_name;
 
-  HidInputEvent::HidInputParams key_params {params};
+  HidInputEvent::HidInputParams mouse_params {key_params};
+  mouse_params.pos      = _reg_view_pos;
+  mouse_params.prev_pos = _reg_view_prev_pos;
 
-  HidInputEvent::HidInputParams mouse_params {params};
-  mouse_params["pos"]      = QVariant( _reg_view_pos );
-  mouse_params["prev_pos"] = QVariant( _reg_view_prev_pos );
-
-  HidInputEvent::HidInputParams wheel_params {params};
-  wheel_params["wheel_delta"] = QVariant(_reg_wheel_delta);
+  HidInputEvent::HidInputParams wheel_params {key_params};
+  wheel_params.wheel_delta = _reg_wheel_delta;
 
   if( _reg_next_mouse_event_type == MOUSE_MOVE ) {
-    QCoreApplication::sendEvent( this, new HidInputEvent( MouseMoveInput( _reg_mouse_buttons, _reg_keymods ), mouse_params ) );
+    queueMotionEvent( HidInput::MOUSE_MOVE, mouse_params );
     registerMouseEventType( MOUSE_NONE );
+    return;
   }
   else if( _reg_wheel_state ) {
-    QCoreApplication::sendEvent( this, new HidInputEvent( WheelInput( _reg_keymods ), wheel_params ) );
+    queueMotionEvent( HidInput::WHEEL, wheel_params );
     registerWheelData(false,0);
+    return;
   }
-  else if( _reg_next_mouse_event_type != MOUSE_NONE ) {
+
+  // Keep the order of events; a pending motion goes first
+  flushMotionEvents();
+
+  if( _reg_next_mouse_event_type != MOUSE_NONE ) {
 
     switch( _reg_next_mouse_event_type ) {
-      case MOUSE_DBL_CLICK:
-        QCoreApplication::sendEvent( this, new HidInputEvent( MouseDoubleClickInput( _reg_mouse_buttons, _reg_keymods ), mouse_params ) );
-        break;
-      case MOUSE_CLICK:
-        QCoreApplication::sendEvent( this, new HidInputEvent( MousePressInput( _reg_mouse_buttons, _reg_keymods ), mouse_params ) );
-        break;
-      case MOUSE_RELEASE:
-        QCoreApplication::sendEvent( this, new HidInputEvent( MouseReleaseInput( _reg_mouse_buttons, _reg_keymods ), mouse_params ) );
-        break;
+      case MOUSE_DBL_CLICK: {
+        HidInputEvent event( MouseDoubleClickInput( _reg_mouse_buttons, _reg_keymods ), mouse_params );
+        QCoreApplication::sendEvent( this, &event );
+      } break;
+      case MOUSE_CLICK: {
+        HidInputEvent event( MousePressInput( _reg_mouse_buttons, _reg_keymods ), mouse_params );
+        QCoreApplication::sendEvent( this, &event );
+      } break;
+      case MOUSE_RELEASE: {
+        HidInputEvent event( MouseReleaseInput( _reg_mouse_buttons, _reg_keymods ), mouse_params );
+        QCoreApplication::sendEvent( this, &event );
+      } break;
       case MOUSE_NONE:
       case MOUSE_MOVE:
       default:
@@ -271,10 +279,12 @@ void StandardHidManager::generateEvent() {
 
     switch( _reg_next_key_event_type ) {
       case KEY_PRESS: {
-        QCoreApplication::sendEvent( this, new HidInputEvent( KeyPressInput( _reg_keymap, _reg_keymods ), key_params ) );
+        HidInputEvent event( KeyPressInput( _reg_keymap, _reg_keymods ), key_params );
+        QCoreApplication::sendEvent( this, &event );
       } break;
       case KEY_RELEASE: {
-        QCoreApplication::sendEvent( this, new HidInputEvent( KeyReleaseInput( _reg_key_last_unreg, _reg_keymods ), key_params ) );
+        HidInputEvent event( KeyReleaseInput( _reg_key_last_unreg, _reg_keymods ), key_params );
+        QCoreApplication::sendEvent( this, &event );
       } break;
       case KEY_NONE:
       default:
@@ -287,6 +297,66 @@ void StandardHidManager::generateEvent() {
 }
 
 
+void StandardHidManager::queueMotionEvent( HidInput::Type type, const HidInputEvent::HidInputParams& params ) {
+
+  if( !_coalesce_motion ) {
+    sendMotionEvent( type, _reg_mouse_buttons, _reg_keymods, params );
+    return;
+  }
+
+  // Same view and same input, i.e. the same binding: fold into the pending event
+  auto& pending = _pending_motion;
+  if( pending.active && pending.type == type && pending.params.view_name == params.view_name &&
+      pending.keymods == _reg_keymods && (type == HidInput::WHEEL || pending.buttons == _reg_mouse_buttons) ) {
+
+    pending.params.pos          = params.pos;
+    pending.params.wheel_delta += params.wheel_delta;
+    return;
+  }
+
+  flushMotionEvents();
+
+  pending.active  = true;
+  pending.type    = type;
+  pending.buttons = _reg_mouse_buttons;
+  pending.keymods = _reg_keymods;
+  pending.params  = params;
+
+  emit signMotionPending();
+}
+
+void StandardHidManager::flushMotionEvents() {
+
+  if( !_pending_motion.active )
+    return;
+
+  // Cleared first; the triggered action may generate new input
+  const auto pending = _pending_motion;
+  _pending_motion.active = false;
+
+  sendMotionEvent( pending.type, pending.buttons, pending.keymods, pending.params );
+}
+
+void StandardHidManager::sendMotionEvent( HidInput::Type type, Qt::MouseButtons buttons, Qt::KeyboardModifiers keymods,
+                                          const HidInputEvent::HidInputParams& params ) {
+
+  if( type == HidInput::WHEEL ) {
+    HidInputEvent event( WheelInput( keymods ), params );
+    QCoreApplication::sendEvent( this, &event );
+  }
+  else {
+    HidInputEvent event( MouseMoveInput( buttons, keymods ), params );
+    QCoreApplication::sendEvent( this, &event );
+  }
+}
+
+void StandardHidManager::setMotionCoalescing( bool enabled ) {
+
+  _coalesce_motion = enabled;
+  if( !enabled )
+    flushMotionEvents();
+}
+
 void StandardHidManager::registerRCPairName(const QString& name) {
   _reg_rcpair_name = name;
 }
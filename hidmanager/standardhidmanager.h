@@ -35,6 +35,18 @@ public slots:
   virtual void                registerKeyReleaseEvent( const QString& name,  QKeyEvent* event );
   virtual void                registerWheelEvent( const QString& name, QWheelEvent* event );
 
+  // Dispatch the coalesced move/wheel event; once per frame
+  void                        flushMotionEvents();
+
+public:
+  // Fold consecutive move/wheel events of the same view and input into one per frame
+  void                        setMotionCoalescing( bool enabled );
+  bool                        isMotionCoalescing() const { return _coalesce_motion; }
+
+signals:
+  // A motion event is waiting for flushMotionEvents(); a frame should be scheduled
+  void                        signMotionPending();
+
 protected:
   static QString              viewNameFromParams( const HidInputEvent::HidInputParams& params );
   static QPoint               posFromParams( const HidInputEvent::HidInputParams& params );
@@ -56,6 +68,21 @@ private:
     KEY_RELEASE
   };
 
+  struct PendingMotion {
+    bool                                active  {false};
+    HidInput::Type                      type    {HidInput::NONE};
+    Qt::MouseButtons                    buttons {Qt::NoButton};
+    Qt::KeyboardModifiers               keymods {Qt::NoModifier};
+    HidInputEvent::HidInputParams       params;
+  };
+
+  void                        queueMotionEvent( HidInput::Type type, const HidInputEvent::HidInputParams& params );
+  void                        sendMotionEvent( HidInput::Type type, Qt::MouseButtons buttons, Qt::KeyboardModifiers keymods,
+                                               const HidInputEvent::HidInputParams& params );
+
+  PendingMotion               _pending_motion;
+  bool                        _coalesce_motion {true};
+
   void                        registerKeyEventType( KeyEventType type );
   void                        registerMouseEventType( MouseEventType type );
   virtual void                generateEvent();
@@ -70,7 +97,7 @@ private:
   void                        registerWindowPosition(const QPoint& pos );
   void                        registerRCPairName( const QString& name );
 
-  KeyInput::Keymap            _reg_keymap;
+  HidInput::Keys              _reg_keymap;
   Qt::KeyboardModifiers       _reg_keymods;
   Qt::Key                     _reg_key_last_unreg;
 
@@ -3,6 +3,7 @@
 #include "scenario.h"
 
 #include "work/torusknot.h"
+#include "application/gpucurvevisualizer.h"
 // hidmanager
 #include "hidmanager/defaulthidmanager.h"
 
@@ -72,10 +73,24 @@ void Scenario::initializeScenario()
   ptrack2->setArrowLength(2);
   ptom->insert(ptrack2); */
 
-  auto torusKnot = new TorusKnot();
-  torusKnot->toggleDefaultVisualizer();
-  torusKnot->sample(500);
-  this->scene()->insert(torusKnot);
+  // Objects are built and sampled on the load workers and inserted from callDefferedGL;
+  // the builds must not touch GL, visualizers are set up in the upload stage
+  sceneLoader().add(
+      []() -> GMlib::SceneObject * {
+        auto torusKnot = new TorusKnot();
+        // About 0.1% of the knot's size off the curve; the loops get the samples
+        torusKnot->setAdaptiveSampling(0.005f);
+        torusKnot->setLevelsOfDetail(4);
+        return torusKnot;
+      },
+      [](GMlib::SceneObject *obj) {
+        auto torusKnot = static_cast<TorusKnot *>(obj);
+        // Picks one of the levels of detail per view, each frame; needs GL 4.3
+        if (GpuCurveVisualizer::isSupported())
+          torusKnot->insertVisualizer(new GpuCurveVisualizer);
+        else
+          torusKnot->toggleDefaultVisualizer();
+      });
 }
 
 void Scenario::cleanupScenario()
@@ -85,10 +100,27 @@ void Scenario::cleanupScenario()
 void Scenario::callDefferedGL()
 {
 
-  GMlib::Array<const GMlib::SceneObject *> e_obj;
-  this->scene()->getEditedObjects(e_obj);
-
-  for (int i = 0; i < e_obj.getSize(); i++)
-    if (e_obj(i)->isVisible())
-      e_obj[i]->replot();
+  FrameProfiler::Scope scope(profiler(), "Scenario::callDefferedGL");
+
+  std::lock_guard<std::mutex> lock(sceneMutex());
+
+  // The staged scene load lands a batch of objects per frame
+  if (sceneLoader().isLoading())
+  {
+    FrameProfiler::Scope upload(profiler(), "SceneLoader::uploadFrame");
+    sceneLoader().uploadFrame(*this->scene());
+    emit signLoadProgress(int(sceneLoader().getLoaded()), int(sceneLoader().getTotal()));
+    requestFrame();
+  }
+
+  // Edits are coalesced per object and replotted within the frame budget, coarse first;
+  // AsyncReplottable objects are sampled on the worker pool and only uploaded here
+  {
+    FrameProfiler::Scope replot(profiler(), "ReplotScheduler::runFrame");
+    replotScheduler().runFrame(*this->scene(), rcPairCameras());
+  }
+
+  // Leftover or in-flight replots need further frames to land
+  if (replotScheduler().getPendingCount() > 0)
+    requestFrame();
 }
@@ -2,11 +2,13 @@
 #define TESTTORUS_H
 
 
+#include "application/parallelsimulator.h"
+
 // gmlib
 #include <parametrics/surfaces/gmptorus.h>
 
 
-class TestTorus : public GMlib::PTorus<float> {
+class TestTorus : public GMlib::PTorus<float>, public IndependentSimulation {
 public:
   using PTorus::PTorus;
 
@@ -31,18 +33,24 @@ public:
   }
 
 
-protected:
-  void localSimulate(double dt) override {
+  // Only moves itself (the clock is per object), so siblings may be stepped concurrently
+  void simulateIndependent(double dt) override {
 
-      static double t=0;
-      t += dt;
+      m_t += dt;
 
-      GMlib::Vector<float,3> vec(sin(t),cos(t),5*dt);
+      GMlib::Vector<float,3> vec(sin(m_t),cos(m_t),5*dt);
       vec *= 0.05;
       this->move(vec);
   }
 
+protected:
+  void localSimulate(double dt) override {
+
+      localSimulateFallback(dt);
+  }
+
 private:
+  double m_t {0.0};
   bool m_test01 {false};
   std::shared_ptr<TestTorus> test_01_torus {nullptr};
 
@@ -0,0 +1,157 @@
+#ifndef ADAPTIVE_SAMPLING_H
+#define ADAPTIVE_SAMPLING_H
+
+#include "curvesamples.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+/*!
+ *  AdaptiveSampling<T>
+ *
+ *  - Curvature-adaptive sampling: parameter intervals are halved until each chord keeps
+ *    within a world-space tolerance of the curve, so flat stretches keep few samples and
+ *    tight loops get many.
+ *  - The deviation of an interval of length h is estimated from the derivatives at its
+ *    ends, taken normal to the chord: h^2/8 |c''| bounds the sagitta, and the offset
+ *    h/8 |c'(a) - c'(b)| of the cubic Hermite midpoint catches turns where c'' is small.
+ *  - The curve is evaluated through eval(params, d, out), which fills out with samples
+ *    at the given parameters; one call per pass of refinement.
+ */
+template <typename T>
+struct AdaptiveSampling
+{
+  T    tolerance   {T(0)};   // <= 0 disables adaptive sampling
+  int  initial     {32};     // Uniform intervals to start from, fine enough not to step over a loop
+  int  max_samples {4096};   // Worst intervals are refined first once this limits the pass
+
+  // Working storage of sample(); kept by the caller, repeated runs of similar size do not allocate
+  struct Scratch
+  {
+    std::vector<T>                 t, mid, next_t;
+    CurveSamples<T, 3>             s, ms, next_s;
+    std::vector<std::pair<T, int>> split;   // (deviation, interval)
+  };
+
+  /*!
+   *  sample(eval, start, end, d, out) const
+   *
+   *  - Adaptive samples over [start, end] with d derivatives, in parameter order and
+   *    both ends included, into out. Second derivatives are evaluated for the estimate
+   *    whatever d is. Touches no state but scratch, so it may run on a replot worker.
+   */
+  template <typename Eval>
+  void sample(Eval &&eval, T start, T end, int d, CurveSamples<T, 3> &out) const
+  {
+    Scratch scratch;
+    sample(eval, start, end, d, out, scratch);
+  }
+
+  template <typename Eval>
+  void sample(Eval &&eval, T start, T end, int d, CurveSamples<T, 3> &out, Scratch &scratch) const
+  {
+    const int dd     = std::max(d, 2);
+    const int budget = std::max(max_samples, 2);
+    const int n0     = std::max(1, std::min(initial, budget - 1));
+
+    auto &t = scratch.t, &mid = scratch.mid, &next_t = scratch.next_t;
+    auto &s = scratch.s, &ms = scratch.ms, &next_s = scratch.next_s;
+    auto &split = scratch.split;
+
+    t.resize(n0 + 1);
+    for (int i = 0; i <= n0; ++i)
+      t[i] = (i == n0) ? end : start + (end - start) * T(i) / T(n0);
+    eval(t, dd, s);
+
+    // Halving stops well above float resolution of the parameter
+    const T min_h = std::abs(end - start) / T(1 << 20);
+
+    for (;;)
+    {
+      split.clear();
+      for (int i = 0; i + 1 < int(t.size()); ++i)
+      {
+        const T h = t[i + 1] - t[i];
+        const T e = deviation(s.at(i), s.at(i + 1), h);
+        if (e > tolerance && std::abs(h) > min_h)
+          split.emplace_back(e, i);
+      }
+
+      const int room = budget - int(t.size());
+      if (split.empty() || room <= 0)
+        break;
+
+      if (int(split.size()) > room)
+      {
+        std::nth_element(split.begin(), split.begin() + room, split.end(),
+                         [](const std::pair<T, int> &a, const std::pair<T, int> &b) { return a.first > b.first; });
+        split.resize(room);
+      }
+      std::sort(split.begin(), split.end(),
+                [](const std::pair<T, int> &a, const std::pair<T, int> &b) { return a.second < b.second; });
+
+      mid.resize(split.size());
+      for (size_t j = 0; j < split.size(); ++j)
+        mid[j] = T(0.5) * (t[split[j].second] + t[split[j].second + 1]);
+      eval(mid, dd, ms);
+
+      // Merge the midpoints in after the intervals they split
+      const int m = int(t.size()) + int(mid.size());
+      next_t.resize(m);
+      next_s.resize(m, dd);
+      int o = 0;
+      size_t j = 0;
+      for (int i = 0; i < int(t.size()); ++i)
+      {
+        next_t[o] = t[i];
+        std::copy(s.at(i), s.at(i) + s.stride(), next_s.at(o++));
+        if (j < split.size() && split[j].second == i)
+        {
+          next_t[o] = mid[j];
+          std::copy(ms.at(int(j)), ms.at(int(j)) + ms.stride(), next_s.at(o++));
+          ++j;
+        }
+      }
+      std::swap(t, next_t);
+      std::swap(s, next_s);
+    }
+
+    out.resize(int(t.size()), d);
+    for (int i = 0; i < out.samples; ++i)
+      std::copy(s.at(i), s.at(i) + out.stride(), out.at(i));
+  }
+
+private:
+  // Estimated distance between the chord a -> b and the curve over an interval of length h
+  static T deviation(const T *a, const T *b, T h)
+  {
+    T c[3], da[3], db[3], dt[3];
+    for (int k = 0; k < 3; ++k)
+    {
+      c[k]  = b[k] - a[k];
+      dt[k] = a[3 + k] - b[3 + k];
+      da[k] = a[6 + k];
+      db[k] = b[6 + k];
+    }
+
+    const T len2 = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+    const T hh   = h * h;
+    return std::max(std::abs(h) / T(8) * normal(dt, c, len2),
+                    hh / T(8) * std::max(normal(da, c, len2), normal(db, c, len2)));
+  }
+
+  // Length of the part of v normal to c
+  static T normal(const T *v, const T *c, T len2)
+  {
+    const T vv = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+    if (len2 <= T(0))
+      return std::sqrt(vv);
+
+    const T vc = v[0] * c[0] + v[1] * c[1] + v[2] * c[2];
+    return std::sqrt(std::max(T(0), vv - vc * vc / len2));
+  }
+};
+
+#endif // ADAPTIVE_SAMPLING_H
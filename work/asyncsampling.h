@@ -0,0 +1,262 @@
+#ifndef ASYNC_SAMPLING_H
+#define ASYNC_SAMPLING_H
+
+#include <core/containers/gmdvector.h>
+#include <parametrics/visualizers/gmpcurvevisualizer.h>
+
+#include "adaptivesampling.h"
+#include "curvesamples.h"
+#include "lodsampling.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <utility>
+
+/*!
+ *  AsyncReplottable
+ *
+ *  - Scene objects whose replot is split in two halves: prepareReplot() evaluates the
+ *    new geometry on a worker thread, commitReplot() hands it to the visualizers on the
+ *    GL thread. The previously uploaded geometry stays visible until the commit.
+ *  - coarsening > 0 asks for a quick preview with about 2^-coarsening of the samples,
+ *    which a scheduler follows up with a full-resolution pass.
+ */
+class AsyncReplottable
+{
+public:
+  virtual ~AsyncReplottable() = default;
+
+  virtual bool  asyncReplotEnabled() const = 0;
+  virtual void  prepareReplot( int coarsening = 0 ) = 0;  // Worker thread; no GL, no scene graph
+  virtual bool  commitReplot() = 0;                       // GL thread; false if nothing new was prepared
+
+  // Sample density follows a tolerance rather than a sample count
+  virtual bool  adaptiveSampling() const { return false; }
+};
+
+/*!
+ *  AsyncSampledCurve<Curve,T>
+ *
+ *  - CRTP mixin implementing AsyncReplottable for curves with a public
+ *    sampleBatch(CurveSamples<T,3>&, m, d) const.
+ *  - The worker fills a back buffer that is swapped in under a lock. On commit the
+ *    prepared samples are handed to the curve visualizers as they are, and the
+ *    surrounding sphere is set from them. Nothing is evaluated on the GL thread, and
+ *    GMlib's sample() with its own uniform grid is not involved.
+ *  - With setAdaptiveSampling() the worker runs AdaptiveSampling over the public
+ *    sampleAt(params, d, out) const of the curve instead. The visualizers get these
+ *    non-uniform samples in parameter order.
+ *  - The curve befriends its AsyncSampledCurve, which sets the surrounding sphere.
+ *  - With setLevelsOfDetail() each full replot also prepares adaptive levels of detail
+ *    relative to the size of the curve, committed together with the replot samples; see
+ *    LodSampledCurve.
+ *  - sampleBatch and sampleAt are run by one worker at a time per object; they must not
+ *    share scratch with eval(), which keeps running on the GL thread meanwhile. Buffers
+ *    rotate between worker, hand-off and GL side and keep their capacity, so replots of
+ *    about the same size allocate nothing.
+ */
+template <typename Curve, typename T>
+class AsyncSampledCurve : public AsyncReplottable, public LodSampledCurve
+{
+public:
+  AsyncSampledCurve() = default;
+
+  // Copies (GMlib makeCopy) keep the replot sampling but start without prepared samples or levels
+  AsyncSampledCurve(const AsyncSampledCurve &copy)
+      : AsyncReplottable(copy), LodSampledCurve(copy), _replot_m(copy._replot_m.load()), _replot_d(copy._replot_d.load()),
+        _tolerance(copy._tolerance.load()), _max_samples(copy._max_samples.load()), _initial(copy._initial.load()),
+        _lod_levels(copy._lod_levels.load()), _lod_finest(copy._lod_finest.load()) {}
+
+  // m samples with d derivatives per asynchronous replot; m < 1 disables it
+  void  setReplotSampling(int m, int d = 0) { _replot_m = m; _replot_d = d; }
+  int   getReplotSamples() const { return _replot_m; }
+
+  // Adaptive samples to a world-space chordal tolerance, which takes precedence over the
+  // sample count of setReplotSampling(); tolerance <= 0 returns to uniform sampling
+  void  setAdaptiveSampling(T tolerance, int max_samples = 4096, int initial = 32)
+  {
+    _max_samples = max_samples;
+    _initial     = initial;
+    _tolerance   = tolerance;
+  }
+  T     getAdaptiveTolerance() const { return _tolerance; }
+
+  // Levels of detail built with every full replot, the finest within finest times the
+  // radius of the curve; levels < 1 disables them
+  void  setLevelsOfDetail(int levels, T finest = T(1) / T(1024))
+  {
+    _lod_finest = finest;
+    _lod_levels = levels;
+  }
+
+  int   lodRevision() const override { return _lod_revision; }
+  int   lodLevelCount() const override { return int(_active_levels.size()); }
+  float lodTolerance(int level) const override { return float(_active_levels[level].tolerance); }
+  void  lodPositions(int level, std::vector<float> &xyz) const override
+  {
+    const auto &samples = _active_levels[level].samples;
+    xyz.resize(3 * size_t(samples.samples));
+    for (int i = 0; i < samples.samples; ++i)
+      for (int c = 0; c < 3; ++c)
+        xyz[3 * size_t(i) + c] = float(samples.at(i)[c]);
+  }
+
+  bool  asyncReplotEnabled() const override { return _replot_m > 0 || _tolerance > T(0); }
+  bool  adaptiveSampling() const override { return _tolerance > T(0); }
+
+  void prepareReplot(int coarsening = 0) override
+  {
+    const int d = _replot_d;
+    const T   tolerance = _tolerance;
+    if (tolerance > T(0))
+    {
+      // The deviation goes with h^2: each coarsening step about halves the samples
+      AdaptiveSampling<T> adaptive;
+      adaptive.tolerance   = std::ldexp(tolerance, 2 * std::min(std::max(coarsening, 0), 8));
+      adaptive.max_samples = _max_samples;
+      adaptive.initial     = _initial;
+
+      auto curve = static_cast<const Curve *>(this);
+      adaptive.sample([curve](const std::vector<T> &t, int dd, CurveSamples<T, 3> &out) { curve->sampleAt(t, dd, out); },
+                      curve->getParStart(), curve->getParEnd(), d, _work, _scratch);
+    }
+    else
+    {
+      int m = _replot_m;
+      if (m < 1)
+        return;
+      if (coarsening > 0)
+        m = std::max(std::min(m, 16), m >> std::min(coarsening, 30));
+
+      static_cast<const Curve *>(this)->sampleBatch(_work, m, d);
+    }
+
+    // Previews keep the levels of the last full replot
+    const bool levels = coarsening <= 0 && _lod_levels > 0;
+    if (levels)
+      prepareLevels();
+
+    std::lock_guard<std::mutex> lock(_handoff);
+    std::swap(_work, _pending);
+    _has_pending = true;
+    if (levels)
+    {
+      std::swap(_work_levels, _pending_levels);
+      _has_pending_levels = true;
+    }
+  }
+
+  bool commitReplot() override
+  {
+    {
+      std::lock_guard<std::mutex> lock(_handoff);
+      if (!_has_pending)
+        return false;
+      std::swap(_active, _pending);
+      _has_pending = false;
+      if (_has_pending_levels)
+      {
+        std::swap(_active_levels, _pending_levels);
+        _has_pending_levels = false;
+        ++_lod_revision;
+      }
+    }
+
+    const int m = _active.samples;
+    const int d = _active.derivatives;
+    if (m < 1)
+      return true;
+
+    // [sample][derivative], as GMlib's sample() hands them to the visualizers
+    _visualized.setDim(m);
+    for (int i = 0; i < m; ++i)
+    {
+      _visualized[i].setDim(d + 1);
+      for (int k = 0; k <= d; ++k)
+        _visualized[i][k] = _active.get(i, k);
+    }
+
+    auto curve = static_cast<Curve *>(this);
+    GMlib::Sphere<float, 3> sphere(point(0));
+    for (int i = 1; i < m; ++i)
+      sphere += point(i);
+    curve->setSurroundingSphere(sphere);
+
+    auto &visualizers = curve->getVisualizers();
+    for (int i = 0; i < visualizers.getSize(); ++i)
+      if (auto visualizer = dynamic_cast<GMlib::PCurveVisualizer<T, 3> *>(visualizers[i]))
+        visualizer->replot(_visualized, m, d, curve->isClosed());
+    return true;
+  }
+
+private:
+  GMlib::Point<float, 3> point(int i) const
+  {
+    const T *p = _active.at(i);
+    return GMlib::Point<float, 3>(float(p[0]), float(p[1]), float(p[2]));
+  }
+
+  struct Level
+  {
+    T                         tolerance {T(0)};
+    CurveSamples<T, 3>        samples;
+  };
+
+  // Levels from the size of the freshly prepared samples; worker side
+  void prepareLevels()
+  {
+    T centre[3] = {T(0), T(0), T(0)};
+    for (int i = 0; i < _work.samples; ++i)
+      for (int c = 0; c < 3; ++c)
+        centre[c] += _work.at(i)[c] / T(_work.samples);
+
+    T radius = T(0);
+    for (int i = 0; i < _work.samples; ++i)
+    {
+      const T *p = _work.at(i);
+      radius = std::max(radius, std::sqrt((p[0] - centre[0]) * (p[0] - centre[0]) +
+                                          (p[1] - centre[1]) * (p[1] - centre[1]) +
+                                          (p[2] - centre[2]) * (p[2] - centre[2])));
+    }
+
+    auto curve = static_cast<const Curve *>(this);
+    _work_levels.resize(radius > T(0) ? _lod_levels.load() : 0);
+    for (int l = 0; l < int(_work_levels.size()); ++l)
+    {
+      AdaptiveSampling<T> adaptive;
+      adaptive.tolerance   = std::ldexp(radius * _lod_finest, 2 * l);
+      adaptive.max_samples = _max_samples;
+      adaptive.initial     = std::max(4, _initial >> l);
+
+      _work_levels[l].tolerance = adaptive.tolerance;
+      adaptive.sample([curve](const std::vector<T> &t, int dd, CurveSamples<T, 3> &out) { curve->sampleAt(t, dd, out); },
+                      curve->getParStart(), curve->getParEnd(), 0, _work_levels[l].samples, _scratch);
+    }
+  }
+
+  std::atomic<int>            _replot_m {0};
+  std::atomic<int>            _replot_d {0};
+  std::atomic<T>              _tolerance   {T(0)};
+  std::atomic<int>            _max_samples {4096};
+  std::atomic<int>            _initial     {32};
+  std::atomic<int>            _lod_levels  {0};
+  std::atomic<T>              _lod_finest  {T(1) / T(1024)};
+
+  CurveSamples<T, 3>          _work;     // Worker side
+  typename AdaptiveSampling<T>::Scratch _scratch;   // Worker side; reused by every replot
+  CurveSamples<T, 3>          _pending;  // Guarded by _handoff
+  CurveSamples<T, 3>          _active;   // GL side
+  GMlib::DVector<GMlib::DVector<GMlib::Vector<T, 3>>> _visualized;   // GL side; _active for the visualizers
+  bool                        _has_pending {false};
+
+  std::vector<Level>          _work_levels;
+  std::vector<Level>          _pending_levels;
+  std::vector<Level>          _active_levels;
+  bool                        _has_pending_levels {false};
+  int                         _lod_revision {0};
+  std::mutex                  _handoff;
+};
+
+#endif // ASYNC_SAMPLING_H
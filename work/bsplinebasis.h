@@ -0,0 +1,273 @@
+#ifndef BSPLINE_BASIS_H
+#define BSPLINE_BASIS_H
+
+#include <core/containers/gmdvector.h>
+#include <core/containers/gmdmatrix.h>
+
+#include "dynamicdegree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Knot vector, span search and basis functions of a B-spline of degree K over scalar T,
+// without control points. MyB_spline evaluates through it, and the fitters and the tensor
+// product surface use it per direction without building a curve. K = DYNAMIC_DEGREE takes
+// the degree at run time; with a fixed K the scratch lives inline.
+template <typename T = float, int K = 2>
+class BSplineBasis {
+public:
+    // Scratch storage for the span-local basis evaluation; one per thread of evaluation.
+    // Tables are row-major with row length degree+1; ders holds rows 0..min(d, degree).
+    struct Scratch {
+        DegreeArray<T, degreeTableSize(K, 2)>                    ndu;
+        DegreeArray<T, degreeTableSize(K, 2)>                    ders;
+        DegreeArray<T, (K >= 0 ? 2 * (K + 1) : DYNAMIC_DEGREE)> a;
+        DegreeArray<T, degreeTableSize(K, 1)>                    left;
+        DegreeArray<T, degreeTableSize(K, 1)>                    right;
+    };
+
+    int getDegree() const { return K >= 0 ? K : _degree; }
+    int getControlPointCount() const { return _n; }
+    const GMlib::DVector<T>& getKnots() const { return _knots; }
+
+    // Bumped whenever the knots change, for caches keyed on them
+    int getRevision() const { return _revision; }
+
+    // A fixed degree only accepts itself; a dynamic one any non-negative degree
+    void setDegree(int degree);
+
+    // Clamped uniform knots for n control points
+    void setUniformKnots(int n);
+
+    // Given non-decreasing knots for n control points, n + degree + 1 of them
+    void setKnots(int n, const GMlib::DVector<T>& knots);
+
+    T getStartP() const { return _knots[getDegree()]; }                        // First non-repeated knot
+    T getEndP() const { return _knots[_knots.getDim() - 1 - getDegree()]; }    // Last non-repeated knot
+
+    // Parameter of point i of m spread uniformly over the domain
+    T uniformParameter(int i, int m) const;
+
+    int  findSpan(T t) const;
+
+    // Span of t from a span at or below it, for parameters walked in increasing order
+    int  advanceSpan(int span, T t) const {
+        while (span < _n - 1 && t >= _knots[span + 1])
+            ++span;
+        return span;
+    }
+
+    void evaluateDerivatives(int span, T t, int d, Scratch& s) const;
+
+    static void solveBanded(GMlib::DMatrix<double>& A, GMlib::DVector<GMlib::Vector<double,3>>& b);
+
+private:
+    int               _degree   {K >= 0 ? K : 2};   // Only read for DYNAMIC_DEGREE
+    int               _n        {0};
+    int               _revision {0};
+    GMlib::DVector<T> _knots;
+};
+
+template <typename T, int K>
+void BSplineBasis<T,K>::setDegree(int degree) {
+    if (degree < 0 || (K >= 0 && degree != K))
+        throw std::invalid_argument("BSplineBasis: degree does not match the template degree");
+    _degree = degree;
+}
+
+template <typename T, int K>
+void BSplineBasis<T,K>::setUniformKnots(int n) {
+    const int k = getDegree(); // Degree
+    const int m = n + k + 1;   // Number of knots
+
+    if (n <= k)
+        throw std::invalid_argument("BSplineBasis: need more than degree control points");
+
+    ++_revision;
+    _n = n;
+    _knots.setDim(m);
+
+    // First k+1 knots are 0
+    for (int i = 0; i <= k; ++i)
+        _knots[i] = T(0);
+
+    // Middle knots are uniformly spaced
+    for (int i = k + 1; i < m - (k + 1); ++i)
+        _knots[i] = static_cast<T>(i - k);
+
+    // Last k+1 knots are max value
+    const T maxValue = static_cast<T>(m - 2 * (k + 1) + 1);
+    for (int i = m - (k + 1); i < m; ++i)
+        _knots[i] = maxValue;
+}
+
+template <typename T, int K>
+void BSplineBasis<T,K>::setKnots(int n, const GMlib::DVector<T>& knots) {
+    const int k = getDegree();
+
+    if (n <= k)
+        throw std::invalid_argument("BSplineBasis: need more than degree control points");
+    if (knots.getDim() != n + k + 1)
+        throw std::invalid_argument("BSplineBasis: need control points + degree + 1 knots");
+    for (int i = 1; i < knots.getDim(); ++i)
+        if (knots[i] < knots[i - 1])
+            throw std::invalid_argument("BSplineBasis: knot vectors must be non-decreasing");
+    if (!(knots[k] < knots[n]))
+        throw std::invalid_argument("BSplineBasis: empty parameter domain");
+
+    ++_revision;
+    _n     = n;
+    _knots = knots;
+}
+
+template <typename T, int K>
+T BSplineBasis<T,K>::uniformParameter(int i, int m) const {
+    const T start = getStartP();
+    const T end   = getEndP();
+    return (i == m - 1) ? end : start + (end - start) * static_cast<T>(i) / (m - 1);
+}
+
+// Find the knot span index i such that t lies in [t_i, t_{i+1}); binary search, O(log n)
+template <typename T, int K>
+int BSplineBasis<T,K>::findSpan(T t) const {
+    const int n = _n;
+    const int p = getDegree();
+
+    // Special cases: clamp to the first and the last non-empty span
+    if( t >= _knots[n] )
+        return n - 1;
+    if( t <= _knots[p] )
+        return p;
+
+    int low  = p;
+    int high = n;
+    int mid  = (low + high) / 2;
+    while( t < _knots[mid] || t >= _knots[mid + 1] ) {
+        if( t < _knots[mid] )
+            high = mid;
+        else
+            low = mid;
+        mid = (low + high) / 2;
+    }
+    return mid;
+}
+
+// Compute the degree+1 nonzero basis functions on the given span and their derivatives
+// up to order min(d, degree) (The NURBS Book, A2.3). Result is stored row-major in s.ders:
+// s.ders[k*(degree+1) + j] is the k-th derivative of N_{span-degree+j}. Derivatives above
+// the degree vanish and are left to the caller. For a fixed K every bound here is constant.
+template <typename T, int K>
+void BSplineBasis<T,K>::evaluateDerivatives(int span, T t, int d, Scratch& s) const {
+    const int p  = getDegree();
+    const int w  = p + 1;
+    const int nd = std::min(d, p);
+
+    s.ndu.resize(size_t(w) * w);
+    s.ders.resize(size_t(w) * w);
+    s.a.resize(2 * size_t(w));
+    s.left.resize(w);
+    s.right.resize(w);
+
+    T* ndu = s.ndu.data();
+    T* ders = s.ders.data();
+    T* a[2] = { s.a.data(), s.a.data() + w };
+
+    // Basis functions and knot differences
+    ndu[0] = T(1);
+    for( int j = 1; j <= p; ++j ) {
+        s.left[j]  = t - _knots[span + 1 - j];
+        s.right[j] = _knots[span + j] - t;
+        T saved = T(0);
+        for( int r = 0; r < j; ++r ) {
+            // Lower triangle
+            ndu[j * w + r] = s.right[r + 1] + s.left[j - r];
+            T temp = ndu[r * w + j - 1] / ndu[j * w + r];
+            // Upper triangle
+            ndu[r * w + j] = saved + s.right[r + 1] * temp;
+            saved = s.left[j - r] * temp;
+        }
+        ndu[j * w + j] = saved;
+    }
+
+    for( int j = 0; j <= p; ++j )
+        ders[j] = ndu[j * w + p];
+
+    // Derivatives
+    for( int r = 0; r <= p; ++r ) {
+        int s1 = 0, s2 = 1;
+        a[0][0] = T(1);
+        for( int k = 1; k <= nd; ++k ) {
+            T dd = T(0);
+            int rk = r - k;
+            int pk = p - k;
+            if( r >= k ) {
+                a[s2][0] = a[s1][0] / ndu[(pk + 1) * w + rk];
+                dd = a[s2][0] * ndu[rk * w + pk];
+            }
+            int j1 = (rk >= -1) ? 1 : -rk;
+            int j2 = (r - 1 <= pk) ? k - 1 : p - r;
+            for( int j = j1; j <= j2; ++j ) {
+                a[s2][j] = (a[s1][j] - a[s1][j - 1]) / ndu[(pk + 1) * w + rk + j];
+                dd += a[s2][j] * ndu[(rk + j) * w + pk];
+            }
+            if( r <= pk ) {
+                a[s2][k] = -a[s1][k - 1] / ndu[(pk + 1) * w + r];
+                dd += a[s2][k] * ndu[r * w + pk];
+            }
+            ders[k * w + r] = dd;
+            std::swap(s1, s2);
+        }
+    }
+
+    // Multiply through by the correct factors p!/(p-k)!
+    T fac = static_cast<T>(p);
+    for( int k = 1; k <= nd; ++k ) {
+        for( int j = 0; j <= p; ++j )
+            ders[k * w + j] *= fac;
+        fac *= static_cast<T>(p - k);
+    }
+}
+
+// Solve A x = b in place for a symmetric positive definite band matrix A stored as
+// A[i][j] = A(i, i+j). A is overwritten by its Cholesky factor U (A = U^T U), b by x.
+template <typename T, int K>
+void BSplineBasis<T,K>::solveBanded(GMlib::DMatrix<double>& A, GMlib::DVector<GMlib::Vector<double,3>>& b) {
+    const int n  = A.getDim1();
+    const int bw = A.getDim2() - 1;
+
+    // Factorization
+    for (int i = 0; i < n; ++i) {
+        const int jmax = std::min(i + bw, n - 1);
+        for (int j = i; j <= jmax; ++j) {
+            double sum = A[i][j - i];
+            for (int l = std::max(0, j - bw); l < i; ++l)
+                sum -= A[l][i - l] * A[l][j - l];
+
+            if (j == i) {
+                if (sum <= 0.0)
+                    throw std::runtime_error("BSplineBasis::solveBanded: normal equations are not positive definite");
+                A[i][0] = std::sqrt(sum);
+            }
+            else
+                A[i][j - i] = sum / A[i][0];
+        }
+    }
+
+    // Forward substitution: U^T y = b
+    for (int i = 0; i < n; ++i) {
+        for (int l = std::max(0, i - bw); l < i; ++l)
+            b[i] -= A[l][i - l] * b[l];
+        b[i] *= 1.0 / A[i][0];
+    }
+
+    // Back substitution: U x = y
+    for (int i = n - 1; i >= 0; --i) {
+        const int jmax = std::min(i + bw, n - 1);
+        for (int j = i + 1; j <= jmax; ++j)
+            b[i] -= A[i][j - i] * b[j];
+        b[i] *= 1.0 / A[i][0];
+    }
+}
+
+#endif // BSPLINE_BASIS_H
@@ -4,125 +4,594 @@
 #include <parametrics/gmpcurve.h>
 #include <core/containers/gmdvector.h>
 
-class ClosedSubdivisionCurve : public GMlib::PCurve<float, 3>
+#include "asyncsampling.h"
+#include "curvesamples.h"
+#include "dynamicdegree.h"
+#include "gpuevaluation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*!
+ *  ClosedSubdivisionCurve<T,K>
+ *
+ *  - Closed Lane-Riesenfeld subdivision curve of degree K over scalar T. The default
+ *    K = DYNAMIC_DEGREE takes the degree from the constructor; a fixed K gives inline
+ *    scratch and constant loop bounds in the limit evaluation and the averaging passes.
+ */
+template <typename T = float, int K = DYNAMIC_DEGREE>
+class ClosedSubdivisionCurve : public GMlib::PCurve<T, 3>, public AsyncSampledCurve<ClosedSubdivisionCurve<T, K>, T>, public GpuEvaluableCurve
 {
   GM_SCENEOBJECT(ClosedSubdivisionCurve)
 
 public:
   // Constructor
-  ClosedSubdivisionCurve(const GMlib::DVector<GMlib::Vector<float, 3>> &controlPts, int degree)
-      : _controlPoints(controlPts), _degree(degree)
+  ClosedSubdivisionCurve(const GMlib::DVector<GMlib::Vector<T, 3>> &controlPts, int degree = K)
+      : _controlPoints(controlPts), _degree(degree), _activeLevel(AutomaticLevel), _sampledLevel(degree)
   {
 
+    if (degree < 0 || (K >= 0 && degree != K))
+      throw std::invalid_argument("ClosedSubdivisionCurve: degree does not match the template degree");
+
     // Constrain the parametric domain to [0, 1]
-    this->setDomain(0.0f, 1.0f);
+    this->setDomain(T(0), T(1));
 
-    // Compute subdivided points
-    laneRiesenfeldSubdivision();
+    // Subdivision levels are computed on first use; only the control polygon is stored now
+    initializeLevels();
+  }
+
+  // Copy constructor (GMlib makeCopy); the copy builds its own levels
+  ClosedSubdivisionCurve(const ClosedSubdivisionCurve &copy)
+      : GMlib::PCurve<T, 3>(copy), AsyncSampledCurve<ClosedSubdivisionCurve<T, K>, T>(copy), GpuEvaluableCurve(copy),
+        _controlPoints(copy._controlPoints), _degree(copy._degree), _activeLevel(copy._activeLevel.load()),
+        _sampledLevel(copy._sampledLevel.load()), _mode(copy._mode)
+  {
+    initializeLevels();
   }
 
   // Destructor
   ~ClosedSubdivisionCurve() override = default;
 
+  // Limit curves are evaluated in closed form; the subdivided polyline is kept for previews
+  enum EvaluationMode
+  {
+    LimitCurve,
+    Polyline
+  };
+
   // PCurve interface overrides
-  void eval(float t, int d, bool left = true) const override;
-  float getStartP() const override { return 0.0f; }
-  float getEndP() const override { return 1.0f; }
+  void eval(T t, int d, bool left = true) const override;
+  T getStartP() const override { return T(0); }
+  T getEndP() const override { return T(1); }
   bool isClosed() const override { return true; } // Mark as closed
 
+  int getDegree() const { return K >= 0 ? K : _degree; }
+
+  // Level of detail: level L is the polyline after L subdivision steps (n * 2^L points).
+  // By default the level follows the sample count of each batch; the setters fix one
+  static constexpr int AutomaticLevel = -1;
+  int getMaxLevel() const { return getDegree(); }
+  int getActiveLevel() const { return _activeLevel >= 0 ? _activeLevel.load() : _sampledLevel.load(); }
+  bool isAutomaticLevel() const { return _activeLevel < 0; }
+  void setActiveLevel(int level);
+  void setAutomaticLevel() { _activeLevel = AutomaticLevel; }
+  void setSampleCount(int m);
+  void setTolerance(T tolerance);
+  const GMlib::DVector<GMlib::Vector<T, 3>> &getLevel(int level) const;
+
+  EvaluationMode getEvaluationMode() const { return _mode; }
+  void setEvaluationMode(EvaluationMode mode) { _mode = mode; }
+
+  // Batched sampling of the current evaluation mode; safe on a replot worker
+  void sampleBatch(CurveSamples<T, 3> &out, int m, int d) const;
+  void sampleAt(const std::vector<T> &t, int d, CurveSamples<T, 3> &out) const;
+
+  // The limit curve is a periodic uniform B-spline on the control polygon; none in Polyline mode
+  bool gpuBSplineForm(GpuBSplineForm &form) const override;
+  void gpuEvaluated() override;
+
 private:
-  GMlib::DVector<GMlib::Vector<float, 3>> _controlPoints; // Original control polygon
-  mutable GMlib::DVector<GMlib::Vector<float, 3>> _subdividedPoints;
-  int _degree;
+  friend class AsyncSampledCurve<ClosedSubdivisionCurve<T, K>, T>;
 
-  void laneRiesenfeldSubdivision();
+  GMlib::DVector<GMlib::Vector<T, 3>> _controlPoints; // Original control polygon
+  int _degree; // Only read for DYNAMIC_DEGREE
+  std::atomic<int> _activeLevel; // Read by replot workers; AutomaticLevel: chosen per batch
+  mutable std::atomic<int> _sampledLevel; // Level of the last automatic batch, used by eval()
+  T _polygonDeviation {T(0)}; // Max second difference of the control polygon
+  EvaluationMode _mode {LimitCurve};
+
+  // Scratch storage for the closed-form evaluation; eval() owns one, each batch its own
+  struct LimitScratch
+  {
+    DegreeArray<T, degreeTableSize(K, 2)> basis;
+    DegreeArray<GMlib::Vector<T, 3>, degreeTableSize(K, 1)> local;
+  };
+  mutable LimitScratch _limit;
+
+  // Lazily built subdivision pyramid; raw levels feed the next step, closed levels are evaluated.
+  // Built under _levelMutex by whichever thread asks first; a built level is never changed again
+  mutable std::vector<std::vector<T>> _rawLevels;
+  mutable std::vector<GMlib::DVector<GMlib::Vector<T, 3>>> _levels;
+  mutable std::vector<T> _scratch;
+  mutable std::mutex _levelMutex;
+
+  void evalLimit(T t, int d, LimitScratch &scratch, GMlib::Vector<T, 3> *out) const;
+  void evalPolyline(const GMlib::DVector<GMlib::Vector<T, 3>> &points, T t, int d, GMlib::Vector<T, 3> *out) const;
+  void initializeLevels();
+  int levelForSamples(int m) const;
+  const GMlib::DVector<GMlib::Vector<T, 3>> &batchLevel(int m) const;
+  void buildLevel(int level) const;
+  void laneRiesenfeldStep(const std::vector<T> &in, std::vector<T> &out) const;
 };
 
 /*!
- *  eval(float t, int d, bool left) const
+ *  initializeLevels()
  *
- *  - Maps t in [0,1] to an index in _subdividedPoints.
- *  - Interpolates linearly between discrete points for a smooth curve.
- *  - Approximates the first derivative by finite differences if requested.
+ *  - Stores the control polygon as level 0 and measures its second differences,
+ *    which bound the distance between a level's polyline and the limit curve.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::initializeLevels()
+{
+
+  const int n = _controlPoints.getDim();
+
+  _rawLevels.assign(getDegree() + 1, std::vector<T>());
+  _levels.assign(getDegree() + 1, GMlib::DVector<GMlib::Vector<T, 3>>());
+
+  _rawLevels[0].resize(3 * static_cast<size_t>(n));
+  for (int i = 0; i < n; ++i)
+    for (int c = 0; c < 3; ++c)
+      _rawLevels[0][3 * i + c] = _controlPoints[i][c];
+
+  _polygonDeviation = T(0);
+  for (int i = 0; i < n; ++i)
+  {
+    const GMlib::Vector<T, 3> dd = _controlPoints[(i + n - 1) % n] - T(2) * _controlPoints[i] + _controlPoints[(i + 1) % n];
+    _polygonDeviation = std::max(_polygonDeviation, dd.getLength());
+  }
+}
+
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::setActiveLevel(int level)
+{
+  _activeLevel = std::max(0, std::min(level, getDegree()));
+}
+
+/*!
+ *  setSampleCount(int m)
+ *
+ *  - Fixes the level to the coarsest one with at least m points.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::setSampleCount(int m)
+{
+  setActiveLevel(levelForSamples(m));
+}
+
+/*!
+ *  levelForSamples(int m) const
+ *
+ *  - The coarsest level with at least m points; finer ones add nothing m samples show.
  */
-void ClosedSubdivisionCurve::eval(float t, int d, bool /*left*/) const
+template <typename T, int K>
+int ClosedSubdivisionCurve<T, K>::levelForSamples(int m) const
+{
+  int level = 0;
+  while (level < getDegree() && (static_cast<long long>(_controlPoints.getDim()) << level) < m)
+    ++level;
+
+  return level;
+}
+
+/*!
+ *  batchLevel(int m) const
+ *
+ *  - The polyline a batch of m samples is taken from: the fixed level, or with
+ *    AutomaticLevel the coarsest that meets m. That level is then also the one eval()
+ *    interpolates, so GMlib's own sampling matches the last batch.
+ */
+template <typename T, int K>
+const GMlib::DVector<GMlib::Vector<T, 3>> &ClosedSubdivisionCurve<T, K>::batchLevel(int m) const
+{
+  int level = _activeLevel;
+  if (level < 0)
+  {
+    level = levelForSamples(m);
+    _sampledLevel = level;
+  }
+
+  return getLevel(level);
+}
+
+/*!
+ *  setTolerance(T tolerance)
+ *
+ *  - Selects the coarsest level whose estimated deviation from the limit curve is below
+ *    tolerance. Second differences shrink by a factor 4 per step, so no level is built.
+ *  - For a screen-space tolerance pass the world-space size of the allowed pixel error.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::setTolerance(T tolerance)
+{
+  int level = 0;
+  T deviation = _polygonDeviation;
+  while (level < getDegree() && deviation > tolerance)
+  {
+    deviation *= T(0.25);
+    ++level;
+  }
+
+  setActiveLevel(level);
+}
+
+/*!
+ *  getLevel(int level) const
+ *
+ *  - Returns the closed polyline of the given level, computing it (and any coarser
+ *    level it depends on) on first request.
+ *  - Thread safe: the GL thread and a replot worker may ask at the same time. The
+ *    returned level is complete and stays unchanged, so it is read without the lock.
+ */
+template <typename T, int K>
+const GMlib::DVector<GMlib::Vector<T, 3>> &ClosedSubdivisionCurve<T, K>::getLevel(int level) const
+{
+  level = std::max(0, std::min(level, getDegree()));
+
+  std::lock_guard<std::mutex> lock(_levelMutex);
+  if (_levels[level].getDim() == 0)
+    buildLevel(level);
+
+  return _levels[level];
+}
+
+/*!
+ *  eval(T t, int d, bool left) const
+ *
+ *  - Dispatches on the evaluation mode: the exact limit curve (default) or the
+ *    subdivided polyline of the active level; see getActiveLevel().
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::eval(T t, int d, bool /*left*/) const
 {
 
   // Ensure _p has space for position + derivatives
   this->_p.setDim(d + 1);
 
-  // Map t to [0, _subdividedPoints.getDim() - 1]
-  float scaled_t = t * (_subdividedPoints.getDim() - 1);
-  int index = static_cast<int>(std::floor(scaled_t)) % _subdividedPoints.getDim();
-  float alpha = scaled_t - index; // Fractional part for interpolation
+  if (_mode == LimitCurve)
+    evalLimit(t, d, _limit, &this->_p[0]);
+  else
+    evalPolyline(getLevel(getActiveLevel()), t, d, &this->_p[0]);
+}
 
-  // Interpolate between index and index+1 for a smooth result
-  GMlib::Vector<float, 3> p1 = _subdividedPoints[index];
-  GMlib::Vector<float, 3> p2 = _subdividedPoints[(index + 1) % _subdividedPoints.getDim()];
+/*!
+ *  sampleBatch(CurveSamples<T,3>& out, int m, int d) const
+ *
+ *  - m uniform samples over [0,1] with d derivatives, in the current evaluation mode.
+ *  - Uses batch-local limit scratch, so it may run on a replot worker while eval()
+ *    serves the GL thread. In Polyline mode the level is picked once per batch from m
+ *    (see batchLevel()) and built under the level lock if needed.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::sampleBatch(CurveSamples<T, 3> &out, int m, int d) const
+{
 
-  this->_p[0] = (1.0f - alpha) * p1 + alpha * p2;
+  if (m < 1)
+    return;
+  out.resize(m, d);
 
-  // Approximate the first derivative if d > 0
-  if (d > 0)
+  const bool limit = _mode == LimitCurve;
+  const GMlib::DVector<GMlib::Vector<T, 3>> *points = limit ? nullptr : &batchLevel(m);
+
+  LimitScratch scratch;
+  std::vector<GMlib::Vector<T, 3>> p(d + 1);
+  for (int i = 0; i < m; ++i)
   {
-    int next = (index + 1) % _subdividedPoints.getDim();
-    int prev = (index - 1 + _subdividedPoints.getDim()) % _subdividedPoints.getDim();
-    this->_p[1] = (_subdividedPoints[next] - _subdividedPoints[prev]) * 0.5f;
+    const T t = (m > 1) ? T(i) / T(m - 1) : T(0);
+    if (limit)
+      evalLimit(t, d, scratch, p.data());
+    else
+      evalPolyline(*points, t, d, p.data());
+
+    for (int k = 0; k <= d; ++k)
+      for (int c = 0; c < 3; ++c)
+        out.at(i, k)[c] = p[k][c];
   }
 }
 
 /*!
- *  laneRiesenfeldSubdivision()
+ *  sampleAt(const std::vector<T>& t, int d, CurveSamples<T,3>& out) const
  *
- *  - Implements the standard Lane-Riesenfeld algorithm for a closed curve.
- *  - After generating the new points, the *last* point is forced to match the *first*,
- *    ensuring perfect closure in 3D (no visible gap).
+ *  - Samples at the given parameters for adaptive sampling, otherwise as sampleBatch.
  */
-void ClosedSubdivisionCurve::laneRiesenfeldSubdivision()
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::sampleAt(const std::vector<T> &t, int d, CurveSamples<T, 3> &out) const
 {
 
-  // Copy the original control points
-  GMlib::DVector<GMlib::Vector<float, 3>> points = _controlPoints;
+  out.resize(int(t.size()), d);
+
+  const bool limit = _mode == LimitCurve;
+  const GMlib::DVector<GMlib::Vector<T, 3>> *points = limit ? nullptr : &batchLevel(int(t.size()));
 
-  // Perform Lane-Riesenfeld subdivision _degree_ times
-  for (int iter = 0; iter < _degree; ++iter)
+  LimitScratch scratch;
+  std::vector<GMlib::Vector<T, 3>> p(d + 1);
+  for (int i = 0; i < out.samples; ++i)
   {
+    if (limit)
+      evalLimit(t[i], d, scratch, p.data());
+    else
+      evalPolyline(*points, t[i], d, p.data());
+
+    for (int k = 0; k <= d; ++k)
+      for (int c = 0; c < 3; ++c)
+        out.at(i, k)[c] = p[k][c];
+  }
+}
+
+/*!
+ *  evalLimit(T t, int d, LimitScratch& scratch, Vector<T,3>* out) const
+ *
+ *  - The Lane-Riesenfeld limit of degree p is the uniform periodic B-spline of
+ *    that degree over _controlPoints; t in [0,1] maps to s = 1 + t*n (mod n).
+ *  - Basis functions of every degree 0..p are built in one triangle on the span;
+ *    the k-th derivative is the degree (p-k) curve of the k-th differences of the
+ *    local control points, scaled by n^k for the [0,1] parametrisation.
+ *  - No subdivision is performed, so cost and memory are independent of the level.
+ *  - Writes d+1 vectors to out.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::evalLimit(T t, int d, LimitScratch &scratch, GMlib::Vector<T, 3> *out) const
+{
+
+  const int n = _controlPoints.getDim();
+  const int p = getDegree();
+  const int w = p + 1;
 
-    int numPoints = points.getDim();
-    GMlib::DVector<GMlib::Vector<float, 3>> newPoints(2 * numPoints, GMlib::Vector<float, 3>(0.0f, 0.0f, 0.0f));
+  // Map t to the periodic knot domain [0, n)
+  T s = std::fmod(T(1) + t * n, static_cast<T>(n));
+  if (s < T(0))
+    s += n;
+  int span = static_cast<int>(std::floor(s));
+  if (span >= n)
+    span -= n;
+  const T u = s - span;
 
-    // 1. Insert midpoints
-    for (int i = 0; i < numPoints; ++i)
+  // Basis triangle: basis[q*w + j] is the j-th nonzero degree-q basis function on the span
+  auto &basis = scratch.basis;
+  auto &local = scratch.local;
+  basis.resize(static_cast<size_t>(w) * w);
+  basis[0] = T(1);
+  for (int q = 1; q <= p; ++q)
+  {
+    const T *prev = &basis[(q - 1) * w];
+    T *curr = &basis[q * w];
+    T saved = T(0);
+    for (int r = 0; r < q; ++r)
     {
-      newPoints[2 * i] = points[i];
-      int nxt = (i + 1) % numPoints; // wrap around
-      newPoints[2 * i + 1] = (points[i] + points[nxt]) * 0.5f;
+      // Uniform knots: right + left = q for every r
+      const T temp = prev[r] / q;
+      curr[r] = saved + (r + 1 - u) * temp;
+      saved = (u + q - r - 1) * temp;
     }
+    curr[q] = saved;
+  }
+
+  // Local control points P_{span-p} .. P_span (periodic)
+  local.resize(w);
+  for (int j = 0; j < w; ++j)
+    local[j] = _controlPoints[((span - p + j) % n + n) % n];
 
-    // 2. Perform averaging passes
-    for (int avg = 1; avg < _degree; ++avg)
+  T scale = T(1);
+  for (int k = 0; k <= d; ++k)
+  {
+    const int q = p - k;
+    if (q < 0)
     {
-      GMlib::DVector<GMlib::Vector<float, 3>> smoothedPoints(newPoints.getDim(), GMlib::Vector<float, 3>(0.0f, 0.0f, 0.0f));
-      for (int i = 0; i < newPoints.getDim(); ++i)
-      {
-        int prev = (i - 1 + newPoints.getDim()) % newPoints.getDim();
-        smoothedPoints[i] = (newPoints[i] + newPoints[prev]) * 0.5f;
-      }
-      newPoints = smoothedPoints;
+      out[k] = GMlib::Vector<T, 3>(T(0), T(0), T(0));
+      continue;
     }
 
-    points = newPoints; // Update points after each iteration
+    GMlib::Vector<T, 3> sum(T(0), T(0), T(0));
+    for (int j = 0; j <= q; ++j)
+      sum += basis[q * w + j] * local[j];
+    out[k] = scale * sum;
+
+    // Next derivative: differences of the local control points
+    for (int j = 0; j < q; ++j)
+      local[j] = local[j + 1] - local[j];
+    scale *= static_cast<T>(n);
+  }
+}
+
+/*!
+ *  evalPolyline(points, T t, int d, Vector<T,3>* out) const
+ *
+ *  - Maps t in [0,1] to an index in points, the polyline of the active level.
+ *  - Interpolates linearly between discrete points for a smooth curve.
+ *  - Approximates the first derivative by finite differences if requested;
+ *    higher derivatives of the polyline are zero.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::evalPolyline(const GMlib::DVector<GMlib::Vector<T, 3>> &points, T t, int d,
+                                                GMlib::Vector<T, 3> *out) const
+{
+
+  // Map t to [0, points.getDim() - 1]
+  T scaled_t = t * (points.getDim() - 1);
+  int index = static_cast<int>(std::floor(scaled_t)) % points.getDim();
+  T alpha = scaled_t - index; // Fractional part for interpolation
+
+  // Interpolate between index and index+1 for a smooth result
+  GMlib::Vector<T, 3> p1 = points[index];
+  GMlib::Vector<T, 3> p2 = points[(index + 1) % points.getDim()];
+
+  out[0] = (T(1) - alpha) * p1 + alpha * p2;
+
+  // Approximate the first derivative if d > 0 (per unit t, i.e. scaled by the point count)
+  if (d > 0)
+  {
+    int next = (index + 1) % points.getDim();
+    int prev = (index - 1 + points.getDim()) % points.getDim();
+    out[1] = (points[next] - points[prev]) * (T(0.5) * (points.getDim() - 1));
   }
 
-  // Store final subdivided points
-  _subdividedPoints = points;
+  for (int k = 2; k <= d; ++k)
+    out[k] = GMlib::Vector<T, 3>(T(0), T(0), T(0));
+}
+
+/*!
+ *  buildLevel(int level) const
+ *
+ *  - Runs the Lane-Riesenfeld steps from the finest raw level built so far up to level.
+ *  - After generating the new points, the *last* point is forced to match the *first*,
+ *    ensuring perfect closure in 3D (no visible gap). Only the evaluated copy is closed;
+ *    the raw level stays untouched for further subdivision.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::buildLevel(int level) const
+{
+
+  int built = level;
+  while (built > 0 && _rawLevels[built].empty())
+    --built;
+
+  for (int l = built + 1; l <= level; ++l)
+    laneRiesenfeldStep(_rawLevels[l - 1], _rawLevels[l]);
+
+  const std::vector<T> &raw = _rawLevels[level];
+  const int numPoints = static_cast<int>(raw.size() / 3);
+
+  GMlib::DVector<GMlib::Vector<T, 3>> &points = _levels[level];
+  points.setDim(numPoints);
+  for (int i = 0; i < numPoints; ++i)
+    points[i] = GMlib::Vector<T, 3>(raw[3 * i], raw[3 * i + 1], raw[3 * i + 2]);
 
   // Force the last point to match the first point, ensuring no gap
   // (only if we have at least 2 points)
-  if (_subdividedPoints.getDim() > 1)
+  if (numPoints > 1)
   {
-    _subdividedPoints[_subdividedPoints.getDim() - 1] = _subdividedPoints[0];
+    points[numPoints - 1] = points[0];
   }
 }
 
+/*!
+ *  laneRiesenfeldStep(const std::vector<T>& in, std::vector<T>& out) const
+ *
+ *  - One step of the standard Lane-Riesenfeld algorithm for a closed curve on flat
+ *    xyz buffers: midpoint doubling followed by degree-1 averaging passes.
+ *  - The passes ping-pong between out and a scratch buffer that is only grown when
+ *    a finer level than before is requested. Called with _levelMutex held.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::laneRiesenfeldStep(const std::vector<T> &in, std::vector<T> &out) const
+{
+
+  const size_t numPoints = in.size() / 3;
+  if (numPoints < 1)
+  {
+    out.clear();
+    return;
+  }
+
+  const size_t len = 6 * numPoints;
+  out.resize(len);
+  if (_scratch.size() < len)
+    _scratch.resize(len);
+
+  const T *src = in.data();
+  T *dst = out.data();
+  T *tmp = _scratch.data();
+
+  // 1. Insert midpoints (wrap around at the end)
+  const size_t last = 3 * (numPoints - 1);
+  for (size_t i = 0; i < last; i += 3)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      dst[2 * i + c]     = src[i + c];
+      dst[2 * i + 3 + c] = (src[i + c] + src[i + 3 + c]) * T(0.5);
+    }
+  }
+  for (int c = 0; c < 3; ++c)
+  {
+    dst[2 * last + c]     = src[last + c];
+    dst[2 * last + 3 + c] = (src[last + c] + src[c]) * T(0.5);
+  }
+
+  // 2. Perform averaging passes: p_i = (p_i + p_{i-1}) / 2
+  T *a = dst;
+  T *b = tmp;
+  for (int avg = 1; avg < getDegree(); ++avg)
+  {
+    for (int c = 0; c < 3; ++c)
+      b[c] = (a[c] + a[len - 3 + c]) * T(0.5);
+    for (size_t j = 3; j < len; ++j)
+      b[j] = (a[j] + a[j - 3]) * T(0.5);
+    std::swap(a, b);
+  }
+
+  if (a != dst)
+    std::copy(a, a + len, dst);
+}
+
+/*!
+ *  gpuBSplineForm(GpuBSplineForm& form) const
+ *
+ *  - The control polygon unrolled to n + p points Q_j = P_{(j-p) mod n} over the
+ *    integer knots -p .. n+p; s = 1 + n t wraps with period n, as in evalLimit().
+ */
+template <typename T, int K>
+bool ClosedSubdivisionCurve<T, K>::gpuBSplineForm(GpuBSplineForm &form) const
+{
+
+  if (_mode != LimitCurve)
+    return false;
+
+  const int n = _controlPoints.getDim();
+  const int p = getDegree();
+
+  form.degree = p;
+  form.knots.resize(static_cast<size_t>(n + 2 * p + 1));
+  for (int i = 0; i < n + 2 * p + 1; ++i)
+    form.knots[i] = static_cast<float>(i - p);
+
+  form.points.resize(static_cast<size_t>(n + p));
+  for (int j = 0; j < n + p; ++j)
+  {
+    const GMlib::Vector<T, 3> &c = _controlPoints[((j - p) % n + n) % n];
+    form.points[j] = GMlib::Vector<float, 3>(float(c[0]), float(c[1]), float(c[2]));
+  }
+
+  form.start  = 0.0f;
+  form.end    = 1.0f;
+  form.scale  = static_cast<float>(n);
+  form.offset = 1.0f;
+  form.period = static_cast<float>(n);
+  return true;
+}
+
+/*!
+ *  gpuEvaluated()
+ *
+ *  - The limit curve lies in the convex hull of the control polygon; its bounding sphere
+ *    stands in for the one a replot would compute from the samples.
+ */
+template <typename T, int K>
+void ClosedSubdivisionCurve<T, K>::gpuEvaluated()
+{
+
+  auto point = [this](int j) {
+    return GMlib::Point<float, 3>(float(_controlPoints[j][0]), float(_controlPoints[j][1]), float(_controlPoints[j][2]));
+  };
+  GMlib::Sphere<float, 3> hull(point(0));
+  for (int j = 1; j < _controlPoints.getDim(); ++j)
+    hull += point(j);
+  this->setSurroundingSphere(hull);
+}
+
 #endif // CLOSED_SUBDIVISION_CURVE_H
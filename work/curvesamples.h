@@ -0,0 +1,38 @@
+#ifndef CURVE_SAMPLES_H
+#define CURVE_SAMPLES_H
+
+#include <core/types/gmpoint.h>
+
+#include <vector>
+
+/*!
+ *  CurveSamples<T,n>
+ *
+ *  - Contiguous result buffer for batched curve sampling.
+ *  - Layout is [sample][derivative][component], i.e. sample i holds d+1 packed
+ *    n-vectors (position first), so the whole buffer is one flat array of T.
+ */
+template <typename T, int n>
+struct CurveSamples
+{
+  int             samples     {0};
+  int             derivatives {0};
+  std::vector<T>  data;
+
+  void resize(int m, int d)
+  {
+    samples     = m;
+    derivatives = d;
+    data.resize(static_cast<size_t>(m) * static_cast<size_t>(d + 1) * n);
+  }
+
+  int  stride() const { return (derivatives + 1) * n; }
+
+  // Offsets in size_t, as in resize(); samples * stride may exceed int
+  T*       at(int i, int k = 0)       { return data.data() + static_cast<size_t>(i) * static_cast<size_t>(stride()) + static_cast<size_t>(k) * n; }
+  const T* at(int i, int k = 0) const { return data.data() + static_cast<size_t>(i) * static_cast<size_t>(stride()) + static_cast<size_t>(k) * n; }
+
+  GMlib::Vector<T, n> get(int i, int k = 0) const { return GMlib::Vector<T, n>(at(i, k)); }
+};
+
+#endif // CURVE_SAMPLES_H
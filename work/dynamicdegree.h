@@ -0,0 +1,47 @@
+#ifndef DYNAMIC_DEGREE_H
+#define DYNAMIC_DEGREE_H
+
+#include <cstddef>
+#include <vector>
+
+// Degree template argument of the work/ curves that selects a run-time degree
+constexpr int DYNAMIC_DEGREE = -1;
+
+// Number of scratch entries for a (degree+1)^e table; DYNAMIC_DEGREE for a run-time degree
+constexpr int degreeTableSize(int degree, int e)
+{
+  return degree < 0 ? DYNAMIC_DEGREE : (e == 1 ? degree + 1 : (degree + 1) * degreeTableSize(degree, e - 1));
+}
+
+/*!
+ *  DegreeArray<T,N>
+ *
+ *  - Scratch storage for N entries. With a compile-time degree it is a plain array
+ *    (no heap traffic, loop bounds known to the compiler); for DYNAMIC_DEGREE it is
+ *    a std::vector that is resized when the degree changes.
+ */
+template <typename T, int N>
+struct DegreeArray
+{
+  void      resize(size_t) {}
+  T&        operator[](size_t i)       { return _data[i]; }
+  const T&  operator[](size_t i) const { return _data[i]; }
+  T*        data()                     { return _data; }
+  const T*  data() const               { return _data; }
+
+  T         _data[N > 0 ? N : 1];
+};
+
+template <typename T>
+struct DegreeArray<T, DYNAMIC_DEGREE>
+{
+  void      resize(size_t n) { if (_data.size() != n) _data.resize(n); }
+  T&        operator[](size_t i)       { return _data[i]; }
+  const T&  operator[](size_t i) const { return _data[i]; }
+  T*        data()                     { return _data.data(); }
+  const T*  data() const               { return _data.data(); }
+
+  std::vector<T> _data;
+};
+
+#endif // DYNAMIC_DEGREE_H
@@ -0,0 +1,152 @@
+#ifndef GPU_EVALUATION_H
+#define GPU_EVALUATION_H
+
+#include <core/types/gmpoint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/*!
+ *  GpuBSplineForm
+ *
+ *  - A curve written as a B-spline for evaluation on the GPU: degree, knot vector and
+ *    control points, in float.
+ *  - Samples are taken on a uniform grid over [start, end] of the curve parameter t. The
+ *    knot parameter is s = offset + scale * t; with a period > 0, s wraps into
+ *    [knots[degree], knots[degree] + period). Derivatives are taken with respect to t.
+ */
+struct GpuBSplineForm
+{
+  int                                   degree {0};
+  std::vector<float>                    knots;
+  std::vector<GMlib::Vector<float, 3>>  points;
+
+  float                                 start  {0};
+  float                                 end    {1};
+  float                                 scale  {1};
+  float                                 offset {0};
+  float                                 period {0};
+};
+
+/*!
+ *  GpuEvaluableCurve
+ *
+ *  - Curves that a GPU backend can evaluate from their B-spline form. gpuBSplineForm()
+ *    returns false when the current state of the curve has none; it is sampled on the
+ *    CPU then.
+ *  - gpuEvaluated() is called on the GL thread after the GPU wrote new samples, in place
+ *    of a replot. No samples reach the CPU, so the curve sets its surrounding sphere to
+ *    the bound of its control polygon, which contains the curve.
+ */
+class GpuEvaluableCurve
+{
+public:
+  virtual ~GpuEvaluableCurve() = default;
+
+  virtual bool  gpuBSplineForm(GpuBSplineForm &form) const = 0;
+  virtual void  gpuEvaluated() = 0;
+};
+
+/*!
+ *  evaluateGpuForm(form, t, d, out)
+ *
+ *  - CPU port of the compute shader in GpuCurveVisualizer, step by step and in float:
+ *    position and d derivatives at curve parameter t into out[0..d]. Checks the shader's
+ *    results against the curves' own eval().
+ */
+inline void evaluateGpuForm(const GpuBSplineForm &form, float t, int d, std::vector<GMlib::Vector<float, 3>> &out)
+{
+  const int p = form.degree;
+  const int n = static_cast<int>(form.points.size());
+  const std::vector<float> &knots = form.knots;
+
+  float s = form.offset + form.scale * t;
+  if (form.period > 0.0f)
+  {
+    // GLSL mod(x, y) = x - y floor(x/y)
+    const float x = s - knots[p];
+    s = knots[p] + (x - form.period * std::floor(x / form.period));
+  }
+
+  // knots[span] <= s < knots[span+1], span in [p, n-1]
+  int span = n - 1;
+  if (s < knots[n])
+  {
+    int lo = p, hi = n;
+    while (hi - lo > 1)
+    {
+      const int mid = (lo + hi) / 2;
+      if (s < knots[mid]) hi = mid; else lo = mid;
+    }
+    span = lo;
+  }
+
+  std::vector<std::vector<float>> ndu(p + 1, std::vector<float>(p + 1));
+  std::vector<float> left(p + 1), right(p + 1);
+  ndu[0][0] = 1.0f;
+  for (int j = 1; j <= p; ++j)
+  {
+    left[j]  = s - knots[span + 1 - j];
+    right[j] = knots[span + j] - s;
+    float saved = 0.0f;
+    for (int r = 0; r < j; ++r)
+    {
+      ndu[j][r] = right[r + 1] + left[j - r];
+      const float temp = ndu[r][j - 1] / ndu[j][r];
+      ndu[r][j] = saved + right[r + 1] * temp;
+      saved     = left[j - r] * temp;
+    }
+    ndu[j][j] = saved;
+  }
+
+  const int nd = std::min(d, p);
+  std::vector<std::vector<float>> ders(nd + 1, std::vector<float>(p + 1));
+  for (int j = 0; j <= p; ++j) ders[0][j] = ndu[j][p];
+
+  std::vector<std::vector<float>> a(2, std::vector<float>(p + 1));
+  for (int r = 0; r <= p; ++r)
+  {
+    int s1 = 0, s2 = 1;
+    a[0][0] = 1.0f;
+    for (int k = 1; k <= nd; ++k)
+    {
+      float dk = 0.0f;
+      const int rk = r - k, pk = p - k;
+      if (r >= k)
+      {
+        a[s2][0] = a[s1][0] / ndu[pk + 1][rk];
+        dk = a[s2][0] * ndu[rk][pk];
+      }
+      const int j1 = rk >= -1 ? 1 : -rk;
+      const int j2 = r - 1 <= pk ? k - 1 : p - r;
+      for (int j = j1; j <= j2; ++j)
+      {
+        a[s2][j] = (a[s1][j] - a[s1][j - 1]) / ndu[pk + 1][rk + j];
+        dk += a[s2][j] * ndu[rk + j][pk];
+      }
+      if (r <= pk)
+      {
+        a[s2][k] = -a[s1][k - 1] / ndu[pk + 1][r];
+        dk += a[s2][k] * ndu[r][pk];
+      }
+      ders[k][r] = dk;
+      std::swap(s1, s2);
+    }
+  }
+
+  // The k-th derivative carries p!/(p-k)! and the k-th power of the parameter scale
+  out.assign(static_cast<size_t>(d + 1), GMlib::Vector<float, 3>(0.0f, 0.0f, 0.0f));
+  float f = 1.0f;
+  for (int k = 0; k <= d; ++k)
+  {
+    GMlib::Vector<float, 3> c(0.0f, 0.0f, 0.0f);
+    if (k <= nd)
+      for (int j = 0; j <= p; ++j)
+        c += ders[k][j] * form.points[span - p + j];
+    out[k] = f * c;
+    f *= float(p - k) * form.scale;
+  }
+}
+
+#endif // GPU_EVALUATION_H
@@ -0,0 +1,27 @@
+#ifndef LOD_SAMPLING_H
+#define LOD_SAMPLING_H
+
+#include <vector>
+
+/*!
+ *  LodSampledCurve
+ *
+ *  - Curves that keep a few pre-sampled levels of detail next to their replot samples.
+ *    Level 0 is the finest; every level holds about half the samples of the one before
+ *    and keeps within lodTolerance(level) of the curve, in world units.
+ *  - A visualizer picks the level per view from the projected size of the curve; the
+ *    levels are rebuilt with each full replot, lodRevision() tells when.
+ *  - GL thread, between commits.
+ */
+class LodSampledCurve
+{
+public:
+  virtual ~LodSampledCurve() = default;
+
+  virtual int   lodRevision() const = 0;
+  virtual int   lodLevelCount() const = 0;
+  virtual float lodTolerance(int level) const = 0;
+  virtual void  lodPositions(int level, std::vector<float> &xyz) const = 0;
+};
+
+#endif // LOD_SAMPLING_H
@@ -1,174 +1,427 @@
+#ifndef MYBSPLINE_H
+#define MYBSPLINE_H
+
 #include <parametrics/gmpcurve.h>
 
 #include <core/containers/gmdvector.h>
+#include <core/containers/gmdmatrix.h>
+
+#include "asyncsampling.h"
+#include "bsplinebasis.h"
+#include "curvesamples.h"
+#include "dynamicdegree.h"
+#include "gpuevaluation.h"
+#include "../application/workerpool.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 
-class MyB_spline : public GMlib::PCurve<float,3> {
+// B-spline curve of degree K over scalar T. K = DYNAMIC_DEGREE takes the degree at run time;
+// with a fixed K all span-local loops have compile-time bounds and the scratch lives inline.
+template <typename T = float, int K = 2>
+class MyB_spline : public GMlib::PCurve<T,3>, public AsyncSampledCurve<MyB_spline<T,K>, T>, public GpuEvaluableCurve {
     GM_SCENEOBJECT(MyB_spline)
 
 public:
     // Constructor 1: Using given control points
-    MyB_spline(const GMlib::DVector<GMlib::Vector<float,3>>& c);
-    
-    // Constructor 2: Using least squares to determine control points
-    MyB_spline(const GMlib::DVector<GMlib::Vector<float,3>>& p, int n);
+    MyB_spline(const GMlib::DVector<GMlib::Vector<T,3>>& c);
+    MyB_spline(int degree, const GMlib::DVector<GMlib::Vector<T,3>>& c);
+
+    // Constructor 2: Using least squares to determine control points.
+    // Large inputs are assembled in chunks on the given pool; without one on the calling thread.
+    MyB_spline(const GMlib::DVector<GMlib::Vector<T,3>>& p, int n, WorkerPool* workers = nullptr);
+    MyB_spline(int degree, const GMlib::DVector<GMlib::Vector<T,3>>& p, int n, WorkerPool* workers = nullptr);
+
+    // Constructor 3: Weighted least squares, one weight per input point
+    MyB_spline(const GMlib::DVector<GMlib::Vector<T,3>>& p, const GMlib::DVector<T>& w, int n,
+               WorkerPool* workers = nullptr);
+    MyB_spline(int degree, const GMlib::DVector<GMlib::Vector<T,3>>& p, const GMlib::DVector<T>& w, int n,
+               WorkerPool* workers = nullptr);
+
+    int getDegree() const { return _basis.getDegree(); }
+
+    // Batched sampling: m uniform samples over [getStartP(), getEndP()] with d derivatives.
+    // Uses its own scratch, so it may run on a replot worker while eval() serves the GL thread.
+    void sampleBatch(CurveSamples<T,3>& out, int m, int d) const;
+
+    // Samples with d derivatives at the given parameters, for adaptive sampling; own scratch as above
+    void sampleAt(const std::vector<T>& t, int d, CurveSamples<T,3>& out) const;
+
+    const GMlib::DVector<GMlib::Vector<T,3>>& getControlPoints() const { return _controlPoints; }
+
+    // Moves one control point and marks the curve edited; the knot vector is kept.
+    // GL thread, while no replot of the curve is in flight (see ReplotScheduler::cancel).
+    void setControlPoint(int i, const GMlib::Vector<T,3>& p);
+
+    // Degree, knots and control points as they are; the GPU backend evaluates them directly
+    bool gpuBSplineForm(GpuBSplineForm& form) const override;
+    void gpuEvaluated() override { setHullSphere(); }
 
     protected:
-    void eval(float t, int d, bool left = true) const override;
-    float getStartP() const override;
-    float getEndP() const override;
+    void eval(T t, int d, bool left = true) const override;
+    T getStartP() const override;
+    T getEndP() const override;
     bool isClosed() const override;
 
 private:
-    GMlib::DVector<GMlib::Vector<float,3>> _controlPoints;
-    GMlib::DVector<float> _knotVector;
+    friend class AsyncSampledCurve<MyB_spline<T,K>, T>;
+
+    using BasisScratch = typename BSplineBasis<T,K>::Scratch;
+
+    GMlib::DVector<GMlib::Vector<T,3>> _controlPoints;
+    BSplineBasis<T,K> _basis;   // Degree, knot vector, span search and basis functions
+
+    // Basis functions for a fixed uniform sample grid, reused while knots and grid are unchanged
+    struct BasisTable {
+        int              samples       {0};
+        int              derivatives   {-1};
+        int              knot_revision {-1};
+        std::vector<int> spans;
+        std::vector<T>   values;   // [sample][derivative][degree+1]
+    };
+    mutable BasisTable _basis_table;
+
+    mutable BasisScratch _scratch;   // eval() only
 
-    void generateKnotVector();
-    void leastSquaresFit(const GMlib::DVector<GMlib::Vector<float,3>>& p, int n);
-        float evaluateBasis(int i, int k, float t) const;
+    // Partial normal equations for a contiguous range of coefficient rows
+    struct NormalEquations {
+        int                                     first {0};
+        GMlib::DMatrix<double>                  NtN;   // NtN[i][j] = (N^T W N)(first+i, first+i+j)
+        GMlib::DVector<GMlib::Vector<double,3>> Ntp;
+    };
+
+    void setHullSphere();
+    void leastSquaresFit(const GMlib::DVector<GMlib::Vector<T,3>>& p, const GMlib::DVector<T>& weights, int n,
+                         WorkerPool* workers);
+    void assembleNormalEquations(const GMlib::DVector<GMlib::Vector<T,3>>& p, const GMlib::DVector<T>& weights,
+                                 int begin, int end, NormalEquations& ne) const;
+    void buildBasisTable(int m, int d) const;
 
 };
 
 // Constructor implementation
-MyB_spline::MyB_spline(const GMlib::DVector<GMlib::Vector<float,3>>& c)
+template <typename T, int K>
+MyB_spline<T,K>::MyB_spline(const GMlib::DVector<GMlib::Vector<T,3>>& c)
+    : MyB_spline(K >= 0 ? K : 2, c) {}
+
+template <typename T, int K>
+MyB_spline<T,K>::MyB_spline(int degree, const GMlib::DVector<GMlib::Vector<T,3>>& c)
     : _controlPoints(c) {
-    generateKnotVector();
+    _basis.setDegree(degree);
+    if (_controlPoints.getDim() <= getDegree())
+        throw std::invalid_argument("MyB_spline: need more than degree control points");
+    _basis.setUniformKnots(_controlPoints.getDim());
 }
 
 // Constructor for least squares approximation
-MyB_spline::MyB_spline(const GMlib::DVector<GMlib::Vector<float,3>>& p, int n) {
-    leastSquaresFit(p, n);
-    generateKnotVector();
+template <typename T, int K>
+MyB_spline<T,K>::MyB_spline(const GMlib::DVector<GMlib::Vector<T,3>>& p, int n, WorkerPool* workers)
+    : MyB_spline(K >= 0 ? K : 2, p, n, workers) {}
+
+template <typename T, int K>
+MyB_spline<T,K>::MyB_spline(int degree, const GMlib::DVector<GMlib::Vector<T,3>>& p, int n, WorkerPool* workers) {
+    _basis.setDegree(degree);
+    leastSquaresFit(p, GMlib::DVector<T>(), n, workers);
 }
 
-// Generate a uniform knot vector for a 2nd-degree B-spline
-void MyB_spline::generateKnotVector() {
-    int n = _controlPoints.getDim(); // Number of control points
-    int k = 2; // Degree
-    int m = n + k + 1; // Number of knots
-
-    _knotVector.setDim(m);
-    
-    // First k+1 knots are 0
-    for (int i = 0; i <= k; ++i) {
-        _knotVector[i] = 0.0f;
-    }
-    
-    // Middle knots are uniformly spaced
-    for (int i = k + 1; i < m - (k + 1); ++i) {
-        _knotVector[i] = static_cast<float>(i - k);
-    }
-    
-    // Last k+1 knots are max value
-    float maxValue = static_cast<float>(m - 2 * (k + 1) + 1);
-    for (int i = m - (k + 1); i < m; ++i) {
-        _knotVector[i] = maxValue;
-    }
+// Constructor for weighted least squares approximation
+template <typename T, int K>
+MyB_spline<T,K>::MyB_spline(const GMlib::DVector<GMlib::Vector<T,3>>& p, const GMlib::DVector<T>& w, int n,
+                            WorkerPool* workers)
+    : MyB_spline(K >= 0 ? K : 2, p, w, n, workers) {}
+
+template <typename T, int K>
+MyB_spline<T,K>::MyB_spline(int degree, const GMlib::DVector<GMlib::Vector<T,3>>& p, const GMlib::DVector<T>& w, int n,
+                            WorkerPool* workers) {
+    _basis.setDegree(degree);
+    leastSquaresFit(p, w, n, workers);
 }
 
-// Least squares fitting to compute control points
-void MyB_spline::leastSquaresFit(const GMlib::DVector<GMlib::Vector<float,3>>& p, int n) {
-    int m = p.getDim(); // Number of input points
-    int k = 2; // Degree of B-spline
+// Least squares fitting to compute control points.
+// The normal equations N^T W N c = N^T W p are assembled directly into banded storage
+// (N has only degree+1 nonzeros per row, so N^T N has half-bandwidth degree) and solved
+// with a banded Cholesky factorization. Time is O(m + n), memory O(n); no dense N or inverse.
+// Assembly is split into chunks over the input points that run on the shared WorkerPool,
+// so fits inside loader or replot tasks do not start threads of their own.
+template <typename T, int K>
+void MyB_spline<T,K>::leastSquaresFit(const GMlib::DVector<GMlib::Vector<T,3>>& p,
+                                      const GMlib::DVector<T>& weights, int n, WorkerPool* workers) {
+    const int m = p.getDim();    // Number of input points
+    const int k = getDegree();   // Degree of B-spline
+
+    if (n <= k)
+        throw std::invalid_argument("MyB_spline::leastSquaresFit: need more than degree control points");
+    if (m < n)
+        throw std::invalid_argument("MyB_spline::leastSquaresFit: fewer input points than control points");
+    if (weights.getDim() != 0 && weights.getDim() != m)
+        throw std::invalid_argument("MyB_spline::leastSquaresFit: weights must match the number of points");
 
-    // Set up the control points storage
+    // The fit is done against the knot vector of the final curve
     _controlPoints.setDim(n);
+    _basis.setUniformKnots(n);
 
-    // Solve least squares system using normal equations
-    GMlib::DMatrix<float> N(m, n, 0.0f);
-    GMlib::DVector<float> weights(m, 1.0f);
+    // Split the input into contiguous chunks, one per pool thread and the calling one. Each
+    // chunk only touches the coefficient rows of the spans it covers, so partial systems are small.
+    const int threads  = workers ? static_cast<int>(workers->threadCount()) + 1 : 1;
+    const int min_pts  = 16384;  // Below this a chunk costs more than it saves
+    const int n_chunks = std::max(1, std::min(threads, m / min_pts));
 
-    // Compute basis functions for each input point
-    for (int i = 0; i < m; ++i) {
-        float t = static_cast<float>(i) / (m - 1);
-        int span = -1;
-        for (int j = k; j < n; ++j) {
-            if (t >= _knotVector[j] && t < _knotVector[j + 1]) {
-                span = j;
-                break;
-            }
-        }
-        if (span == -1) span = n - 1;
-
-        GMlib::DVector<float> N_i(k + 1, 0.0f);
-        N_i[0] = 1.0f;
-        for (int d = 1; d <= k; ++d) {
-            float left = t - _knotVector[span + 1 - d];
-            float right = _knotVector[span + d] - t;
-            float saved = 0.0f;
-            
-            for (int r = 0; r < d; ++r) {
-                float temp = N_i[r] / (_knotVector[span + r + 1] - _knotVector[span + 1 - d + r]);
-                N_i[r] = saved + right * temp;
-                saved = left * temp;
-            }
-            N_i[d] = saved;
-        }
-        
-        for (int j = 0; j <= k; ++j) {
-            N[i][span - k + j] = N_i[j];
+    std::vector<NormalEquations> parts(n_chunks);
+    if (n_chunks == 1)
+        assembleNormalEquations(p, weights, 0, m, parts[0]);
+    else
+        workers->parallelFor(size_t(n_chunks), [this, &p, &weights, &parts, m, n_chunks](size_t c) {
+            const int begin = static_cast<int>(static_cast<long long>(m) * c / n_chunks);
+            const int end   = static_cast<int>(static_cast<long long>(m) * (c + 1) / n_chunks);
+            assembleNormalEquations(p, weights, begin, end, parts[c]);
+        });
+
+    // Reduce: NtN[i][j] = (N^T W N)(i, i+j), j in [0, k]
+    GMlib::DMatrix<double> NtN(n, k + 1, 0.0);
+    GMlib::DVector<GMlib::Vector<double,3>> Ntp(n, GMlib::Vector<double,3>(0.0, 0.0, 0.0));
+    for (const auto& ne : parts) {
+        for (int i = 0; i < ne.NtN.getDim1(); ++i) {
+            for (int j = 0; j <= k; ++j)
+                NtN[ne.first + i][j] += ne.NtN[i][j];
+            Ntp[ne.first + i] += ne.Ntp[i];
         }
     }
 
-    // Solve for control points using least squares
-    GMlib::DMatrix<float> Nt = N;
-    Nt.transpose();
-    GMlib::DMatrix<float> NtN = Nt * N;
-    GMlib::DMatrix<float> NtNi = NtN;
-    NtNi.invert();
-    GMlib::DMatrix<float> NtNiNt = NtNi * Nt;
-    _controlPoints = NtNiNt * p;
+    BSplineBasis<T,K>::solveBanded(NtN, Ntp);
+
+    for (int i = 0; i < n; ++i)
+        _controlPoints[i] = GMlib::Vector<T,3>(T(Ntp[i][0]), T(Ntp[i][1]), T(Ntp[i][2]));
 }
 
-// Evaluate basis function recursively using the Cox–de Boor formula
-float MyB_spline::evaluateBasis(int i, int degree, float t) const {
-    // Base case: degree 0 – check for the knot span; handle the special case when t equals the last knot.
-    if( degree == 0 ) {
-        if( (_knotVector[i] <= t && t < _knotVector[i+1]) ||
-            (t == _knotVector[_knotVector.getDim()-1] && i == _controlPoints.getDim()-1) )
-            return 1.0f;
-        else
-            return 0.0f;
+// Accumulate the normal equation contribution of the input points [begin, end).
+// Safe to call concurrently for disjoint outputs: basis scratch is local to the call.
+template <typename T, int K>
+void MyB_spline<T,K>::assembleNormalEquations(const GMlib::DVector<GMlib::Vector<T,3>>& p,
+                                              const GMlib::DVector<T>& weights,
+                                              int begin, int end, NormalEquations& ne) const {
+    const int m = p.getDim();
+    const int k = getDegree();
+
+    if (begin >= end) {
+        ne.first = 0;
+        ne.NtN.setDim(0, k + 1);
+        ne.Ntp.setDim(0);
+        return;
+    }
+
+    // Parameters increase with the point index: binary search once, then a monotone cursor
+    int       span      = _basis.findSpan(_basis.uniformParameter(begin, m));
+    const int last_span = _basis.findSpan(_basis.uniformParameter(end - 1, m));
+
+    ne.first = span - k;
+    const int rows = last_span - ne.first + 1;
+    ne.NtN = GMlib::DMatrix<double>(rows, k + 1, 0.0);
+    ne.Ntp = GMlib::DVector<GMlib::Vector<double,3>>(rows, GMlib::Vector<double,3>(0.0, 0.0, 0.0));
+
+    BasisScratch scratch;
+    for (int i = begin; i < end; ++i) {
+        const T      t = _basis.uniformParameter(i, m);
+        const double w = weights.getDim() ? double(weights[i]) : 1.0;
+
+        span = _basis.advanceSpan(span, t);
+        _basis.evaluateDerivatives(span, t, 0, scratch);
+
+        const T* N = scratch.ders.data();   // Row 0: the basis functions
+        const int row = span - k - ne.first;
+        const GMlib::Vector<double,3> wp(w * p[i][0], w * p[i][1], w * p[i][2]);
+        for (int r = 0; r <= k; ++r) {
+            const double wNr = w * N[r];
+            for (int c = r; c <= k; ++c)
+                ne.NtN[row + r][c - r] += wNr * N[c];
+            ne.Ntp[row + r] += double(N[r]) * wp;
+        }
     }
-    
-    float denom1 = _knotVector[i+degree] - _knotVector[i];
-    float term1  = 0.0f;
-    if( denom1 != 0.0f )
-        term1 = (t - _knotVector[i]) / denom1 * evaluateBasis(i, degree - 1, t);
-    
-    float denom2 = _knotVector[i+degree+1] - _knotVector[i+1];
-    float term2  = 0.0f;
-    if( denom2 != 0.0f )
-        term2 = (_knotVector[i+degree+1] - t) / denom2 * evaluateBasis(i+1, degree - 1, t);
-    
-    return term1 + term2;
 }
 
-// Evaluate the curve at parameter t using correct basis function evaluation
-void MyB_spline::eval(float t, int d, bool left) const {
+// Evaluate the curve and its first d derivatives at parameter t.
+// Only the degree+1 basis functions that are nonzero on the knot span of t are touched,
+// so the cost per sample is independent of the number of control points.
+template <typename T, int K>
+void MyB_spline<T,K>::eval(T t, int d, bool left) const {
     this->_p.setDim(d+1);
-    this->_p[0] = GMlib::Vector<float,3>(0.0f, 0.0f, 0.0f);
-    
-    int n = _controlPoints.getDim();
-    int degree = 2; // B-spline degree
-    
-    // Sum over each control point multiplied by its corresponding basis function value.
-    for (int i = 0; i < n; ++i) {
-        float basisVal = evaluateBasis(i, degree, t);
-        this->_p[0] += basisVal * _controlPoints[i];
+
+    const int p    = getDegree();
+    const int nd   = std::min(d, p);
+    const int span = _basis.findSpan(t);
+    _basis.evaluateDerivatives(span, t, d, _scratch);
+
+    const T* b = _scratch.ders.data();
+    const GMlib::Vector<T,3>* c = &_controlPoints[span - p];
+    for (int k = 0; k <= nd; ++k, b += p + 1) {
+        GMlib::Vector<T,3> sum(b[0] * c[0]);
+        for (int j = 1; j <= p; ++j)
+            sum += b[j] * c[j];
+        this->_p[k] = sum;
+    }
+    for (int k = nd + 1; k <= d; ++k)
+        this->_p[k] = GMlib::Vector<T,3>(T(0), T(0), T(0));
+}
+
+// Tabulate span indices and nonzero basis derivatives for m uniform samples.
+// The samples are walked in order, so the span is advanced with a monotone cursor.
+template <typename T, int K>
+void MyB_spline<T,K>::buildBasisTable(int m, int d) const {
+    const int p      = getDegree();
+    const int nd     = std::min(d, p);
+    const int stride = (d + 1) * (p + 1);
+    const T   start  = getStartP();
+    const T   end    = getEndP();
+    const T   dt     = m > 1 ? (end - start) / (m - 1) : T(0);
+
+    _basis_table.spans.resize(m);
+    _basis_table.values.assign(static_cast<size_t>(m) * stride, T(0));
+
+    BasisScratch scratch;
+    int span = p;
+    for (int i = 0; i < m; ++i) {
+        const T t = (i == m - 1) ? end : start + i * dt;
+        span = _basis.advanceSpan(span, t);
+        _basis.evaluateDerivatives(span, t, d, scratch);
+
+        // Rows above the degree stay zero
+        _basis_table.spans[i] = span;
+        std::copy(scratch.ders.data(), scratch.ders.data() + (nd + 1) * (p + 1),
+                  &_basis_table.values[static_cast<size_t>(i) * stride]);
+    }
+
+    _basis_table.samples       = m;
+    _basis_table.derivatives   = d;
+    _basis_table.knot_revision = _basis.getRevision();
+}
+
+// Evaluate positions and derivatives for the whole domain into one contiguous buffer.
+// The basis table is only rebuilt when the knot vector or the sample grid changes;
+// otherwise a resample is a plain weighted sum of control points per sample.
+template <typename T, int K>
+void MyB_spline<T,K>::sampleBatch(CurveSamples<T,3>& out, int m, int d) const {
+    if (m < 1)
+        return;
+
+    if (_basis_table.samples != m || _basis_table.derivatives != d ||
+        _basis_table.knot_revision != _basis.getRevision())
+        buildBasisTable(m, d);
+
+    out.resize(m, d);
+
+    const int p      = getDegree();
+    const int width  = p + 1;
+    const int stride = (d + 1) * width;
+    const T*  basis  = _basis_table.values.data();
+
+    for (int i = 0; i < m; ++i) {
+        const GMlib::Vector<T,3>* c = &_controlPoints[_basis_table.spans[i] - p];
+        const T* b = basis + static_cast<size_t>(i) * stride;
+
+        for (int k = 0; k <= d; ++k, b += width) {
+            T x = T(0), y = T(0), z = T(0);
+            for (int j = 0; j < width; ++j) {
+                x += b[j] * c[j][0];
+                y += b[j] * c[j][1];
+                z += b[j] * c[j][2];
+            }
+            T* o = out.at(i, k);
+            o[0] = x;
+            o[1] = y;
+            o[2] = z;
+        }
     }
 }
 
 // Return start parameter
-float MyB_spline::getStartP() const {
-    return _knotVector[2]; // First non-repeated knot
+template <typename T, int K>
+T MyB_spline<T,K>::getStartP() const {
+    return _basis.getStartP();
 }
 
 // Return end parameter
-float MyB_spline::getEndP() const {
-    return _knotVector[_knotVector.getDim() - 3]; // Last non-repeated knot
+template <typename T, int K>
+T MyB_spline<T,K>::getEndP() const {
+    return _basis.getEndP();
 }
 
 // Just return false for now
-bool MyB_spline::isClosed() const {
+template <typename T, int K>
+bool MyB_spline<T,K>::isClosed() const {
     return false;
-}
\ No newline at end of file
+}
+
+template <typename T, int K>
+void MyB_spline<T,K>::setControlPoint(int i, const GMlib::Vector<T,3>& p) {
+    if (i < 0 || i >= _controlPoints.getDim())
+        throw std::invalid_argument("MyB_spline::setControlPoint: index out of range");
+    _controlPoints[i] = p;
+
+    setHullSphere();
+    this->setEditDone();
+}
+
+// The curve lies in the convex hull of its control points, so their bounding sphere
+// stands in until the next CPU sampling computes the tight one
+template <typename T, int K>
+void MyB_spline<T,K>::setHullSphere() {
+    auto point = [this](int j) {
+        return GMlib::Point<float,3>(float(_controlPoints[j][0]), float(_controlPoints[j][1]), float(_controlPoints[j][2]));
+    };
+    GMlib::Sphere<float,3> hull(point(0));
+    for (int j = 1; j < _controlPoints.getDim(); ++j)
+        hull += point(j);
+    this->setSurroundingSphere(hull);
+}
+
+// Span-local evaluation per parameter, as in eval(), into out
+template <typename T, int K>
+void MyB_spline<T,K>::sampleAt(const std::vector<T>& t, int d, CurveSamples<T,3>& out) const {
+    out.resize(static_cast<int>(t.size()), d);
+
+    const int p  = getDegree();
+    const int nd = std::min(d, p);
+
+    BasisScratch scratch;
+    for (int i = 0; i < out.samples; ++i) {
+        const int span = _basis.findSpan(t[i]);
+        _basis.evaluateDerivatives(span, t[i], d, scratch);
+
+        const T* b = scratch.ders.data();
+        const GMlib::Vector<T,3>* c = &_controlPoints[span - p];
+        for (int k = 0; k <= d; ++k, b += p + 1) {
+            T x = T(0), y = T(0), z = T(0);
+            if (k <= nd) {
+                for (int j = 0; j <= p; ++j) {
+                    x += b[j] * c[j][0];
+                    y += b[j] * c[j][1];
+                    z += b[j] * c[j][2];
+                }
+            }
+            T* o = out.at(i, k);
+            o[0] = x;
+            o[1] = y;
+            o[2] = z;
+        }
+    }
+}
+
+template <typename T, int K>
+bool MyB_spline<T,K>::gpuBSplineForm(GpuBSplineForm& form) const {
+    form.degree = getDegree();
+    const GMlib::DVector<T>& knots = _basis.getKnots();
+    form.knots.assign(knots.getPtr(), knots.getPtr() + knots.getDim());
+
+    form.points.resize(_controlPoints.getDim());
+    for (int i = 0; i < _controlPoints.getDim(); ++i)
+        form.points[i] = GMlib::Vector<float,3>(float(_controlPoints[i][0]), float(_controlPoints[i][1]), float(_controlPoints[i][2]));
+
+    form.start  = float(getStartP());
+    form.end    = float(getEndP());
+    form.scale  = 1.0f;
+    form.offset = 0.0f;
+    form.period = 0.0f;
+    return true;
+}
+
+#endif // MYBSPLINE_H
@@ -0,0 +1,170 @@
+#ifndef MYBSPLINE_FITTER_H
+#define MYBSPLINE_FITTER_H
+
+#include "bsplinebasis.h"
+#include "mybspline.h"
+
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+/*!
+ *  MyB_splineFitter<T,K>
+ *
+ *  - Streaming least squares fitter for MyB_spline<T,K> with n control points.
+ *  - Points are fed in batches together with their normalized parameter u in [0,1];
+ *    only the banded normal equations (O(n) memory) are kept, never the points.
+ *  - fit() may be called at any time and again after more data has arrived.
+ *  - The degree is K, or the constructor argument for K = DYNAMIC_DEGREE.
+ */
+template <typename T = float, int K = 2>
+class MyB_splineFitter
+{
+public:
+  explicit MyB_splineFitter(int n, int degree = K >= 0 ? K : 2);
+
+  void        addPoint(T u, const GMlib::Vector<T, 3> &p, T w = T(1));
+  void        addPoints(const GMlib::DVector<GMlib::Vector<T, 3>> &p, T u0, T u1);
+
+  template <typename Iterator>
+  void        addPoints(Iterator first, Iterator last, T u0, T u1);
+
+  void        reset();
+  long long   getPointCount() const { return _count; }
+
+  GMlib::DVector<GMlib::Vector<T, 3>> solve() const;
+  MyB_spline<T, K>                   *fit() const;
+
+private:
+  using Basis = BSplineBasis<T, K>;
+
+  Basis                                    _basis;  // Knot vector, span search and basis functions
+  typename Basis::Scratch                  _scratch;
+  int                                      _span;   // Monotone span cursor, reset by a search on a miss
+
+  GMlib::DMatrix<double>                   _NtN;    // _NtN[i][j] = (N^T W N)(i, i+j)
+  GMlib::DVector<GMlib::Vector<double, 3>> _Ntp;
+  long long                                _count;
+};
+
+template <typename T, int K>
+inline MyB_splineFitter<T, K>::MyB_splineFitter(int n, int degree)
+    : _span(0), _count(0)
+{
+  _basis.setDegree(degree);
+  if (n <= _basis.getDegree())
+    throw std::invalid_argument("MyB_splineFitter: need more than degree control points");
+
+  _basis.setUniformKnots(n);
+  reset();
+}
+
+template <typename T, int K>
+inline void MyB_splineFitter<T, K>::reset()
+{
+  const int n = _basis.getControlPointCount();
+  const int k = _basis.getDegree();
+
+  _NtN   = GMlib::DMatrix<double>(n, k + 1, 0.0);
+  _Ntp   = GMlib::DVector<GMlib::Vector<double, 3>>(n, GMlib::Vector<double, 3>(0.0, 0.0, 0.0));
+  _span  = k;
+  _count = 0;
+}
+
+/*!
+ *  addPoint(T u, const Vector<T,3>& p, T w)
+ *
+ *  - Accumulates one weighted point at normalized parameter u into the normal equations.
+ */
+template <typename T, int K>
+inline void MyB_splineFitter<T, K>::addPoint(T u, const GMlib::Vector<T, 3> &p, T w)
+{
+  const int   k     = _basis.getDegree();
+  const int   n     = _basis.getControlPointCount();
+  const auto &knots = _basis.getKnots();
+
+  u = std::min(std::max(u, T(0)), T(1));
+  const T t = _basis.getStartP() + u * (_basis.getEndP() - _basis.getStartP());
+
+  // Ordered input stays on the cursor; anything else falls back to the binary search
+  if (t < knots[_span] || t >= knots[_span + 1])
+  {
+    if (_span < n - 1 && t >= knots[_span + 1] && t < knots[_span + 2])
+      ++_span;
+    else
+      _span = _basis.findSpan(t);
+  }
+  _basis.evaluateDerivatives(_span, t, 0, _scratch);
+
+  const T  *N     = _scratch.ders.data();
+  const int first = _span - k;
+  const GMlib::Vector<double, 3> wp(double(w) * p[0], double(w) * p[1], double(w) * p[2]);
+  for (int r = 0; r <= k; ++r)
+  {
+    const double wNr = double(w) * N[r];
+    for (int c = r; c <= k; ++c)
+      _NtN[first + r][c - r] += wNr * N[c];
+    _Ntp[first + r] += double(N[r]) * wp;
+  }
+
+  ++_count;
+}
+
+/*!
+ *  addPoints(const DVector<Vector<T,3>>& p, T u0, T u1)
+ *
+ *  - Accumulates a batch whose points are spread uniformly over [u0, u1].
+ */
+template <typename T, int K>
+inline void MyB_splineFitter<T, K>::addPoints(const GMlib::DVector<GMlib::Vector<T, 3>> &p, T u0, T u1)
+{
+  const int m = p.getDim();
+  for (int i = 0; i < m; ++i)
+    addPoint(m > 1 ? u0 + (u1 - u0) * T(i) / T(m - 1) : u0, p[i]);
+}
+
+/*!
+ *  addPoints(Iterator first, Iterator last, T u0, T u1)
+ *
+ *  - As above for a range of points. The spread takes the count up front, so the range
+ *    is walked twice and must be a forward range.
+ */
+template <typename T, int K>
+template <typename Iterator>
+inline void MyB_splineFitter<T, K>::addPoints(Iterator first, Iterator last, T u0, T u1)
+{
+  static_assert(std::is_base_of<std::forward_iterator_tag,
+                                typename std::iterator_traits<Iterator>::iterator_category>::value,
+                "MyB_splineFitter::addPoints: needs forward iterators");
+
+  const auto m = std::distance(first, last);
+  for (decltype(std::distance(first, last)) i = 0; first != last; ++first, ++i)
+    addPoint(m > 1 ? u0 + (u1 - u0) * T(i) / T(m - 1) : u0, *first);
+}
+
+/*!
+ *  solve() const
+ *
+ *  - Solves the current normal equations on a copy, so accumulation may continue.
+ */
+template <typename T, int K>
+inline GMlib::DVector<GMlib::Vector<T, 3>> MyB_splineFitter<T, K>::solve() const
+{
+  GMlib::DMatrix<double>                   NtN = _NtN;
+  GMlib::DVector<GMlib::Vector<double, 3>> x   = _Ntp;
+  Basis::solveBanded(NtN, x);
+
+  GMlib::DVector<GMlib::Vector<T, 3>> c(x.getDim());
+  for (int i = 0; i < x.getDim(); ++i)
+    c[i] = GMlib::Vector<T, 3>(T(x[i][0]), T(x[i][1]), T(x[i][2]));
+
+  return c;
+}
+
+template <typename T, int K>
+inline MyB_spline<T, K> *MyB_splineFitter<T, K>::fit() const
+{
+  return new MyB_spline<T, K>(_basis.getDegree(), solve());
+}
+
+#endif // MYBSPLINE_FITTER_H
@@ -0,0 +1,433 @@
+#ifndef MYBSPLINE_SURFACE_H
+#define MYBSPLINE_SURFACE_H
+
+#include <parametrics/gmpsurf.h>
+
+#include <core/containers/gmdvector.h>
+#include <core/containers/gmdmatrix.h>
+
+#include "bsplinebasis.h"
+#include "dynamicdegree.h"
+#include "surfacesamples.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+// Tensor product B-spline surface over scalar T, with a run-time degree per direction.
+// u runs down the rows of the control grid, v along a row, as in the data/ control nets.
+// Each direction is a BSplineBasis (knots, span search, basis functions, banded solver),
+// as for MyB_splineFitter, so the surface is span local in both parameters.
+template <typename T = float>
+class MyB_splineSurface : public GMlib::PSurf<T,3> {
+    GM_SCENEOBJECT(MyB_splineSurface)
+
+public:
+    // Constructor 1: Given knot vectors; the degrees follow from the knot counts and the grid.
+    // An empty knot vector is clamped uniform of degree min(3, n-1).
+    MyB_splineSurface(const GMlib::DVector<T>& u_knots, const GMlib::DVector<T>& v_knots,
+                      const GMlib::DMatrix<GMlib::Vector<T,3>>& c);
+
+    // Constructor 2: Clamped uniform knot vectors of the given degrees
+    MyB_splineSurface(int du, int dv, const GMlib::DMatrix<GMlib::Vector<T,3>>& c);
+
+    // Constructor 3: Least squares fit of a grid of points, spread uniformly over the domain,
+    // to nu x nv control points
+    MyB_splineSurface(int du, int dv, const GMlib::DMatrix<GMlib::Vector<T,3>>& p, int nu, int nv);
+
+    int getDegreeU() const { return _u.getDegree(); }
+    int getDegreeV() const { return _v.getDegree(); }
+
+    const GMlib::DVector<T>& getKnotsU() const { return _u.getKnots(); }
+    const GMlib::DVector<T>& getKnotsV() const { return _v.getKnots(); }
+    const GMlib::DMatrix<GMlib::Vector<T,3>>& getControlPoints() const { return _controlPoints; }
+
+    // Moves one control point and marks the surface edited; the knot vectors are kept
+    void setControlPoint(int i, int j, const GMlib::Vector<T,3>& p);
+
+    // Batched sampling: an m1 x m2 uniform grid with d1 u and d2 v derivatives. The basis is
+    // evaluated once per row and once per column, m1 + m2 times in all; the grid points are
+    // then weighted sums. Own scratch, so it may run on a worker while eval() serves GL.
+    void sampleBatch(SurfaceSamples<T,3>& out, int m1, int m2, int d1, int d2) const;
+
+    // Basis evaluations made by eval() so far
+    long long getBasisEvaluationCount() const { return _basis_evaluations; }
+
+protected:
+    void eval(T u, T v, int d1, int d2, bool lu = true, bool lv = true) const override;
+    T getStartPU() const override;
+    T getEndPU() const override;
+    T getStartPV() const override;
+    T getEndPV() const override;
+    bool isClosedU() const override;
+    bool isClosedV() const override;
+
+private:
+    using Layout       = BSplineBasis<T, DYNAMIC_DEGREE>;
+    using BasisScratch = typename Layout::Scratch;
+
+    // The degree+1 nonzero basis functions at one parameter and their derivatives
+    struct Basis {
+        T              t     {0};
+        int            d     {-1};
+        int            span  {-1};
+        std::vector<T> values;   // [derivative][degree+1]; rows above the degree are zero
+    };
+
+    Layout _u;
+    Layout _v;
+    GMlib::DMatrix<GMlib::Vector<T,3>> _controlPoints;
+
+    // eval() caches. GMlib samples row by row: the u basis is kept along a row, together
+    // with the control grid rows weighted by it (per v column, filled as they are reached);
+    // the v bases are kept per position along the row and match again on the next row.
+    mutable Basis                           _u_basis;
+    mutable std::vector<GMlib::Vector<T,3>> _row;        // [u derivative][column]
+    mutable std::vector<char>               _row_done;   // per column
+    mutable std::vector<Basis>              _v_bases;
+    mutable int                             _v_cursor {0};
+    mutable BasisScratch                    _scratch;
+    mutable long long                       _basis_evaluations {0};
+
+    static constexpr int MaxCachedColumns = 4096;
+
+    static Layout makeLayout(int degree, int n, const GMlib::DVector<T>& knots);
+    static void   evaluateBasis(const Layout& l, T t, int d, Basis& b, BasisScratch& s);
+    static void   fitDirection(const Layout& l, int m, std::vector<Basis>& bases, GMlib::DMatrix<double>& NtN);
+    static void   solveColumn(const Layout& l, const std::vector<Basis>& bases, const GMlib::DMatrix<double>& NtN,
+                              GMlib::DVector<GMlib::Vector<double,3>>& rhs);
+    void          leastSquaresFit(const GMlib::DMatrix<GMlib::Vector<T,3>>& p);
+    void          weightRow(int column, int d1) const;
+    void          invalidateRow() const;
+};
+
+// Constructor implementation
+template <typename T>
+MyB_splineSurface<T>::MyB_splineSurface(const GMlib::DVector<T>& u_knots, const GMlib::DVector<T>& v_knots,
+                                        const GMlib::DMatrix<GMlib::Vector<T,3>>& c)
+    : _u(makeLayout(u_knots.getDim() ? u_knots.getDim() - c.getDim1() - 1 : std::min(3, c.getDim1() - 1), c.getDim1(), u_knots)),
+      _v(makeLayout(v_knots.getDim() ? v_knots.getDim() - c.getDim2() - 1 : std::min(3, c.getDim2() - 1), c.getDim2(), v_knots)),
+      _controlPoints(c) {}
+
+template <typename T>
+MyB_splineSurface<T>::MyB_splineSurface(int du, int dv, const GMlib::DMatrix<GMlib::Vector<T,3>>& c)
+    : _u(makeLayout(du, c.getDim1(), GMlib::DVector<T>())),
+      _v(makeLayout(dv, c.getDim2(), GMlib::DVector<T>())),
+      _controlPoints(c) {}
+
+// Constructor for least squares approximation
+template <typename T>
+MyB_splineSurface<T>::MyB_splineSurface(int du, int dv, const GMlib::DMatrix<GMlib::Vector<T,3>>& p, int nu, int nv)
+    : _u(makeLayout(du, nu, GMlib::DVector<T>())),
+      _v(makeLayout(dv, nv, GMlib::DVector<T>())) {
+    leastSquaresFit(p);
+}
+
+// Basis of one direction for n control points: the given knots, or clamped uniform knots
+// when there are none
+template <typename T>
+typename MyB_splineSurface<T>::Layout
+MyB_splineSurface<T>::makeLayout(int degree, int n, const GMlib::DVector<T>& knots) {
+    if (degree < 0 || n <= degree)
+        throw std::invalid_argument("MyB_splineSurface: need more than degree control points per direction");
+
+    Layout l;
+    l.setDegree(degree);
+    if (knots.getDim() == 0)
+        l.setUniformKnots(n);
+    else
+        l.setKnots(n, knots);
+    return l;
+}
+
+// Span and basis derivatives at t, rows above the degree set to zero
+template <typename T>
+void MyB_splineSurface<T>::evaluateBasis(const Layout& l, T t, int d, Basis& b, BasisScratch& s) {
+    const int p  = l.getDegree();
+    const int nd = std::min(d, p);
+
+    b.t    = t;
+    b.d    = d;
+    b.span = l.findSpan(t);
+    l.evaluateDerivatives(b.span, t, d, s);
+
+    b.values.assign(static_cast<size_t>(d + 1) * (p + 1), T(0));
+    std::copy(s.ders.data(), s.ders.data() + (nd + 1) * (p + 1), b.values.begin());
+}
+
+// Least squares fitting to compute the control grid.
+// The tensor product fit separates: every column of the input is fitted in u against the
+// same banded normal matrix, then every row of that result in v. Each direction assembles
+// its normal matrix from one basis evaluation per input row or column and solves it with
+// the banded Cholesky solver of BSplineBasis.
+template <typename T>
+void MyB_splineSurface<T>::leastSquaresFit(const GMlib::DMatrix<GMlib::Vector<T,3>>& p) {
+    const int m1 = p.getDim1();
+    const int m2 = p.getDim2();
+    const int nu = _u.getControlPointCount();
+    const int nv = _v.getControlPointCount();
+
+    if (m1 < nu || m2 < nv)
+        throw std::invalid_argument("MyB_splineSurface::leastSquaresFit: fewer input points than control points");
+
+    std::vector<Basis>     u_bases, v_bases;
+    GMlib::DMatrix<double> u_NtN, v_NtN;
+    fitDirection(_u, m1, u_bases, u_NtN);
+    fitDirection(_v, m2, v_bases, v_NtN);
+
+    // u: X (nu x m2), column j from the input column j
+    GMlib::DMatrix<GMlib::Vector<double,3>> X(nu, m2);
+    GMlib::DVector<GMlib::Vector<double,3>> rhs;
+    for (int j = 0; j < m2; ++j) {
+        rhs = GMlib::DVector<GMlib::Vector<double,3>>(m1);
+        for (int i = 0; i < m1; ++i)
+            rhs[i] = GMlib::Vector<double,3>(double(p[i][j][0]), double(p[i][j][1]), double(p[i][j][2]));
+        solveColumn(_u, u_bases, u_NtN, rhs);
+        for (int r = 0; r < nu; ++r)
+            X[r][j] = rhs[r];
+    }
+
+    // v: the control rows from the rows of X
+    _controlPoints.setDim(nu, nv);
+    for (int r = 0; r < nu; ++r) {
+        rhs = X[r];
+        solveColumn(_v, v_bases, v_NtN, rhs);
+        for (int c = 0; c < nv; ++c)
+            _controlPoints[r][c] = GMlib::Vector<T,3>(T(rhs[c][0]), T(rhs[c][1]), T(rhs[c][2]));
+    }
+}
+
+// Bases at m uniform parameters of one direction and the banded N^T N they give,
+// NtN[i][j] = (N^T N)(i, i+j)
+template <typename T>
+void MyB_splineSurface<T>::fitDirection(const Layout& l, int m, std::vector<Basis>& bases, GMlib::DMatrix<double>& NtN) {
+    const int n = l.getControlPointCount();
+    const int k = l.getDegree();
+
+    bases.resize(m);
+    NtN = GMlib::DMatrix<double>(n, k + 1, 0.0);
+
+    BasisScratch scratch;
+    for (int i = 0; i < m; ++i) {
+        evaluateBasis(l, l.uniformParameter(i, m), 0, bases[i], scratch);
+
+        const T* N     = bases[i].values.data();
+        const int first = bases[i].span - k;
+        for (int r = 0; r <= k; ++r)
+            for (int c = r; c <= k; ++c)
+                NtN[first + r][c - r] += double(N[r]) * N[c];
+    }
+}
+
+// Replaces the m values of rhs by the n coefficients fitting them; NtN is copied, the
+// solver factors in place
+template <typename T>
+void MyB_splineSurface<T>::solveColumn(const Layout& l, const std::vector<Basis>& bases, const GMlib::DMatrix<double>& NtN,
+                                       GMlib::DVector<GMlib::Vector<double,3>>& rhs) {
+    const int n = l.getControlPointCount();
+    const int k = l.getDegree();
+
+    GMlib::DVector<GMlib::Vector<double,3>> Ntp(n, GMlib::Vector<double,3>(0.0, 0.0, 0.0));
+    for (size_t i = 0; i < bases.size(); ++i) {
+        const T* N     = bases[i].values.data();
+        const int first = bases[i].span - k;
+        for (int r = 0; r <= k; ++r)
+            Ntp[first + r] += double(N[r]) * rhs[int(i)];
+    }
+
+    GMlib::DMatrix<double> A = NtN;
+    Layout::solveBanded(A, Ntp);
+    rhs = Ntp;
+}
+
+// Evaluate the surface and its derivatives up to d1 in u and d2 in v at (u, v).
+// Only the (du+1) x (dv+1) control points of the span pair are touched; along a row of
+// samples the u weighting of a column is shared by every sample that reaches it.
+template <typename T>
+void MyB_splineSurface<T>::eval(T u, T v, int d1, int d2, bool /*lu*/, bool /*lv*/) const {
+    this->_p.setDim(d1 + 1, d2 + 1);
+
+    const int pv = getDegreeV();
+
+    // A new row: u basis; the weighted columns and the v cursor start over
+    if (_u_basis.span < 0 || u != _u_basis.t || d1 != _u_basis.d) {
+        evaluateBasis(_u, u, d1, _u_basis, _scratch);
+        ++_basis_evaluations;
+        invalidateRow();
+    }
+
+    // The v basis at this position of the previous row, if the parameter matches
+    Basis  spare;
+    Basis* bv = &spare;
+    if (_v_cursor < MaxCachedColumns) {
+        if (_v_cursor >= int(_v_bases.size()))
+            _v_bases.resize(_v_cursor + 1);
+        bv = &_v_bases[_v_cursor++];
+    }
+    if (bv->span < 0 || v != bv->t || d2 != bv->d) {
+        evaluateBasis(_v, v, d2, *bv, _scratch);
+        ++_basis_evaluations;
+    }
+
+    const int first = bv->span - pv;
+    for (int c = first; c <= bv->span; ++c)
+        if (!_row_done[c])
+            weightRow(c, d1);
+
+    const int nv = _controlPoints.getDim2();
+    for (int a = 0; a <= d1; ++a) {
+        const GMlib::Vector<T,3>* w = &_row[static_cast<size_t>(a) * nv + first];
+        const T* b = bv->values.data();
+        for (int k = 0; k <= d2; ++k, b += pv + 1) {
+            GMlib::Vector<T,3> sum(b[0] * w[0]);
+            for (int j = 1; j <= pv; ++j)
+                sum += b[j] * w[j];
+            this->_p[a][k] = sum;
+        }
+    }
+}
+
+// Column c of the control grid weighted by the u basis, for every u derivative
+template <typename T>
+void MyB_splineSurface<T>::weightRow(int column, int d1) const {
+    const int pu    = getDegreeU();
+    const int nv    = _controlPoints.getDim2();
+    const int first = _u_basis.span - pu;
+    const T*  b     = _u_basis.values.data();
+
+    for (int a = 0; a <= d1; ++a, b += pu + 1) {
+        GMlib::Vector<T,3> sum(b[0] * _controlPoints[first][column]);
+        for (int i = 1; i <= pu; ++i)
+            sum += b[i] * _controlPoints[first + i][column];
+        _row[static_cast<size_t>(a) * nv + column] = sum;
+    }
+    _row_done[column] = 1;
+}
+
+template <typename T>
+void MyB_splineSurface<T>::invalidateRow() const {
+    const int nv = _controlPoints.getDim2();
+    _row.resize(static_cast<size_t>(std::max(_u_basis.d, 0) + 1) * nv);
+    _row_done.assign(nv, 0);
+    _v_cursor = 0;
+}
+
+// Tabulate the bases of the m1 rows and m2 columns, then weight the control grid by the
+// u basis once per row and sum each grid point over its v span
+template <typename T>
+void MyB_splineSurface<T>::sampleBatch(SurfaceSamples<T,3>& out, int m1, int m2, int d1, int d2) const {
+    if (m1 < 1 || m2 < 1)
+        return;
+
+    const int pu = getDegreeU();
+    const int pv = getDegreeV();
+    const int nv = _controlPoints.getDim2();
+
+    const auto parameter = [](const Layout& l, int i, int m) {
+        return m > 1 ? l.uniformParameter(i, m) : l.getStartP();
+    };
+
+    BasisScratch       scratch;
+    std::vector<Basis> u_bases(m1), v_bases(m2);
+    for (int i = 0; i < m1; ++i)
+        evaluateBasis(_u, parameter(_u, i, m1), d1, u_bases[i], scratch);
+    for (int j = 0; j < m2; ++j)
+        evaluateBasis(_v, parameter(_v, j, m2), d2, v_bases[j], scratch);
+
+    out.resize(m1, m2, d1, d2);
+
+    std::vector<T> row(static_cast<size_t>(d1 + 1) * nv * 3);
+    for (int i = 0; i < m1; ++i) {
+        const int first = u_bases[i].span - pu;
+        const T*  b     = u_bases[i].values.data();
+        for (int a = 0; a <= d1; ++a, b += pu + 1) {
+            for (int c = 0; c < nv; ++c) {
+                T x = T(0), y = T(0), z = T(0);
+                for (int r = 0; r <= pu; ++r) {
+                    const GMlib::Vector<T,3>& q = _controlPoints[first + r][c];
+                    x += b[r] * q[0];
+                    y += b[r] * q[1];
+                    z += b[r] * q[2];
+                }
+                T* o = &row[(static_cast<size_t>(a) * nv + c) * 3];
+                o[0] = x;
+                o[1] = y;
+                o[2] = z;
+            }
+        }
+
+        for (int j = 0; j < m2; ++j) {
+            const int col = v_bases[j].span - pv;
+            for (int a = 0; a <= d1; ++a) {
+                const T* w  = &row[(static_cast<size_t>(a) * nv + col) * 3];
+                const T* bv = v_bases[j].values.data();
+                for (int k = 0; k <= d2; ++k, bv += pv + 1) {
+                    T x = T(0), y = T(0), z = T(0);
+                    for (int c = 0; c <= pv; ++c) {
+                        x += bv[c] * w[3 * c];
+                        y += bv[c] * w[3 * c + 1];
+                        z += bv[c] * w[3 * c + 2];
+                    }
+                    T* o = out.at(i, j, a, k);
+                    o[0] = x;
+                    o[1] = y;
+                    o[2] = z;
+                }
+            }
+        }
+    }
+}
+
+// The surface lies in the convex hull of its control points, so their bounding sphere
+// stands in until the next sampling computes the tight one
+template <typename T>
+void MyB_splineSurface<T>::setControlPoint(int i, int j, const GMlib::Vector<T,3>& p) {
+    if (i < 0 || i >= _controlPoints.getDim1() || j < 0 || j >= _controlPoints.getDim2())
+        throw std::invalid_argument("MyB_splineSurface::setControlPoint: index out of range");
+    _controlPoints[i][j] = p;
+    _u_basis.span = -1;
+
+    auto point = [this](int r, int c) {
+        const auto& q = _controlPoints[r][c];
+        return GMlib::Point<float,3>(float(q[0]), float(q[1]), float(q[2]));
+    };
+    GMlib::Sphere<float,3> hull(point(0, 0));
+    for (int r = 0; r < _controlPoints.getDim1(); ++r)
+        for (int c = 0; c < _controlPoints.getDim2(); ++c)
+            hull += point(r, c);
+    this->setSurroundingSphere(hull);
+
+    this->setEditDone();
+}
+
+template <typename T>
+T MyB_splineSurface<T>::getStartPU() const {
+    return _u.getStartP();
+}
+
+template <typename T>
+T MyB_splineSurface<T>::getEndPU() const {
+    return _u.getEndP();
+}
+
+template <typename T>
+T MyB_splineSurface<T>::getStartPV() const {
+    return _v.getStartP();
+}
+
+template <typename T>
+T MyB_splineSurface<T>::getEndPV() const {
+    return _v.getEndP();
+}
+
+template <typename T>
+bool MyB_splineSurface<T>::isClosedU() const {
+    return false;
+}
+
+template <typename T>
+bool MyB_splineSurface<T>::isClosedV() const {
+    return false;
+}
+
+#endif // MYBSPLINE_SURFACE_H
@@ -0,0 +1,45 @@
+#ifndef SURFACE_SAMPLES_H
+#define SURFACE_SAMPLES_H
+
+#include <core/types/gmpoint.h>
+
+#include <vector>
+
+/*!
+ *  SurfaceSamples<T,n>
+ *
+ *  - Contiguous result buffer for batched surface sampling, as CurveSamples for curves.
+ *  - Layout is [u sample][v sample][u derivative][v derivative][component]: grid point
+ *    (i,j) holds (d1+1)(d2+1) packed n-vectors, position first, v derivatives innermost.
+ */
+template <typename T, int n>
+struct SurfaceSamples
+{
+  int             samples[2]     {0, 0};
+  int             derivatives[2] {0, 0};
+  std::vector<T>  data;
+
+  void resize(int m1, int m2, int d1, int d2)
+  {
+    samples[0]     = m1;
+    samples[1]     = m2;
+    derivatives[0] = d1;
+    derivatives[1] = d2;
+    data.resize(static_cast<size_t>(m1) * static_cast<size_t>(m2) * static_cast<size_t>((d1 + 1) * (d2 + 1)) * n);
+  }
+
+  int  stride() const { return (derivatives[0] + 1) * (derivatives[1] + 1) * n; }
+
+  T*       at(int i, int j, int a = 0, int b = 0)
+  {
+    return data.data() + (static_cast<size_t>(i) * samples[1] + j) * stride() + (a * (derivatives[1] + 1) + b) * n;
+  }
+  const T* at(int i, int j, int a = 0, int b = 0) const
+  {
+    return data.data() + (static_cast<size_t>(i) * samples[1] + j) * stride() + (a * (derivatives[1] + 1) + b) * n;
+  }
+
+  GMlib::Vector<T, n> get(int i, int j, int a = 0, int b = 0) const { return GMlib::Vector<T, n>(at(i, j, a, b)); }
+};
+
+#endif // SURFACE_SAMPLES_H
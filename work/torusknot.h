@@ -2,13 +2,112 @@
 #define TORUS_KNOT_H
 
 #include <parametrics/gmpcurve.h>
+
+#include "asyncsampling.h"
+#include "curvesamples.h"
+
 #include <cmath>
+#include <vector>
 
-class TorusKnot : public GMlib::PCurve<float,3> {
+class TorusKnot : public GMlib::PCurve<float,3>, public AsyncSampledCurve<TorusKnot, float> {
     GM_SCENEOBJECT(TorusKnot)
 
 public:
-    TorusKnot() {}
+    /**
+     *  TorusKnot(p, q, R):
+     *  - p:   twists around the axis of rotational symmetry
+     *  - q:   loops through the torus hole
+     *  - R:   major radius offset (the tube radius is 1)
+     */
+    TorusKnot(int p = 2, int q = 3, float R = 2.0f) : _p_twists(p), _q_loops(q), _R(R) {}
+
+    int   getP() const { return _p_twists; }
+    int   getQ() const { return _q_loops; }
+    float getR() const { return _R; }
+
+    /**
+     *  sampleBatch(out, m, d):
+     *  - m uniform samples over [getStartP(), getEndP()] with d derivatives into one buffer.
+     *  - sin/cos of p t and q t are generated with rotation recurrences over the uniform
+     *    grid (in double, re-seeded every few hundred samples), so the batch costs a
+     *    handful of libm calls in total instead of several per sample.
+     *  - Only touches _trig, never the eval() scratch, so it is safe on a replot worker.
+     */
+    void sampleBatch(CurveSamples<float,3>& out, int m, int d) const {
+
+      if(m < 1) return;
+      out.resize(m, d);
+
+      const double start = getStartP();
+      const double dt    = m > 1 ? (double(getEndP()) - start) / (m - 1) : 0.0;
+
+      // 1) sin/cos tables for q t and p t
+      _trig.resize(4 * size_t(m));
+      float* cq = _trig.data();
+      float* sq = cq + m;
+      float* cp = sq + m;
+      float* sp = cp + m;
+
+      const double cqd = std::cos(_q_loops * dt), sqd = std::sin(_q_loops * dt);
+      const double cpd = std::cos(_p_twists * dt), spd = std::sin(_p_twists * dt);
+      const int    reseed = 256;
+
+      double c1 = 0.0, s1 = 0.0, c2 = 0.0, s2 = 0.0;
+      for(int i = 0; i < m; ++i) {
+        if(i % reseed == 0) {
+          const double t = start + i * dt;
+          c1 = std::cos(_q_loops * t);  s1 = std::sin(_q_loops * t);
+          c2 = std::cos(_p_twists * t); s2 = std::sin(_p_twists * t);
+        }
+        cq[i] = float(c1); sq[i] = float(s1);
+        cp[i] = float(c2); sp[i] = float(s2);
+
+        const double nc1 = c1 * cqd - s1 * sqd;  s1 = s1 * cqd + c1 * sqd;  c1 = nc1;
+        const double nc2 = c2 * cpd - s2 * spd;  s2 = s2 * cpd + c2 * spd;  c2 = nc2;
+      }
+
+      // 2) Position and derivatives
+      if(d <= 2) {
+        const float p = float(_p_twists), q = float(_q_loops), R = _R;
+        const int   stride = out.stride();
+        float*      o = out.data.data();
+
+        for(int i = 0; i < m; ++i, o += stride) {
+          const float A = R + cq[i];
+          o[0] = A * cp[i];
+          o[1] = A * sp[i];
+          o[2] = sq[i];
+          if(d > 0) {
+            o[3] = -p * A * sp[i] - q * sq[i] * cp[i];
+            o[4] =  p * A * cp[i] - q * sq[i] * sp[i];
+            o[5] =  q * cq[i];
+          }
+          if(d > 1) {
+            o[6] = -(p * p + q * q) * cq[i] * cp[i] - p * p * R * cp[i] + 2.0f * p * q * sq[i] * sp[i];
+            o[7] = -(p * p + q * q) * cq[i] * sp[i] - p * p * R * sp[i] - 2.0f * p * q * sq[i] * cp[i];
+            o[8] = -q * q * sq[i];
+          }
+        }
+      }
+      else {
+        for(int i = 0; i < m; ++i)
+          derivatives(cq[i], sq[i], cp[i], sp[i], d, out.at(i));
+      }
+    }
+
+    /**
+     *  sampleAt(t, d, out):
+     *  - Samples with d derivatives at the given parameters, for adaptive sampling.
+     *  - One sin/cos pair per angle and sample; writes only to out, so it is safe on a
+     *    replot worker.
+     */
+    void sampleAt(const std::vector<float>& t, int d, CurveSamples<float,3>& out) const {
+
+      out.resize(int(t.size()), d);
+      for(int i = 0; i < out.samples; ++i)
+        derivatives(std::cos(_q_loops * t[i]),  std::sin(_q_loops * t[i]),
+                    std::cos(_p_twists * t[i]), std::sin(_p_twists * t[i]), d, out.at(i));
+    }
 
 protected:
     /**
@@ -22,134 +121,81 @@ protected:
       // Ensure _p has room for up to d derivatives (0 => just position)
       this->_p.setDim(d + 1);
 
-      // (p,q) for the Torus Knot
-      // p = 2 twists around one axis
-      // q = 3 loops through the torus hole
-      float R = 2.0f;    // Major radius offset
-      int   p = 2;
-      int   q = 3;
-
-      //
-      // 1) Position
-      //
-      float x = ( R + std::cos(q * t) ) * std::cos(p * t);
-      float y = ( R + std::cos(q * t) ) * std::sin(p * t);
-      float z = std::sin(q * t);
-
-      this->_p[0] = { x, y, z };
-
-
-      //
-      // 2) First derivative, if requested
-      //
-      if(d > 0) {
-        // dx/dt
-        //   = d/dt [ (R + cos(qt)) cos(pt ) ]
-        //   = (R + cos(qt)) * -p sin(pt)  +  cos(pt) * -q sin(qt)
-        float dx = -p * (R + std::cos(q * t)) * std::sin(p * t)
-                   - q * std::sin(q * t)      * std::cos(p * t);
-
-        // dy/dt
-        //   = d/dt [ (R + cos(qt)) sin(pt ) ]
-        //   = (R + cos(qt)) *  p cos(pt)    +  sin(pt) * -q sin(qt)
-        float dy =  p * (R + std::cos(q * t)) * std::cos(p * t)
-                   - q * std::sin(q * t)      * std::sin(p * t);
-
-        // dz/dt
-        //   = d/dt [ sin(qt) ] = q cos(qt)
-        float dz = q * std::cos(q * t);
-
-        this->_p[1] = { dx, dy, dz };
-      }
-
-
-      //
-      // 3) Second derivative, if requested
-      //
-      if(d > 1) {
-        //
-        // x'(t) = -p (R + cos(qt)) sin(pt) - q sin(qt) cos(pt)
-        // x''(t) = derivative of x'(t) wrt t
-        //
-        // Let’s do it carefully in parts:
-        //   x'(t) = A(t) + B(t)
-        // where
-        //   A(t) = -p (R + cos(qt)) sin(pt)
-        //   B(t) = -q sin(qt) cos(pt)
-        //
-        // A'(t) = -p [ derivative of (R+cos(qt)) sin(pt) ]
-        //       = -p [ (R + cos(qt)) * p cos(pt) + sin(pt) * (-q sin(qt)) ]
-        //       = -p [ p(R+cos(qt)) cos(pt) - q sin(qt) sin(pt) ]
-        //
-        // B'(t) = -q [ derivative of sin(qt) cos(pt) ]
-        //       = -q [ q cos(qt) cos(pt) + sin(qt)*(-p sin(pt)) ]
-        //       = -q [ q cos(qt) cos(pt) - p sin(qt) sin(pt) ]
-        //
-        // So x''(t) = A'(t) + B'(t).
-        //
-
-        float xpp = 0.0f;
-        { // A'(t)
-          float partA = -p * (
-              p * (R + std::cos(q * t)) * std::cos(p * t)
-              - q * std::sin(q * t)     * std::sin(p * t)
-            );
-          float partB = -q * (
-              q * std::cos(q * t) * std::cos(p * t)
-              - p * std::sin(q * t)* std::sin(p * t)
-            );
-          xpp = partA + partB;
-        }
-
-        //
-        // y'(t) = p (R + cos(qt)) cos(pt) - q sin(qt) sin(pt)
-        // y''(t) => similarly careful
-        //
-        float ypp = 0.0f;
-        { // direct approach:
-          // Let C(t) = p (R + cos(qt)) cos(pt)
-          //     D(t) = - q sin(qt) sin(pt)
-          //
-          // C'(t) = p [ derivative of (R + cos(qt)) cos(pt) ]
-          //       = p [ (R + cos(qt))(-p sin(pt)) + cos(pt)(-q sin(qt)) ] => factor out minus
-          // D'(t) = -q [ derivative of sin(qt) sin(pt) ]
-          //       = -q [ q cos(qt) sin(pt) + sin(qt)* p cos(pt) ]
-          //
-          float partC = p * (
-              -p * (R + std::cos(q * t)) * std::sin(p * t)
-              - q * std::sin(q * t)      * std::cos(p * t)
-            );
-          float partD = -q * (
-              q * std::cos(q * t)  * std::sin(p * t)
-              + p * std::sin(q * t)* std::cos(p * t)
-            );
-          ypp = partC + partD;
-        }
+      // One sin/cos pair per angle; everything else is products of these
+      const float cq = std::cos(_q_loops * t),  sq = std::sin(_q_loops * t);
+      const float cp = std::cos(_p_twists * t), sp = std::sin(_p_twists * t);
 
-        //
-        // z'(t) = q cos(qt)
-        // z''(t) = - q^2 sin(qt)
-        //
-        float zpp = - q * q * std::sin(q * t);
+      _eval_buf.resize(3 * size_t(d + 1));
+      derivatives(cq, sq, cp, sp, d, _eval_buf.data());
 
-        this->_p[2] = { xpp, ypp, zpp };
-      }
+      for(int k = 0; k <= d; ++k)
+        this->_p[k] = GMlib::Vector<float,3>(&_eval_buf[3 * k]);
     }
 
 
     float getStartP() const override {
-      // 0 to 6π so that the entire (2,3) torus knot is traced out exactly once
       return 0.0f;
     }
 
     float getEndP() const override {
-      // For (p=2, q=3), we need 6π to get the full shape closed
-      return 6.0f * float(M_PI);
+      // The knot closes after one full turn 2π of both angles (p t and q t)
+      return 2.0f * float(M_PI);
     }
 
     bool isClosed() const override {
       return true;
     }
+
+private:
+    friend class AsyncSampledCurve<TorusKnot, float>;
+
+    int   _p_twists;
+    int   _q_loops;
+    float _R;
+
+    // Scratch storage for sin/cos tables and single evaluation
+    mutable std::vector<float> _trig;
+    mutable std::vector<float> _eval_buf;
+
+    /**
+     *  derivatives(cq, sq, cp, sp, d, out):
+     *  - All derivatives up to d from cos/sin of q t and p t.
+     *  - In the xy-plane the knot is A(t) e^{i p t} with A(t) = R + cos(q t), so by Leibniz
+     *      (x + i y)^(k) = sum_j C(k,j) A^(j) (i p)^(k-j) e^{i p t},
+     *    where A^(j) = q^j cos(q t + j π/2) for j > 0, and z^(k) = q^k sin(q t + k π/2).
+     */
+    void derivatives(float cq, float sq, float cp, float sp, int d, float* out) const {
+
+      const float p = float(_p_twists), q = float(_q_loops);
+
+      // cos(q t + j π/2), j mod 4; sin(q t + k π/2), k mod 4
+      const float cos_cycle[4] = { cq, -sq, -cq,  sq };
+      const float sin_cycle[4] = { sq,  cq, -sq, -cq };
+      // i^m e^{i p t} = (re, im), m mod 4
+      const float e_re[4] = { cp, -sp, -cp,  sp };
+      const float e_im[4] = { sp,  cp, -sp, -cp };
+
+      float qk = 1.0f;
+      for(int k = 0; k <= d; ++k, qk *= q) {
+
+        float x = 0.0f, y = 0.0f;
+        float binom = 1.0f;   // C(k,j)
+        float qj    = 1.0f;   // q^j
+        for(int j = 0; j <= k; ++j) {
+          const float A  = (j == 0) ? (_R + cq) : qj * cos_cycle[j % 4];
+          const float pm = std::pow(p, float(k - j));
+          x += binom * A * pm * e_re[(k - j) % 4];
+          y += binom * A * pm * e_im[(k - j) % 4];
+
+          binom = binom * float(k - j) / float(j + 1);
+          qj   *= q;
+        }
+
+        out[3 * k + 0] = x;
+        out[3 * k + 1] = y;
+        out[3 * k + 2] = qk * sin_cycle[k % 4];
+      }
+    }
 };
 
 #endif // TORUS_KNOT_H